@@ -0,0 +1,126 @@
+extern "C" {
+#include "esp_log.h"
+}
+
+#include "autoplay.hpp"
+#include "game_common.hpp"
+#include "games.hpp"
+#include "score_store.hpp"
+#include "mem_report.hpp"
+#include <algorithm>
+
+static const char *TAG_BOT = "AUTOPLAY";
+
+static constexpr uint32_t CLOCK_START_MS = 0xFFFFFFFFu - 30000;  // wraps after 30 s
+static constexpr uint32_t REPORT_MS      = 60000;
+#if ENABLE_GAME_SWITCH
+static constexpr uint32_t SWITCH_MS      = 5 * 60000;
+static constexpr uint32_t SWITCH_LIFT_MS = 80;   // longer than the gesture debounce
+#endif
+
+// Per-game player models: moving balls are harder to hit than static cells
+static const BotProfile PROFILES[GAME_COUNT] = {
+  /* GAME_TAP_BALL    */ { 9.0f, 320, 90, 48, 5 },
+  /* GAME_WHACK       */ { 6.0f, 280, 70, 48, 5 },
+  /* GAME_MEMORY_GRID */ { 14.0f, 360, 110, 64, 8 },
+};
+
+namespace {
+
+AutoplayBot *s_bot = nullptr;
+Scene   *s_scene = nullptr;
+FlushStats s_last_flush = {};
+int      s_sw = 0;
+uint32_t s_next_report = 0;
+uint32_t s_avg_limit_us = AUTOPLAY_AVG_LIMIT_US;
+uint32_t s_max_limit_us = AUTOPLAY_MAX_LIMIT_US;
+AutoplayCost s_cost = {};
+#if ENABLE_GAME_SWITCH
+uint32_t s_next_switch = 0;
+#endif
+
+void report(uint32_t now)
+{
+  const BotStats &bs = s_bot->stats();
+  const FrameCost &fc = frame_cost();
+  const uint32_t avg_us = fc.count ? (uint32_t)(fc.sum_us / fc.count) : 0;
+  s_cost.worst_avg_us = std::max(s_cost.worst_avg_us, avg_us);
+  s_cost.worst_max_us = std::max(s_cost.worst_max_us, fc.max_us);
+  if (avg_us > s_avg_limit_us || fc.max_us > s_max_limit_us) {
+    ++s_cost.regressions;
+    ESP_LOGE(TAG_BOT, "FAIL t=%u: frame cost avg=%uus max=%uus over the limits avg=%uus max=%uus", (unsigned)now,
+             (unsigned)avg_us, (unsigned)fc.max_us, (unsigned)s_avg_limit_us, (unsigned)s_max_limit_us);
+  }
+  ESP_LOGI(TAG_BOT, "t=%u frames=%llu taps=%u stray=%u wraps=%u cost avg=%uus max=%uus regressions=%u",
+           (unsigned)now, (unsigned long long)bs.frames, (unsigned)bs.taps, (unsigned)bs.stray_taps,
+           (unsigned)bs.clock_wraps, (unsigned)avg_us, (unsigned)fc.max_us, (unsigned)s_cost.regressions);
+  for (int g = 0; g < GAME_COUNT; ++g) {
+    GameStats st = score_store_get(g);
+    ESP_LOGI(TAG_BOT, "  game %d: sessions=%u score=%u miss=%u best=%u", g,
+             (unsigned)st.sessions, (unsigned)st.total_score, (unsigned)st.total_miss, (unsigned)st.best_score);
+  }
+  const FlushStats &fs = s_scene->flush_stats();
+  ESP_LOGI(TAG_BOT, "  flush: %u dirty rects -> %u windows, %u px", (unsigned)(fs.dirty_rects - s_last_flush.dirty_rects),
+           (unsigned)(fs.windows - s_last_flush.windows), (unsigned)(fs.pixels - s_last_flush.pixels));
+  s_last_flush = fs;
+  reports_request();
+  // Max is per report window so a regression shows up where it happened
+  frame_cost_reset();
+}
+
+bool bot_touch(uint16_t &x, uint16_t &y)
+{
+  const uint32_t now = game_millis();
+  if ((int32_t)(now - s_next_report) >= 0) { report(now); s_next_report = now + REPORT_MS; }
+
+#if ENABLE_GAME_SWITCH
+  // Lift first so the press is a fresh contact, then a single-frame press:
+  // the next game would see a held button as another switch
+  if ((int32_t)(now + SWITCH_LIFT_MS - s_next_switch) >= 0 && (int32_t)(now - s_next_switch) < 0) return false;
+  if ((int32_t)(now - s_next_switch) >= 0) {
+    switch_button_center(s_sw, x, y);
+    s_next_switch = now + SWITCH_MS;
+    return true;
+  }
+#endif
+
+  AimPoint aim = current_aim();
+  if (aim.game >= 0 && aim.game < GAME_COUNT) s_bot->set_profile(PROFILES[aim.game]);
+  return s_bot->sample(now, aim, x, y);
+}
+
+} // namespace
+
+RAM_ACCOUNT(autoplay, "autoplay bot", sizeof(AutoplayBot));
+
+void autoplay_start(uint32_t seed, Scene &scene)
+{
+  const int sw = scene.gfx().width();
+  static AutoplayBot bot(seed, sw, scene.gfx().height(), HUD_H);
+  s_bot = &bot;
+  s_scene = &scene;
+  s_sw = sw;
+  clock_use_virtual(CLOCK_START_MS);
+  s_next_report = CLOCK_START_MS + REPORT_MS;
+#if ENABLE_GAME_SWITCH
+  s_next_switch = CLOCK_START_MS + SWITCH_MS;
+#endif
+  set_touch_source(bot_touch);
+  ESP_LOGI(TAG_BOT, "seed=%u, virtual clock starts at %u", (unsigned)seed, (unsigned)CLOCK_START_MS);
+}
+
+void autoplay_set_limits(uint32_t avg_us, uint32_t max_us)
+{
+  s_avg_limit_us = avg_us;
+  s_max_limit_us = max_us;
+}
+
+void autoplay_report()
+{
+  const uint32_t now = game_millis();
+  report(now);
+  s_next_report = now + REPORT_MS;
+}
+
+const AutoplayCost &autoplay_cost() { return s_cost; }
+const BotStats &autoplay_bot_stats() { return s_bot->stats(); }
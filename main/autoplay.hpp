@@ -0,0 +1,34 @@
+// Soak-test driver: plugs AutoplayBot into read_touch and runs the games
+// on a virtual clock (build with AUTOPLAY_BOT=1)
+#pragma once
+
+#include "scene.hpp"
+#include "autoplay_bot.hpp"
+#include <cstdint>
+
+// Frame work a soak run must stay under: a report window whose average or
+// worst frame goes over counts as a regression and is logged as FAIL
+#ifndef AUTOPLAY_AVG_LIMIT_US
+#define AUTOPLAY_AVG_LIMIT_US QUALITY_BUDGET_US   // what the effect governor aims for
+#endif
+#ifndef AUTOPLAY_MAX_LIMIT_US
+#define AUTOPLAY_MAX_LIMIT_US 16000   // one worst frame may double the frame time
+#endif
+
+// Starts the virtual clock shortly before the 32-bit millisecond rollover
+// so every run crosses it, then reports once per virtual minute.
+void autoplay_start(uint32_t seed, Scene &scene);
+
+// Overrides the limits above (host runs, whose frames cost far less)
+void autoplay_set_limits(uint32_t avg_us, uint32_t max_us);
+
+// Reports and checks the window so far, e.g. the last partial one of a run
+void autoplay_report();
+
+struct AutoplayCost {
+  uint32_t regressions;     // report windows over the limits
+  uint32_t worst_avg_us;    // highest window average so far
+  uint32_t worst_max_us;
+};
+const AutoplayCost &autoplay_cost();
+const BotStats &autoplay_bot_stats();
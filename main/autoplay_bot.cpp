@@ -0,0 +1,72 @@
+#include "autoplay_bot.hpp"
+#include <algorithm>
+
+AutoplayBot::AutoplayBot(uint32_t seed, int screen_w, int screen_h, int top_margin)
+  : rng_(seed ? seed : 0x9E3779B9u), sw_(screen_w), sh_(screen_h), top_(top_margin)
+{
+  prof_ = { 6.0f, 260, 60, 48, 5 };
+}
+
+uint32_t AutoplayBot::next_u32()
+{
+  // xorshift32: deterministic for a given seed on every platform
+  rng_ ^= rng_ << 13;
+  rng_ ^= rng_ >> 17;
+  rng_ ^= rng_ << 5;
+  return rng_;
+}
+
+float AutoplayBot::uniform()
+{
+  return (next_u32() >> 8) * (1.0f / 16777216.0f);
+}
+
+float AutoplayBot::gauss(float mean, float sd)
+{
+  // Irwin-Hall approximation: cheap and bounded at +-6 sd
+  float s = 0;
+  for (int i = 0; i < 12; ++i) s += uniform();
+  return mean + (s - 6.0f) * sd;
+}
+
+void AutoplayBot::schedule(uint32_t now_ms)
+{
+  // A finger is off the glass for longer than the touch debounce between taps
+  float d = std::max(64.0f, gauss(prof_.reaction_mean_ms, prof_.reaction_sd_ms));
+  press_at_ = now_ms + (uint32_t)d;
+  armed_ = true;
+}
+
+bool AutoplayBot::sample(uint32_t now_ms, const AimPoint &aim, uint16_t &x, uint16_t &y)
+{
+  ++stats_.frames;
+  if (now_ms < last_now_) ++stats_.clock_wraps;
+  last_now_ = now_ms;
+
+  if (down_) {
+    if ((int32_t)(now_ms - release_at_) >= 0) { down_ = false; schedule(now_ms); return false; }
+    x = px_; y = py_;
+    return true;
+  }
+
+  if (!armed_) schedule(now_ms);
+  if ((int32_t)(now_ms - press_at_) < 0) return false;
+
+  armed_ = false;
+  int tx, ty;
+  if (!aim.valid || next_u32() % 100 < prof_.stray_pct) {
+    tx = (int)(uniform() * sw_);
+    ty = top_ + (int)(uniform() * (sh_ - top_));
+    ++stats_.stray_taps;
+  } else {
+    tx = (int)gauss(aim.x, prof_.aim_sigma_px);
+    ty = (int)gauss(aim.y, prof_.aim_sigma_px);
+  }
+  px_ = (uint16_t)std::max(0, std::min(sw_ - 1, tx));
+  py_ = (uint16_t)std::max(top_, std::min(sh_ - 1, ty));
+  release_at_ = now_ms + prof_.hold_ms;
+  down_ = true;
+  ++stats_.taps;
+  x = px_; y = py_;
+  return true;
+}
@@ -0,0 +1,56 @@
+// Synthetic player for soak runs: taps the current target with a
+// configurable aim error and reaction time (no ESP-IDF deps)
+#pragma once
+
+#include <cstdint>
+
+// What the running game wants hit this frame
+struct AimPoint {
+  int16_t x, y, r;
+  int8_t  game;     // GameId of the publisher
+  bool    valid;
+};
+
+struct BotProfile {
+  float    aim_sigma_px;      // gaussian aim error around the target center
+  uint16_t reaction_mean_ms;  // delay before each tap
+  uint16_t reaction_sd_ms;
+  uint16_t hold_ms;           // finger down time per tap
+  uint8_t  stray_pct;         // taps sent anywhere on the play field
+};
+
+struct BotStats {
+  uint64_t frames;
+  uint32_t taps;
+  uint32_t stray_taps;
+  uint32_t clock_wraps;       // 32-bit millisecond counter rollovers seen
+};
+
+class AutoplayBot {
+public:
+  AutoplayBot(uint32_t seed, int screen_w, int screen_h, int top_margin);
+
+  void set_profile(const BotProfile &p) { prof_ = p; }
+
+  // One input poll. Returns true while the virtual finger is down.
+  bool sample(uint32_t now_ms, const AimPoint &aim, uint16_t &x, uint16_t &y);
+
+  const BotStats &stats() const { return stats_; }
+
+private:
+  uint32_t next_u32();
+  float    uniform();                 // [0, 1)
+  float    gauss(float mean, float sd);
+  void     schedule(uint32_t now_ms);
+
+  uint32_t   rng_;
+  int        sw_, sh_, top_;
+  BotProfile prof_;
+  BotStats   stats_ = {};
+  uint32_t   press_at_ = 0;
+  uint32_t   release_at_ = 0;
+  uint32_t   last_now_ = 0;
+  bool       down_ = false;
+  bool       armed_ = false;
+  uint16_t   px_ = 0, py_ = 0;
+};
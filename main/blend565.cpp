@@ -0,0 +1,75 @@
+#include "blend565.hpp"
+#include <cstdint>
+
+// The loops are kept branch-free and alias-free so host compilers vectorise
+// them across pixels; Xtensa does not, so there the _be span takes pixels
+// two at a time instead.
+#ifndef BLEND565_PAIRS
+#if defined(__XTENSA__)
+#define BLEND565_PAIRS 1
+#else
+#define BLEND565_PAIRS 0
+#endif
+#endif
+
+void blend565_span(uint16_t *__restrict dst, int n, uint16_t src, uint8_t alpha)
+{
+  const uint32_t a5 = blend565_alpha5(alpha);
+  if (a5 == 0) return;
+  const uint32_t s = blend565_expand(src) * a5 + BLEND565_HALF;
+  const uint32_t inv = 32 - a5;
+  for (int i = 0; i < n; ++i)
+    dst[i] = blend565_fold(((blend565_expand(dst[i]) * inv + s) >> 5) & BLEND565_MASK);
+}
+
+void blend565_span_be_px(uint16_t *__restrict dst, int n, uint16_t src, uint8_t alpha)
+{
+  const uint32_t a5 = blend565_alpha5(alpha);
+  if (a5 == 0) return;
+  const uint32_t s = blend565_expand(src) * a5 + BLEND565_HALF;
+  const uint32_t inv = 32 - a5;
+  for (int i = 0; i < n; ++i) {
+    const uint16_t d = __builtin_bswap16(dst[i]);
+    dst[i] = __builtin_bswap16(blend565_fold(((blend565_expand(d) * inv + s) >> 5) & BLEND565_MASK));
+  }
+}
+
+// Byte swap within each 16-bit half: two big-endian pixels to native order and back
+static inline uint32_t swap_pair(uint32_t w) { return ((w >> 8) & 0x00FF00FF) | ((w & 0x00FF00FF) << 8); }
+
+// A channel of both pixels sits in its own 16-bit lane, 11 or more bits
+// wide for a product of at most 63 * 32 + 63 * 32 + 16: the same formula
+// as blend565() per channel, so the result is identical.
+void blend565_span_be_pairs(uint16_t *__restrict dst, int n, uint16_t src, uint8_t alpha)
+{
+  typedef uint32_t __attribute__((may_alias, aligned(4))) pair_t;
+  const uint32_t a5 = blend565_alpha5(alpha);
+  if (a5 == 0 || n <= 0) return;
+  if (reinterpret_cast<uintptr_t>(dst) & 2) {
+    blend565_span_be_px(dst, 1, src, alpha);
+    ++dst;
+    --n;
+  }
+  const uint32_t inv = 32 - a5;
+  const uint32_t sb = ((src & 0x1Fu) * a5 + 16) * 0x10001u;
+  const uint32_t sg = (((src >> 5) & 0x3Fu) * a5 + 16) * 0x10001u;
+  const uint32_t sr = (((uint32_t)src >> 11) * a5 + 16) * 0x10001u;
+  pair_t *p = reinterpret_cast<pair_t *>(dst);
+  for (int i = 0; i < n / 2; ++i) {
+    const uint32_t c = swap_pair(p[i]);
+    const uint32_t b = (((c & 0x001F001F) * inv + sb) >> 5) & 0x001F001F;
+    const uint32_t g = ((((c >> 5) & 0x003F003F) * inv + sg) >> 5) & 0x003F003F;
+    const uint32_t r = ((((c >> 11) & 0x001F001F) * inv + sr) >> 5) & 0x001F001F;
+    p[i] = swap_pair(b | g << 5 | r << 11);
+  }
+  if (n & 1) blend565_span_be_px(dst + n - 1, 1, src, alpha);
+}
+
+void blend565_span_be(uint16_t *dst, int n, uint16_t src, uint8_t alpha)
+{
+#if BLEND565_PAIRS
+  blend565_span_be_pairs(dst, n, src, alpha);
+#else
+  blend565_span_be_px(dst, n, src, alpha);
+#endif
+}
@@ -0,0 +1,36 @@
+// RGB565 alpha blending (no ESP-IDF deps). One 32-bit multiply blends all
+// three channels of a pixel: the channels are spread to 0x07E0F81F so each
+// has 5 spare bits above it for the 5-bit alpha product.
+#pragma once
+
+#include <cstdint>
+
+constexpr uint32_t BLEND565_MASK = 0x07E0F81F;
+constexpr uint32_t BLEND565_HALF = 0x02008010;   // +16 in each channel: round, don't truncate
+
+// 0..255 to 0..32, the precision the kernel works at
+inline uint32_t blend565_alpha5(uint8_t alpha) { return ((uint32_t)alpha * 32 + 127) / 255; }
+
+inline uint32_t blend565_expand(uint16_t c) { return (c | ((uint32_t)c << 16)) & BLEND565_MASK; }
+inline uint16_t blend565_fold(uint32_t x)   { return (uint16_t)(x | (x >> 16)); }
+
+// round((src * a5 + dst * (32 - a5)) / 32) per channel
+inline uint16_t blend565(uint16_t dst, uint16_t src, uint8_t alpha)
+{
+  const uint32_t a5 = blend565_alpha5(alpha);
+  const uint32_t x = blend565_expand(src) * a5 + blend565_expand(dst) * (32 - a5) + BLEND565_HALF;
+  return blend565_fold((x >> 5) & BLEND565_MASK);
+}
+
+// Blend `src` over `n` pixels in place. The _be variant takes big-endian
+// pixels as stored in LGFX 16-bit sprites and band buffers.
+void blend565_span(uint16_t *dst, int n, uint16_t src, uint8_t alpha);
+void blend565_span_be(uint16_t *dst, int n, uint16_t src, uint8_t alpha);
+
+// The two loops blend565_span_be can run, equal bit for bit: one pixel per
+// 16-bit load/store (vectorised by host compilers), or a pixel pair per
+// 32-bit load/store with one multiply per channel for both pixels.
+// BLEND565_PAIRS picks one (default: pairs on Xtensa, scalar elsewhere);
+// both are exported for blend_bench and the console's `blend` command.
+void blend565_span_be_px(uint16_t *dst, int n, uint16_t src, uint8_t alpha);
+void blend565_span_be_pairs(uint16_t *dst, int n, uint16_t src, uint8_t alpha);
@@ -0,0 +1,105 @@
+extern "C" {
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+}
+
+#include "boot.hpp"
+#include "games.hpp"
+#include "mem_report.hpp"
+#include <atomic>
+
+static const char *TAG_BOOT = "BOOT";
+
+static const char *const STAGE_NAMES[BOOT_STAGE_COUNT] = {
+  "entry", "display", "touch", "first frame", "deferred",
+};
+
+namespace {
+
+// Left alone by the startup code: survives everything but a power cycle
+RTC_NOINIT_ATTR GameSnapshot s_rtc_snap;
+
+volatile int64_t s_stage_us[BOOT_STAGE_COUNT];   // 0 until reached
+SnapshotStore    s_resume(s_rtc_snap);
+// Set by the defer task while it waits; whoever exchanges it back to
+// nullptr owns the wake-up, so nobody notifies a task that is gone
+std::atomic<TaskHandle_t> s_defer_task{nullptr};
+void           (*s_defer_fn)() = nullptr;
+
+bool reached(BootStage stage) { return s_stage_us[stage] != 0; }
+
+void log_timeline()
+{
+  for (int i = 0; i < BOOT_STAGE_COUNT; ++i) {
+    if (s_stage_us[i]) ESP_LOGI(TAG_BOOT, "%-11s %7lld us", STAGE_NAMES[i], (long long)s_stage_us[i]);
+    else               ESP_LOGI(TAG_BOOT, "%-11s       -", STAGE_NAMES[i]);
+  }
+}
+
+void defer_task(void *)
+{
+  s_defer_task.store(xTaskGetCurrentTaskHandle());
+  // Polls too, in case the first frame landed before the handle was set
+  bool notified = false;
+  while (!notified && !reached(BOOT_FIRST_FRAME)) notified = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100)) > 0;
+  // boot_mark took the handle: its notification is on the way, wait for
+  // it before this task can be deleted
+  if (!notified && !s_defer_task.exchange(nullptr)) ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+  if (s_defer_fn) s_defer_fn();
+  boot_mark(BOOT_DEFERRED);
+  log_timeline();
+  vTaskDelete(nullptr);
+}
+
+} // namespace
+
+RAM_ACCOUNT(boot, "boot + snapshot", sizeof(s_stage_us) + sizeof(s_resume));
+
+void boot_begin()
+{
+  boot_mark(BOOT_ENTRY);
+
+  esp_reset_reason_t why = esp_reset_reason();
+  // After power-on RTC memory is noise (the CRC would catch it anyway); after
+  // a crash the saved state may be what crashed us, so start clean
+  bool trusted = why != ESP_RST_POWERON && why != ESP_RST_PANIC &&
+                 why != ESP_RST_INT_WDT && why != ESP_RST_TASK_WDT;
+  if (s_resume.boot(trusted, GAME_COUNT)) {
+    ESP_LOGI(TAG_BOOT, "reset %d, resuming game %d (seq %u)", (int)why, s_resume.game(), (unsigned)s_resume.seq());
+  } else {
+    ESP_LOGI(TAG_BOOT, "reset %d, cold start", (int)why);
+  }
+}
+
+void boot_mark(BootStage stage)
+{
+  if (reached(stage)) return;
+  s_stage_us[stage] = esp_timer_get_time();
+  if (stage != BOOT_FIRST_FRAME) return;
+  if (TaskHandle_t task = s_defer_task.exchange(nullptr)) xTaskNotifyGive(task);
+}
+
+void boot_defer(void (*fn)())
+{
+  s_defer_fn = fn;
+  xTaskCreate(defer_task, "boot_defer", 4096, nullptr, tskIDLE_PRIORITY + 1, nullptr);
+}
+
+int resume_game()
+{
+  return s_resume.game();
+}
+
+bool resume_claim(int game, GameSnapshot &out)
+{
+  return s_resume.claim(game, out);
+}
+
+void resume_save(GameSnapshot &snap)
+{
+  s_resume.save(snap);
+}
@@ -0,0 +1,34 @@
+// Boot sequencing: stage timestamps, RTC-retained game snapshot, and
+// setup that is deferred until the first frame is on screen
+#pragma once
+
+#include "snapshot.hpp"
+
+enum BootStage {
+  BOOT_ENTRY = 0,     // app_main
+  BOOT_DISPLAY,       // panel initialised
+  BOOT_TOUCH,         // touch bus up (runs in parallel with the panel)
+  BOOT_FIRST_FRAME,   // first game frame flushed
+  BOOT_DEFERRED,      // non-essential setup finished
+  BOOT_STAGE_COUNT
+};
+
+// Call first thing in app_main: marks BOOT_ENTRY and picks up the RTC snapshot
+void boot_begin();
+
+// Records the first time each stage is reached; cheap enough for the frame loop
+void boot_mark(BootStage stage);
+
+// Runs `fn` on a low-priority task once BOOT_FIRST_FRAME is marked, then
+// logs the stage timeline
+void boot_defer(void (*fn)());
+
+// ---- Resume ----
+// Game found in RTC memory at boot, or -1
+int  resume_game();
+// One-shot: true (and fills `out`) if the boot snapshot belongs to `game`
+bool resume_claim(int game, GameSnapshot &out);
+// Seal and store into RTC memory. Resumed after soft resets and deep sleep;
+// dropped after power-on, panics and watchdog resets (boot_begin), since
+// the saved state may be what crashed
+void resume_save(GameSnapshot &snap);
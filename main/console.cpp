@@ -0,0 +1,70 @@
+#include "console.hpp"
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+void Console::feed(const char *data, size_t len)
+{
+  for (size_t i = 0; i < len; ++i) {
+    const char c = data[i];
+    if (c == '\r' || c == '\n') {
+      if (echo_) print("\r\n");
+      if (overflow_) print("error: line too long\r\n");
+      else if (len_) { line_[len_] = 0; dispatch(); }
+      len_ = 0;
+      overflow_ = false;
+    } else if (c == '\b' || c == 0x7F) {
+      if (len_ && !overflow_) { --len_; if (echo_) print("\b \b"); }
+    } else if (len_ < LINE_LEN - 1) {
+      line_[len_++] = c;
+      if (echo_) write_(&c, 1);
+    } else {
+      overflow_ = true;
+    }
+  }
+}
+
+void Console::print(const char *text) { write_(text, std::strlen(text)); }
+
+void Console::printf(const char *fmt, ...)
+{
+  char buf[160];
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+  va_end(ap);
+  if (n > 0) write_(buf, (size_t)n < sizeof(buf) ? (size_t)n : sizeof(buf) - 1);
+}
+
+void Console::dispatch()
+{
+  char *argv[MAX_ARGS];
+  int argc = 0;
+  for (char *p = line_; *p && argc < MAX_ARGS;) {
+    while (*p == ' ' || *p == '\t') *p++ = 0;
+    if (!*p) break;
+    argv[argc++] = p;
+    while (*p && *p != ' ' && *p != '\t') ++p;
+  }
+  if (!argc) return;
+
+  if (std::strcmp(argv[0], "help") == 0) {
+    for (int i = 0; i < count_; ++i) printf("  %-8s %s\r\n", cmds_[i].name, cmds_[i].usage);
+    return;
+  }
+  for (int i = 0; i < count_; ++i)
+    if (std::strcmp(argv[0], cmds_[i].name) == 0) { cmds_[i].run(*this, argc, argv); return; }
+  printf("unknown command '%s', try help\r\n", argv[0]);
+}
+
+bool console_arg_int(const char *arg, const char *key, int &out)
+{
+  const size_t k = std::strlen(key);
+  if (std::strncmp(arg, key, k) != 0 || arg[k] != '=') return false;
+  char *end;
+  long v = std::strtol(arg + k + 1, &end, 10);
+  if (end == arg + k + 1 || *end) return false;
+  out = (int)v;
+  return true;
+}
@@ -0,0 +1,46 @@
+// Line-oriented command console core (no ESP-IDF deps). Bytes go in
+// through feed(), output leaves through a write callback, so the same
+// core runs on the UART task and on a host terminal.
+#pragma once
+
+#include <cstddef>
+
+class Console;
+
+struct ConsoleCommand {
+  const char *name;
+  const char *usage;   // shown by "help"
+  void (*run)(Console &con, int argc, char **argv);
+};
+
+class Console {
+public:
+  static constexpr int LINE_LEN = 96;
+  static constexpr int MAX_ARGS = 8;
+
+  using WriteFn = void (*)(const char *data, size_t len);
+
+  Console(const ConsoleCommand *cmds, int count, WriteFn write, bool echo)
+    : cmds_(cmds), count_(count), write_(write), echo_(echo) {}
+
+  // Any chunk of input; complete lines are dispatched before this returns.
+  // Overlong lines are dropped with an error rather than truncated.
+  void feed(const char *data, size_t len);
+
+  void print(const char *text);
+  void printf(const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+private:
+  void dispatch();
+
+  const ConsoleCommand *cmds_;
+  int     count_;
+  WriteFn write_;
+  bool    echo_;
+  char    line_[LINE_LEN];
+  int     len_ = 0;
+  bool    overflow_ = false;
+};
+
+// Parses "key=value" into an int; false when `arg` is not that key
+bool console_arg_int(const char *arg, const char *key, int &out);
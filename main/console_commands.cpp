@@ -0,0 +1,146 @@
+#include "console_commands.hpp"
+#include "game_common.hpp"
+#include "games.hpp"
+#include "mem_report.hpp"
+#include "blend565.hpp"
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+PerfCounters s_perf;
+TapStats     s_taps;   // console task's copy for printing
+
+void cmd_stats(Console &con, int, char **)
+{
+  PerfSnapshot s;
+  if (!s_perf.read(s)) { con.print("no stats yet\r\n"); return; }
+  perf_print(s, con);
+  const ConsoleHeap heap = console_heap();
+  con.printf("heap %u B free, %u B minimum\r\n", (unsigned)heap.free_bytes, (unsigned)heap.min_free_bytes);
+  mem_report_stacks([](const char *name, unsigned free_bytes, void *ctx) {
+    static_cast<Console *>(ctx)->printf("stack %-12s %u B never used\r\n", name, free_bytes);
+  }, &con);
+}
+
+void cmd_mem(Console &con, int, char **)
+{
+  mem_report([](const char *line, void *ctx) { static_cast<Console *>(ctx)->printf("%s\r\n", line); }, &con);
+}
+
+void cmd_reset(Console &con, int, char **)
+{
+  s_perf.request_reset();
+  con.print("counters reset at next frame\r\n");
+}
+
+// Both blend565_span_be loops over one scene band of internal RAM, best of
+// `rounds` in CPU cycles (interrupts and the render task only add time)
+void cmd_blend(Console &con, int argc, char **argv)
+{
+  const int rounds = argc > 1 ? atoi(argv[1]) : 20;
+  if (rounds <= 0) { con.print("usage: blend [rounds]\r\n"); return; }
+  constexpr int N = Scene::BAND_PIXELS;
+  uint16_t *buf = static_cast<uint16_t *>(console_alloc_internal(2 * N * sizeof(uint16_t)));
+  if (!buf) { con.print("no memory for two bands\r\n"); return; }
+  void (*const loops[2])(uint16_t *, int, uint16_t, uint8_t) = { blend565_span_be_px, blend565_span_be_pairs };
+  uint32_t best[2] = { UINT32_MAX, UINT32_MAX };
+  for (int r = 0; r < rounds; ++r) {
+    for (int k = 0; k < 2; ++k) {
+      uint16_t *band = buf + k * N;
+      for (int i = 0; i < N; ++i) band[i] = (uint16_t)((uint32_t)i * 2654435761u >> 16);
+      const uint32_t c0 = console_cycles();
+      loops[k](band, N, 0xFD20, (uint8_t)(r * 7 + 1));
+      const uint32_t c = console_cycles() - c0;
+      if (c < best[k]) best[k] = c;
+    }
+  }
+  const bool same = memcmp(buf, buf + N, N * sizeof(uint16_t)) == 0;
+  console_free_internal(buf);
+  con.printf("blend %d px, best of %d: per-pixel %u.%02u, pairs %u.%02u cycles/px%s\r\n", N, rounds,
+             (unsigned)(best[0] / N), (unsigned)(best[0] % N * 100 / N), (unsigned)(best[1] / N),
+             (unsigned)(best[1] % N * 100 / N), same ? "" : " (RESULTS DIFFER)");
+}
+
+void cmd_game(Console &con, int argc, char **argv)
+{
+#if ENABLE_GAME_SWITCH
+  const int g = argc > 1 ? atoi(argv[1]) : 0;
+  if (g < 1 || g > GAME_COUNT) { con.printf("usage: game <1-%d>\r\n", GAME_COUNT); return; }
+  request_game(g - 1);
+  con.printf("switching to game %d\r\n", g);
+#else
+  (void)argc; (void)argv;
+  con.print("built without ENABLE_GAME_SWITCH\r\n");
+#endif
+}
+
+void cmd_quality(Console &con, int argc, char **argv)
+{
+  if (argc > 1) {
+    const bool automatic = !strcmp(argv[1], "auto");
+    const int t = atoi(argv[1]);
+    if (!automatic && (t < 0 || t >= QUALITY_TIER_COUNT || !isdigit((unsigned char)argv[1][0]))) {
+      con.printf("usage: quality [auto|0-%d]\r\n", QUALITY_TIER_COUNT - 1);
+      return;
+    }
+    quality_pin(automatic ? -1 : t);
+    con.print("applied at next frame\r\n");
+    return;
+  }
+  const QualityTier &q = QUALITY_TIERS[quality_tier()];
+  con.printf("tier %d of %d (%s), budget %u us: burst %d, ring %d px, life %d-%d frames\r\n",
+             quality_tier(), QUALITY_TIER_COUNT - 1, quality_pinned() ? "pinned" : "auto",
+             (unsigned)QUALITY_BUDGET_US, q.burst, q.ring_thickness, q.life_min, q.life_max);
+}
+
+void cmd_fx(Console &con, int argc, char **argv)
+{
+  EffectLimits lim = effect_limits();
+  for (int i = 1; i < argc; ++i) {
+    if (!console_arg_int(argv[i], "burst", lim.burst) && !console_arg_int(argv[i], "particles", lim.particles) &&
+        !console_arg_int(argv[i], "ripples", lim.ripples)) {
+      con.printf("bad argument '%s'\r\n", argv[i]);
+      return;
+    }
+  }
+  if (argc > 1) set_effect_limits(lim);
+  lim = effect_limits();
+  con.printf("burst<=%d (tier %d: %d) particles=%d (max %d) ripples=%d (max %d)\r\n", lim.burst,
+             quality_tier(), QUALITY_TIERS[quality_tier()].burst, lim.particles, MAX_PARTICLES, lim.ripples,
+             MAX_RIPPLES);
+}
+
+void cmd_touch(Console &con, int argc, char **argv)
+{
+  const int frames = argc > 1 ? atoi(argv[1]) : 300;
+  if (frames <= 0) { con.print("usage: touch [frames]\r\n"); return; }
+  touch_trace(frames);
+  con.printf("tracing %d touch samples\r\n", frames);
+}
+
+void cmd_taps(Console &con, int argc, char **argv)
+{
+  const bool reset = argc > 1 && !strcmp(argv[1], "reset");
+  if (argc > 1 && !reset) { con.print("usage: taps [reset]\r\n"); return; }
+  if (!tap_stats_copy(s_taps, reset)) { con.print("render loop not running\r\n"); return; }
+  s_taps.format([](const char *line, void *ctx) { static_cast<Console *>(ctx)->printf("%s\r\n", line); }, &con);
+}
+
+} // namespace
+
+const ConsoleCommand CONSOLE_COMMANDS[] = {
+  { "stats", "live counters",                                   cmd_stats },
+  { "mem",   "full memory report",                              cmd_mem },
+  { "reset", "clear counters",                                  cmd_reset },
+  { "game",  "<1-3> switch game",                               cmd_game },
+  { "fx",    "[burst=N] [particles=N] [ripples=N] effect limits", cmd_fx },
+  { "quality", "[auto|0-4] governor tier, or pin one",           cmd_quality },
+  { "touch", "[frames] print raw touch samples as a gesture trace", cmd_touch },
+  { "taps",  "[reset] tap heatmap, hit offsets, region miss rates", cmd_taps },
+  { "blend", "[rounds] cycles per pixel of the two blend loops",  cmd_blend },
+};
+const int CONSOLE_COMMAND_COUNT = sizeof(CONSOLE_COMMANDS) / sizeof(CONSOLE_COMMANDS[0]);
+
+PerfCounters &console_perf() { return s_perf; }
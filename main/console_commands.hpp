@@ -0,0 +1,28 @@
+// The stats console's commands (no ESP-IDF deps). Handlers reach the
+// render task only through its handshakes in game_common.hpp (request_game,
+// quality_pin, set_effect_limits, touch_trace, tap_stats_copy) and
+// PerfCounters, so the UART task and tools/console_host run the same table.
+#pragma once
+
+#include "console.hpp"
+#include "perf_stats.hpp"
+#include <cstddef>
+#include <cstdint>
+
+// "help", "stats", "mem", "reset", "game <1-3>", "fx [burst=N]
+// [particles=N] [ripples=N]", "quality [auto|0-4]", "touch [frames]",
+// "taps [reset]", "blend [rounds]"
+extern const ConsoleCommand CONSOLE_COMMANDS[];
+extern const int CONSOLE_COMMAND_COUNT;
+
+// Counters the render loop publishes and `stats` reads
+PerfCounters &console_perf();
+
+// ---- Platform side: defined by stats_console.cpp on the device, by the host tool otherwise ----
+struct ConsoleHeap {
+  uint32_t free_bytes, min_free_bytes;
+};
+ConsoleHeap console_heap();
+uint32_t    console_cycles();                      // CPU cycle counter
+void       *console_alloc_internal(size_t bytes);  // internal RAM, nullptr when short
+void        console_free_internal(void *p);
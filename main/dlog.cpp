@@ -0,0 +1,79 @@
+extern "C" {
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+}
+
+#include "dlog.hpp"
+#include "dlog_ring.hpp"
+#include "mem_report.hpp"
+#include <cstdio>
+
+static const char *TAG_DLOG = "DLOG";
+
+static constexpr size_t   RING_SIZE = 128;
+static constexpr uint32_t DRAIN_MS  = 50;
+
+#define DLOG_TAG_ENTRY(id, tag, fmt) tag,
+#define DLOG_FMT_ENTRY(id, tag, fmt) fmt,
+static const char *const s_tags[] = { DLOG_MESSAGES(DLOG_TAG_ENTRY) };
+static const char *const s_fmts[] = { DLOG_MESSAGES(DLOG_FMT_ENTRY) };
+#undef DLOG_TAG_ENTRY
+#undef DLOG_FMT_ENTRY
+
+static DlogRing<RING_SIZE> s_ring;
+
+RAM_ACCOUNT(dlog, "dlog ring", sizeof(s_ring));
+
+static void print_record(const DlogRecord &r)
+{
+#if DLOG_BINARY_OUTPUT
+  const uint8_t *b = reinterpret_cast<const uint8_t *>(&r);
+  char hex[sizeof(r) * 2 + 1];
+  for (size_t i = 0; i < sizeof(r); ++i) snprintf(&hex[i * 2], 3, "%02x", b[i]);
+  printf("DLOG:%s\n", hex);
+#else
+  if (r.id >= DLOG_COUNT) { ESP_LOGW(TAG_DLOG, "unknown id %u", r.id); return; }
+  char msg[96];
+  snprintf(msg, sizeof(msg), s_fmts[r.id], r.args[0], r.args[1], r.args[2]);
+  ESP_LOGI(s_tags[r.id], "@%u.%03u ms %s", (unsigned)(r.ts_us / 1000), (unsigned)(r.ts_us % 1000), msg);
+#endif
+}
+
+static void drain_task(void *)
+{
+  uint32_t reported_drops = 0;
+  while (true) {
+    DlogRecord r;
+    while (s_ring.pop(r)) print_record(r);
+    uint32_t drops = s_ring.dropped();
+    if (drops != reported_drops) {
+      ESP_LOGW(TAG_DLOG, "%u records dropped (ring full)", (unsigned)(drops - reported_drops));
+      reported_drops = drops;
+    }
+    vTaskDelay(pdMS_TO_TICKS(DRAIN_MS));
+  }
+}
+
+void dlog_init()
+{
+  TaskHandle_t task = nullptr;
+  xTaskCreate(drain_task, "dlog", 3072, nullptr, tskIDLE_PRIORITY + 1, &task);
+  mem_report_track_task(task, "dlog");
+}
+
+void dlog_write(DlogId id, int nargs, int32_t a, int32_t b, int32_t c)
+{
+  DlogRecord r;
+  r.ts_us = (uint32_t)esp_timer_get_time();
+  r.id = id;
+  r.nargs = (uint16_t)nargs;
+  r.args[0] = a; r.args[1] = b; r.args[2] = c;
+  s_ring.push(r);
+}
+
+uint32_t dlog_dropped()
+{
+  return s_ring.dropped();
+}
@@ -0,0 +1,23 @@
+// Deferred logging for the frame loop: a call stores only a timestamp, a
+// message id and raw integer arguments; a low-priority task formats and
+// prints them later. Messages are declared in dlog_messages.hpp.
+#pragma once
+
+#include "dlog_messages.hpp"
+#include <cstdint>
+
+#ifndef DLOG_BINARY_OUTPUT
+#define DLOG_BINARY_OUTPUT 0   // 1: print raw "DLOG:<hex>" records for tools/dlog_decode
+#endif
+
+void dlog_init();
+
+void dlog_write(DlogId id, int nargs, int32_t a, int32_t b, int32_t c);
+
+inline void dlog(DlogId id)                                { dlog_write(id, 0, 0, 0, 0); }
+inline void dlog(DlogId id, int32_t a)                     { dlog_write(id, 1, a, 0, 0); }
+inline void dlog(DlogId id, int32_t a, int32_t b)          { dlog_write(id, 2, a, b, 0); }
+inline void dlog(DlogId id, int32_t a, int32_t b, int32_t c) { dlog_write(id, 3, a, b, c); }
+
+// Records lost because the ring was full when they were written
+uint32_t dlog_dropped();
@@ -0,0 +1,21 @@
+// Message table for the deferred logger. Shared with tools/dlog_decode.cpp,
+// so only append: ids are positions in this list and are stored in dumps.
+//   X(id, tag, printf format with up to 3 int arguments)
+#pragma once
+
+#include <cstdint>
+
+#define DLOG_MESSAGES(X)                                        \
+  X(GAME_BEST,          "GAME",  "game %d best score %d")       \
+  X(GAME_SWITCH,        "GAME",  "game %d: switch button")      \
+  X(GAME3_MISS_TIMEOUT, "GAME3", "Miss (timeout) cell %d")      \
+  X(GAME3_MISS_WRONG,   "GAME3", "Miss (wrong cell) %d, want %d") \
+  X(QUALITY_TIER,       "QUALITY", "tier %d -> %d at %d us frame work") \
+  X(GAME_SLOT,          "GAME",  "slot %d: GAME_MODE=%d -> %d")
+
+#define DLOG_ENUM_ENTRY(id, tag, fmt) DLOG_##id,
+enum DlogId : uint16_t {
+  DLOG_MESSAGES(DLOG_ENUM_ENTRY)
+  DLOG_COUNT
+};
+#undef DLOG_ENUM_ENTRY
@@ -0,0 +1,73 @@
+// Bounded lock-free multi-producer ring of fixed-size binary log records
+// (no ESP-IDF deps). Producers never block: a full ring drops the record
+// and counts it.
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// On-wire layout, little-endian, as printed by dlog_dump and read by tools/dlog_decode
+struct DlogRecord {
+  uint32_t ts_us;     // low 32 bits of the boot-relative microsecond clock
+  uint16_t id;        // DlogId
+  uint16_t nargs;
+  int32_t  args[3];
+};
+static_assert(sizeof(DlogRecord) == 20, "decoder expects 20-byte records");
+
+template <size_t N>
+class DlogRing {
+  static_assert((N & (N - 1)) == 0, "ring size must be a power of two");
+
+public:
+  DlogRing()
+  {
+    for (size_t i = 0; i < N; ++i) slots_[i].seq.store((uint32_t)i, std::memory_order_relaxed);
+  }
+
+  bool push(const DlogRecord &r)
+  {
+    uint32_t pos = head_.load(std::memory_order_relaxed);
+    for (;;) {
+      Slot &s = slots_[pos & (N - 1)];
+      int32_t diff = (int32_t)(s.seq.load(std::memory_order_acquire) - pos);
+      if (diff == 0) {
+        if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          s.rec = r;
+          s.seq.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      } else {
+        pos = head_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Single consumer
+  bool pop(DlogRecord &out)
+  {
+    Slot &s = slots_[tail_ & (N - 1)];
+    if ((int32_t)(s.seq.load(std::memory_order_acquire) - (tail_ + 1)) < 0) return false;
+    out = s.rec;
+    s.seq.store(tail_ + N, std::memory_order_release);
+    ++tail_;
+    return true;
+  }
+
+  uint32_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+  struct Slot {
+    std::atomic<uint32_t> seq;
+    DlogRecord rec;
+  };
+
+  Slot                  slots_[N];
+  std::atomic<uint32_t> head_{0};
+  uint32_t              tail_ = 0;
+  std::atomic<uint32_t> dropped_{0};
+};
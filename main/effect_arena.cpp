@@ -0,0 +1,26 @@
+#include "effect_arena.hpp"
+
+static inline size_t align_up(size_t v, size_t a) { return (v + a - 1) & ~(a - 1); }
+
+void *Arena::alloc(size_t bytes, size_t align)
+{
+  size_t start = align_up(reinterpret_cast<uintptr_t>(base_) + used_, align) - reinterpret_cast<uintptr_t>(base_);
+  if (start > cap_ || bytes > cap_ - start) { ++failures_; return nullptr; }
+  used_ = start + bytes;
+  if (used_ > high_water_) high_water_ = used_;
+  return base_ + start;
+}
+
+size_t Arena::fit_count(size_t elem, size_t align) const
+{
+  size_t start = align_up(reinterpret_cast<uintptr_t>(base_) + used_, align) - reinterpret_cast<uintptr_t>(base_);
+  if (elem == 0 || start >= cap_) return 0;
+  return (cap_ - start) / elem;
+}
+
+Arena &effect_arena()
+{
+  alignas(8) static uint8_t buf[EFFECT_ARENA_BYTES];
+  static Arena arena(buf, sizeof(buf));
+  return arena;
+}
@@ -0,0 +1,59 @@
+// Bump allocator over one static buffer. Each game slot borrows its effect
+// pools here once at boot and keeps them from game to game, so nothing is
+// handed back while running. (no ESP-IDF deps)
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+class Arena {
+public:
+  Arena(void *buf, size_t size) : base_(static_cast<uint8_t *>(buf)), cap_(size) {}
+
+  // nullptr when the request does not fit; nothing is partially taken
+  void *alloc(size_t bytes, size_t align);
+
+  // Up to `want` zero-initialised T, at least `min_count` or none at all.
+  // `got` receives the count actually granted.
+  template <typename T>
+  T *alloc_array(size_t want, size_t min_count, size_t &got)
+  {
+    size_t n = fit_count(sizeof(T), alignof(T));
+    if (n > want) n = want;
+    got = 0;
+    if (n == 0 || n < min_count) { ++failures_; return nullptr; }
+    T *arr = static_cast<T *>(alloc(n * sizeof(T), alignof(T)));
+    for (size_t i = 0; i < n; ++i) new (&arr[i]) T();
+    got = n;
+    return arr;
+  }
+
+  void reset() { used_ = 0; }
+
+  // How many `elem`-sized objects still fit after alignment
+  size_t fit_count(size_t elem, size_t align) const;
+
+  size_t   used() const { return used_; }
+  size_t   capacity() const { return cap_; }
+  size_t   high_water() const { return high_water_; }
+  uint32_t failures() const { return failures_; }
+
+private:
+  uint8_t *base_;
+  size_t   cap_;
+  size_t   used_ = 0;
+  size_t   high_water_ = 0;
+  uint32_t failures_ = 0;
+};
+
+#ifndef SPLIT_SCREEN
+#define SPLIT_SCREEN 0
+#endif
+
+// Sized for the hungriest game (48 particles + 6 ripples with headroom),
+// once per slot on screen
+constexpr size_t EFFECT_ARENA_BYTES = 3072 * (SPLIT_SCREEN ? 2 : 1);
+
+// The shared arena all games borrow from
+Arena &effect_arena();
@@ -0,0 +1,190 @@
+// Particle emitters assembled from compile-time behaviour policies (no
+// ESP-IDF deps). Emitter<Policies...> folds every policy's hooks into one
+// spawn loop and one update loop. A hook a policy leaves out is the empty
+// inline one from Policy and compiles away, so an emitter pays only for
+// the behaviours it lists.
+//
+// Positions and velocities are in 1/16 px, so gravity and drag can act
+// below a pixel per frame. Angles are in 1/64 turns, 0 pointing right and
+// 16 down (screen y grows downwards).
+#pragma once
+
+#include "blend565.hpp"
+#include <cstdint>
+
+constexpr int SUBPX = 16;
+constexpr int SUBPX_SHIFT = 4;
+
+struct Particle {
+  int x, y;          // 1/16 px
+  int vx, vy;        // 1/16 px per frame
+  int r;
+  int life, life0;   // frames left / at spawn
+  uint16_t color;    // at spawn; paint policies derive the shown colour
+  bool active;
+  int node;
+};
+
+// One spawn call
+struct EmitParams {
+  int      cx, cy;              // px
+  uint16_t color;
+  int      burst;               // particles at most
+  int      life_min, life_max;  // frames
+};
+
+// An emitter drives a Sink (the scene in the games, counters in the host
+// benchmark):
+//   int  add(int x, int y, int r, uint16_t color)   node, < 0 when full
+//   void remove(int node)
+//   void move(int node, int x, int y)
+//   void alpha(int node, uint8_t a)
+//   void color(int node, uint16_t c)
+// and draws randoms from a Rand: int operator()(int lo, int hi), inclusive.
+
+// Q8 sine over 1/64 turns
+inline int sin64(int a)
+{
+  static constexpr int16_t QUARTER[17] = { 0, 25, 50, 74, 98, 121, 142, 162, 181, 198, 213, 226, 237, 245, 251, 255, 256 };
+  a &= 63;
+  const int q = a & 15;
+  const int v = (a & 16) ? QUARTER[16 - q] : QUARTER[q];
+  return (a & 32) ? -v : v;
+}
+inline int cos64(int a) { return sin64(a + 16); }
+
+// Arithmetic shift: floors, so motion stays even across 0
+inline int subpx_to_px(int v) { return v >> SUBPX_SHIFT; }
+
+// Every hook a policy can define, all doing nothing
+struct Policy {
+  template <typename Rand> static void launch(Particle &, Rand &) {}   // initial velocity
+  static void force(Particle &) {}                                     // before moving
+  static void collide(Particle &) {}                                   // after moving
+  template <typename Sink> static void paint(Sink &, const Particle &) {}
+};
+
+// ---- Launch shapes ----
+
+// Square scatter up to `Max` px per frame on each axis, never standing still
+template <int Max>
+struct Scatter : Policy {
+  template <typename Rand> static void launch(Particle &p, Rand &rand)
+  {
+    int vx = rand(-Max, Max), vy = rand(-Max, Max);
+    if (vx == 0 && vy == 0) vx = 1;
+    p.vx = vx * SUBPX; p.vy = vy * SUBPX;
+  }
+};
+
+// Evenly in every direction at `Speed` (1/16 px per frame) +-25%
+template <int Speed>
+struct RadialBurst : Policy {
+  template <typename Rand> static void launch(Particle &p, Rand &rand)
+  {
+    const int a = rand(0, 63), s = rand(Speed - Speed / 4, Speed + Speed / 4);
+    p.vx = cos64(a) * s / 256; p.vy = sin64(a) * s / 256;
+  }
+};
+
+// Within `Spread` of direction `Dir` (1/64 turns), at half to full `Speed`
+template <int Dir, int Spread, int Speed>
+struct ConeSpray : Policy {
+  template <typename Rand> static void launch(Particle &p, Rand &rand)
+  {
+    const int a = Dir + rand(-Spread, Spread), s = rand(Speed / 2, Speed);
+    p.vx = cos64(a) * s / 256; p.vy = sin64(a) * s / 256;
+  }
+};
+
+// ---- Motion ----
+
+// Downwards, in 1/16 px per frame per frame
+template <int G>
+struct Gravity : Policy {
+  static void force(Particle &p) { p.vy += G; }
+};
+
+// Keeps Keep/256 of the velocity each frame
+template <int Keep>
+struct Drag : Policy {
+  static void force(Particle &p) { p.vx = p.vx * Keep / 256; p.vy = p.vy * Keep / 256; }
+};
+
+// Reflects off the bottom edge of a bar `Top` px tall (the HUD), keeping
+// Keep/256 of the speed
+template <int Top, int Keep = 192>
+struct BounceTop : Policy {
+  static void collide(Particle &p)
+  {
+    const int edge = (Top + p.r) * SUBPX;
+    if (p.y >= edge || p.vy >= 0) return;
+    p.y = 2 * edge - p.y;
+    p.vy = -p.vy * Keep / 256;
+  }
+};
+
+// ---- Appearance ----
+
+// Transparency follows remaining life
+struct FadeAlpha : Policy {
+  template <typename Sink> static void paint(Sink &sink, const Particle &p)
+  {
+    sink.alpha(p.node, (uint8_t)(p.life * 255 / p.life0));
+  }
+};
+
+// Colour runs from the spawn colour to `To` over the particle's life
+template <uint16_t To>
+struct ColorFade : Policy {
+  template <typename Sink> static void paint(Sink &sink, const Particle &p)
+  {
+    sink.color(p.node, blend565(p.color, To, (uint8_t)(255 - p.life * 255 / p.life0)));
+  }
+};
+
+// ---- Emitter ----
+
+template <typename... Policies>
+struct Emitter {
+  // Up to e.burst particles into free slots of parts[0..cap); returns how
+  // many were spawned
+  template <typename Sink, typename Rand>
+  static int spawn(Sink &sink, Particle *parts, int cap, const EmitParams &e, Rand &&rand)
+  {
+    int spawned = 0;
+    for (int i = 0; i < cap && spawned < e.burst; ++i) if (!parts[i].active) {
+      Particle &p = parts[i];
+      p.x = e.cx * SUBPX; p.y = e.cy * SUBPX;
+      p.vx = p.vy = 0;
+      (Policies::launch(p, rand), ...);
+      p.r = rand(2, 4);
+      p.life = p.life0 = rand(e.life_min, e.life_max);
+      // slight color variation: up to ~15% towards white or black
+      p.color = blend565(e.color, rand(0, 1) ? 0xFFFF : 0x0000, (uint8_t)rand(0, 40));
+      p.node = sink.add(e.cx, e.cy, p.r, p.color);
+      if (p.node < 0) break;   // scene full
+      p.active = true; ++spawned;
+    }
+    return spawned;
+  }
+
+  // One frame of every live particle in parts[0..n); expired ones release
+  // their nodes. Returns how many are still alive.
+  template <typename Sink>
+  static int step(Sink &sink, Particle *parts, int n)
+  {
+    int live = 0;
+    for (int i = 0; i < n; ++i) if (parts[i].active) {
+      Particle &p = parts[i];
+      (Policies::force(p), ...);
+      p.x += p.vx; p.y += p.vy;
+      (Policies::collide(p), ...);
+      if (--p.life <= 0) { sink.remove(p.node); p.active = false; continue; }
+      ++live;
+      sink.move(p.node, subpx_to_px(p.x), subpx_to_px(p.y));
+      (Policies::paint(sink, p), ...);
+    }
+    return live;
+  }
+};
@@ -3,12 +3,38 @@ extern "C" {
 #include "freertos/task.h"
 #include "esp_timer.h"
 #include "esp_random.h"
+#include "esp_log.h"
 }
 
 #include "game_common.hpp"
+#include "touch_dma.hpp"
+#include "effect_arena.hpp"
+#include "boot.hpp"
+#include "blend565.hpp"
+#include "stats_console.hpp"
+#include "dlog.hpp"
+#include "dlog_ring.hpp"
+#include "mem_report.hpp"
+#include <atomic>
 #include <algorithm>
+#include <cstdio>
+#include <cstring>
 
-uint32_t urand() { return esp_random(); }
+static const char *TAG_LAT = "LATENCY";
+static const char *TAG_GAME = "GAME";
+
+static uint32_t s_rand_state = 0;   // 0: hardware RNG
+
+uint32_t urand()
+{
+  if (!s_rand_state) return esp_random();
+  s_rand_state ^= s_rand_state << 13;
+  s_rand_state ^= s_rand_state >> 17;
+  s_rand_state ^= s_rand_state << 5;
+  return s_rand_state;
+}
+
+void rand_seed(uint32_t seed) { s_rand_state = seed; }
 
 int irand(int min_v, int max_v)
 {
@@ -26,52 +52,350 @@ void fix_touch_coords(uint16_t &x, uint16_t &y, int screen_width, int screen_hei
   if (y >= screen_height) y = screen_height - 1;
 }
 
-void spawn_ripple(Ripple ripples[], int sw, int sh, int x, int y, uint16_t color)
+static bool     s_virtual_clock = false;
+static uint32_t s_virtual_ms = 0;
+static int64_t  s_frame_start_us = 0;
+static FrameCost s_frame_cost = {};
+static TouchSourceFn s_touch_source = nullptr;
+static AimPoint s_aim = {};
+static LatencyTracker s_latency;
+static TapStats s_taps;
+static std::atomic<TapStats *> s_tap_copy_req{nullptr};
+static std::atomic<bool> s_tap_reset_req{false};
+static std::atomic<bool> s_tap_copied{false};
+// Report requests raised anywhere, served by reports_service; the render
+// task hands its latency window over in s_lat_window
+static std::atomic<bool> s_report_req{false};
+static std::atomic<bool> s_lat_take_req{false};
+static std::atomic<bool> s_lat_taken{false};
+static LatencyTracker s_lat_window;
+RAM_ACCOUNT(lat_window, "latency window", sizeof(s_lat_window));
+static bool     s_was_pressed = false;
+static GestureRecognizer s_gestures;
+static std::atomic<int> s_trace_frames{0};
+// Trace samples queued by the render task, formatted by touch_trace_drain:
+// args are t_ms, pressed, x | y << 16. The console drains it at least every
+// 100 ms, about ten frames at the 10 ms tick.
+static DlogRing<32> s_trace_ring;
+static uint32_t s_trace_reported_drops = 0;   // draining task only
+RAM_ACCOUNT(touch_trace, "touch trace", sizeof(s_trace_ring));
+static int      s_live_parts = 0, s_live_ripples = 0;
+
+static QualityGovernor s_quality(QUALITY_BUDGET_US);
+
+static std::atomic<int> s_lim_burst{MAX_PARTICLES};
+static std::atomic<int> s_lim_parts{MAX_PARTICLES};
+static std::atomic<int> s_lim_ripples{MAX_RIPPLES};
+static std::atomic<int> s_game_req{-1};
+static constexpr int QUALITY_NO_PIN_REQ = -2;
+static std::atomic<int> s_quality_pin_req{QUALITY_NO_PIN_REQ};
+static std::atomic<int> s_quality_tier{QUALITY_DEFAULT_TIER};   // console-readable copy
+static std::atomic<bool> s_quality_pinned{false};
+
+// Runs right after the frame's work is measured, before spawns of the next frame
+static void quality_frame(uint32_t cost_us)
+{
+  const int before = s_quality.tier();
+  const int pin = s_quality_pin_req.exchange(QUALITY_NO_PIN_REQ, std::memory_order_relaxed);
+  if (pin != QUALITY_NO_PIN_REQ) {
+    s_quality.pin(pin);
+    s_quality_pinned.store(s_quality.pinned(), std::memory_order_relaxed);
+  }
+  s_quality.frame(cost_us);
+  if (s_quality.tier() != before)
+    dlog(DLOG_QUALITY_TIER, before, s_quality.tier(), (int32_t)cost_us);
+  s_quality_tier.store(s_quality.tier(), std::memory_order_relaxed);
+}
+
+uint32_t game_millis()
+{
+  return s_virtual_clock ? s_virtual_ms : lgfx::v1::millis();
+}
+
+void frame_delay()
+{
+  int64_t now_us = esp_timer_get_time();
+  if (s_frame_start_us) {
+    uint32_t cost = (uint32_t)(now_us - s_frame_start_us);
+    s_frame_cost.last_us = cost;
+    s_frame_cost.max_us = std::max(s_frame_cost.max_us, cost);
+    s_frame_cost.sum_us += cost;
+    s_frame_cost.count++;
+    stats_frame(now_us, cost, s_aim.game, s_live_parts, s_live_ripples);
+    quality_frame(cost);
+  }
+  s_live_parts = s_live_ripples = 0;   // counted again by every game's step
+  if (TapStats *dst = s_tap_copy_req.exchange(nullptr, std::memory_order_acquire)) {
+    *dst = s_taps;
+    if (s_tap_reset_req.load(std::memory_order_relaxed)) s_taps.reset();
+    s_tap_copied.store(true, std::memory_order_release);
+  }
+  boot_mark(BOOT_FIRST_FRAME);
+  s_latency.flushed(now_us);   // games flush right before this
+  if (s_lat_take_req.exchange(false, std::memory_order_acquire)) {
+    s_lat_window = s_latency;
+    s_latency.reset();
+    s_lat_taken.store(true, std::memory_order_release);
+  }
+
+  if (s_virtual_clock) {
+    s_virtual_ms += FRAME_MS;
+    // Still block now and then so the idle task can feed the watchdog
+    if ((s_virtual_ms / FRAME_MS) % 64 == 0) vTaskDelay(1);
+  } else {
+    vTaskDelay(pdMS_TO_TICKS(FRAME_MS));
+  }
+  s_frame_start_us = esp_timer_get_time();
+}
+
+void clock_use_virtual(uint32_t start_ms)
+{
+  s_virtual_ms = start_ms;
+  s_virtual_clock = true;
+}
+
+const FrameCost& frame_cost() { return s_frame_cost; }
+void frame_cost_reset() { s_frame_cost = {}; }
+
+void set_touch_source(TouchSourceFn fn) { s_touch_source = fn; }
+
+void publish_aim(int game, int x, int y, int r)
+{
+  s_aim = { (int16_t)x, (int16_t)y, (int16_t)r, (int8_t)game, true };
+}
+
+void clear_aim(int game)
+{
+  s_aim.game = (int8_t)game;
+  s_aim.valid = false;
+}
+
+AimPoint current_aim() { return s_aim; }
+
+bool read_touch(LGFX& gfx, uint16_t &x, uint16_t &y)
+{
+  bool pressed;
+  int64_t acquired_us;
+  if (s_touch_source) {
+    pressed = s_touch_source(x, y);
+    acquired_us = esp_timer_get_time();
+  } else {
+#if TOUCH_DMA_DRIVER
+    pressed = touch_dma_read(x, y);
+    acquired_us = touch_dma_sample_us();
+#else
+    pressed = gfx.getTouch(&x, &y);
+    acquired_us = esp_timer_get_time();
+#endif
+    if (pressed) fix_touch_coords(x, y, gfx.width(), gfx.height());
+  }
+  s_latency.sample(pressed, acquired_us, esp_timer_get_time());
+  if (pressed && !s_was_pressed) stats_touch_event();
+  s_was_pressed = pressed;
+  return pressed;
+}
+
+bool read_gesture(LGFX& gfx, GestureEvent &ev)
+{
+  uint16_t x = 0, y = 0;
+  const bool pressed = read_touch(gfx, x, y);
+  const uint32_t now = game_millis();
+  if (s_trace_frames.load(std::memory_order_relaxed) > 0) {
+    s_trace_frames.fetch_sub(1, std::memory_order_relaxed);
+    DlogRecord r = {};
+    r.args[0] = (int32_t)now;
+    r.args[1] = pressed;
+    r.args[2] = pressed ? (int32_t)(x | (uint32_t)y << 16) : 0;
+    s_trace_ring.push(r);
+  }
+  return s_gestures.feed(now, pressed, x, y, ev);
+}
+
+void gesture_reset() { s_gestures = GestureRecognizer(s_gestures.config()); }
+
+void touch_trace(int frames) { s_trace_frames.store(frames, std::memory_order_relaxed); }
+
+int touch_trace_drain(void (*out)(const char *line, void *ctx), void *ctx)
+{
+  char line[48];
+  int n = 0;
+  DlogRecord r;
+  while (s_trace_ring.pop(r)) {
+    const uint32_t xy = (uint32_t)r.args[2];
+    snprintf(line, sizeof(line), "%u %d %u %u", (unsigned)r.args[0], (int)r.args[1], (unsigned)(xy & 0xFFFF),
+             (unsigned)(xy >> 16));
+    out(line, ctx);
+    ++n;
+  }
+  // A comment line, which gesture_check skips like any other non-sample
+  const uint32_t drops = s_trace_ring.dropped();
+  if (drops != s_trace_reported_drops) {
+    snprintf(line, sizeof(line), "# %u trace samples dropped", (unsigned)(drops - s_trace_reported_drops));
+    out(line, ctx);
+    s_trace_reported_drops = drops;
+  }
+  return n;
+}
+
+void latency_mark(LatStage stage, int game)
+{
+  s_latency.mark(stage, esp_timer_get_time(), game);
+}
+
+// Takes the render task's window at its next frame, like tap_stats_copy
+static bool latency_take()
+{
+  s_lat_taken.store(false, std::memory_order_relaxed);
+  s_lat_take_req.store(true, std::memory_order_release);
+  for (int i = 0; i < 100; ++i) {
+    if (s_lat_taken.load(std::memory_order_acquire)) return true;
+    vTaskDelay(pdMS_TO_TICKS(10));
+  }
+  if (s_lat_take_req.exchange(false, std::memory_order_acquire)) return false;
+  while (!s_lat_taken.load(std::memory_order_acquire)) vTaskDelay(1);
+  return true;
+}
+
+static void latency_log()
+{
+  if (!latency_take()) { ESP_LOGW(TAG_LAT, "no frame ran, window not taken"); return; }
+  char line[160];
+  for (int g = 0; g < LAT_GAMES; ++g) {
+    if (!s_lat_window.hist(g, LAT_SEGMENTS - 1).n) continue;
+    s_lat_window.format(g, line, sizeof(line));
+    ESP_LOGI(TAG_LAT, "%s", line);
+  }
+  if (s_lat_window.dropped()) ESP_LOGI(TAG_LAT, "%u touches never hit-tested", (unsigned)s_lat_window.dropped());
+}
+
+void reports_request() { s_report_req.store(true, std::memory_order_relaxed); }
+
+void reports_service()
+{
+  if (!s_report_req.exchange(false, std::memory_order_relaxed)) return;
+  mem_report_log();
+  latency_log();
+}
+
+void tap_stats_screen(int w, int h) { s_taps.set_screen(w, h); }
+
+void tap_record(int game, int x, int y, TapOutcome outcome)
+{
+  const bool target = s_aim.valid && s_aim.game == game;
+  s_taps.record(game, x, y, outcome, target, s_aim.x, s_aim.y);
+}
+
+bool tap_stats_copy(TapStats &dst, bool reset)
+{
+  s_tap_copied.store(false, std::memory_order_relaxed);
+  s_tap_reset_req.store(reset, std::memory_order_relaxed);
+  s_tap_copy_req.store(&dst, std::memory_order_release);
+  for (int i = 0; i < 100; ++i) {
+    if (s_tap_copied.load(std::memory_order_acquire)) return true;
+    vTaskDelay(pdMS_TO_TICKS(10));
+  }
+  // Withdraw the request unless the render task already took it
+  if (s_tap_copy_req.exchange(nullptr, std::memory_order_acquire)) return false;
+  while (!s_tap_copied.load(std::memory_order_acquire)) vTaskDelay(1);
+  return true;
+}
+
+EffectLimits effect_limits()
+{
+  return { s_lim_burst.load(std::memory_order_relaxed), s_lim_parts.load(std::memory_order_relaxed),
+           s_lim_ripples.load(std::memory_order_relaxed) };
+}
+
+void set_effect_limits(const EffectLimits &lim)
+{
+  s_lim_burst.store(std::max(0, std::min(lim.burst, MAX_PARTICLES)), std::memory_order_relaxed);
+  s_lim_parts.store(std::max(0, std::min(lim.particles, MAX_PARTICLES)), std::memory_order_relaxed);
+  s_lim_ripples.store(std::max(0, std::min(lim.ripples, MAX_RIPPLES)), std::memory_order_relaxed);
+}
+
+int  quality_tier() { return s_quality_tier.load(std::memory_order_relaxed); }
+bool quality_pinned() { return s_quality_pinned.load(std::memory_order_relaxed); }
+void quality_pin(int tier) { s_quality_pin_req.store(tier < 0 ? -1 : tier, std::memory_order_relaxed); }
+
+bool gesture_input(void *gfx, GestureEvent &ev) { return read_gesture(*static_cast<LGFX *>(gfx), ev); }
+
+void run_frame(GameScheduler& sched, Scene& scene)
 {
-  for (int i = 0; i < MAX_RIPPLES; ++i) if (!ripples[i].active)
+  sched.frame();
+  scene.flush();
+  frame_delay();
+  const int req = take_game_request();
+  if (req >= 0 && !sched.switch_to(0, req)) ESP_LOGW(TAG_GAME, "game %d is already on screen", req + 1);
+}
+
+void request_game(int game) { s_game_req.store(game, std::memory_order_relaxed); }
+int  take_game_request() { return s_game_req.exchange(-1, std::memory_order_relaxed); }
+
+Effects borrow_effects()
+{
+  Arena &arena = effect_arena();
+  size_t np = 0, nr = 0;
+  Effects fx;
+  fx.parts   = arena.alloc_array<Particle>(MAX_PARTICLES, 1, np);
+  fx.ripples = arena.alloc_array<Ripple>(MAX_RIPPLES, 1, nr);
+  fx.max_parts = (int)np;
+  fx.max_ripples = (int)nr;
+  return fx;
+}
+
+void clear_effects(Effects& fx)
+{
+  for (int i = 0; i < fx.max_parts; ++i) fx.parts[i].active = false;
+  for (int i = 0; i < fx.max_ripples; ++i) fx.ripples[i].active = false;
+}
+
+void spawn_ripple(SceneView& scene, Effects& fx, int sw, int sh, int x, int y, uint16_t color)
+{
+  Ripple *ripples = fx.ripples;
+  const int cap = std::min(fx.max_ripples, effect_limits().ripples);
+  for (int i = 0; i < cap; ++i) if (!ripples[i].active)
   {
     ripples[i].x = x; ripples[i].y = y;
-    ripples[i].radius = 2; ripples[i].prev_rad = 0;
+    ripples[i].radius = 2;
     int maxr = std::min(std::min(x, sw - x), std::min(y, sh - y));
     ripples[i].max_rad = std::max(12, std::min(maxr, 48));
-    ripples[i].color = color; ripples[i].active = true;
+    ripples[i].color = color;
+    ripples[i].node = scene.add_ring(LAYER_EFFECTS, x, y, ripples[i].radius, s_quality.params().ring_thickness, color);
+    ripples[i].active = ripples[i].node >= 0;
     break;
   }
 }
 
-void spawn_particles(Particle parts[], int cx, int cy, uint16_t base_col)
+EmitParams particle_params(int cx, int cy, uint16_t base_col)
 {
-  int spawned = 0;
-  for (int i = 0; i < MAX_PARTICLES && spawned < 24; ++i) if (!parts[i].active)
-  {
-    int vx = irand(-3, 3), vy = irand(-3, 3);
-    if (vx == 0 && vy == 0) vx = 1;
-    parts[i].x = parts[i].px = cx;
-    parts[i].y = parts[i].py = cy;
-    parts[i].vx = vx; parts[i].vy = vy;
-    parts[i].r  = parts[i].pr = irand(2, 4);
-    parts[i].life = irand(14, 22);
-    // slight color variation
-    uint8_t r = (base_col >> 11) & 0x1F;
-    uint8_t g = (base_col >> 5)  & 0x3F;
-    uint8_t b =  base_col        & 0x1F;
-    int dr = irand(-3, 3), dg = irand(-6, 6), db = irand(-3, 3);
-    r = (uint8_t)std::max(0, std::min(31, (int)r + dr));
-    g = (uint8_t)std::max(0, std::min(63, (int)g + dg));
-    b = (uint8_t)std::max(0, std::min(31, (int)b + db));
-    parts[i].color = (r << 11) | (g << 5) | b;
-    parts[i].active = true; ++spawned;
+  const QualityTier &q = s_quality.params();
+  EmitParams e;
+  e.cx = cx; e.cy = cy;
+  e.color = base_col;
+  e.burst = std::min<int>(q.burst, effect_limits().burst);
+  e.life_min = q.life_min; e.life_max = q.life_max;
+  return e;
+}
+
+int  particle_cap(const Effects& fx) { return std::min(fx.max_parts, effect_limits().particles); }
+void count_live_particles(int n) { s_live_parts += n; }
+
+void step_ripples(SceneView& scene, Effects& fx)
+{
+  for (int i = 0; i < fx.max_ripples; ++i) if (fx.ripples[i].active) {
+    Ripple &rp = fx.ripples[i];
+    rp.radius += 2;
+    if (rp.radius >= rp.max_rad) { scene.remove(rp.node); rp.active = false; continue; }
+    ++s_live_ripples;
+    scene.set_radius(rp.node, rp.radius);
+    scene.set_alpha(rp.node, (uint8_t)((rp.max_rad - rp.radius) * 255 / rp.max_rad));
   }
 }
 
-void draw_title(LGFX& gfx, const char* title, int sw)
+int add_title(SceneView& scene, const char* title, int sw, int size)
 {
-  gfx.setTextColor(TFT_WHITE, TFT_BLACK);
-  gfx.fillRect(0, 0, sw, 18, TFT_BLACK);
-  gfx.setFont(&fonts::Font0);
-  gfx.setTextSize(2);
-  gfx.setCursor(4, 2);
-  gfx.print(title);
+  scene.add_rect(LAYER_HUD, 0, 0, sw, HUD_H, TFT_BLACK);
+  return scene.add_text(LAYER_HUD, 4, 2, size, TFT_WHITE, title);
 }
 
 #if ENABLE_GAME_SWITCH
@@ -80,31 +404,32 @@ static constexpr int BTN_H = 16;
 static constexpr int BTN_W = 50;
 static constexpr int BTN_PAD = 2; // right/top padding
 
-void draw_switch_button(LGFX &gfx, int sw, const char *label)
+void add_switch_button(SceneView &scene, int sw, const char *label)
 {
   int x = sw - BTN_W - BTN_PAD;
-  int y = (18 - BTN_H) / 2;
+  int y = (HUD_H - BTN_H) / 2;
   if (y < 0)
     y = 0;
-  gfx.fillRoundRect(x, y, BTN_W, BTN_H, 3, TFT_DARKGREY);
-  gfx.drawRoundRect(x, y, BTN_W, BTN_H, 3, TFT_WHITE);
-  gfx.setTextColor(TFT_WHITE, TFT_DARKGREY);
-  gfx.setFont(&fonts::Font0);
-  gfx.setTextSize(1);
-  int tw = gfx.textWidth(label);
+  scene.add_panel(LAYER_HUD, x, y, BTN_W, BTN_H, 3, TFT_DARKGREY, TFT_WHITE);
+  int tw = (int)strlen(label) * 6;   // Font0, size 1
   int tx = x + (BTN_W - tw) / 2;
   int ty = y + 3;
-  gfx.setCursor(tx, ty);
-  gfx.print(label);
+  scene.add_text(LAYER_HUD, tx, ty, 1, TFT_WHITE, label);
 }
 
 bool is_in_switch_button(int sw, uint16_t x, uint16_t y)
 {
   int bx = sw - BTN_W - BTN_PAD;
-  int by = (18 - BTN_H) / 2;
+  int by = (HUD_H - BTN_H) / 2;
   if (by < 0)
     by = 0;
-  return (y < 18) && (x >= bx) && (x < bx + BTN_W) && (y >= by) && (y < by + BTN_H);
+  return (y < HUD_H) && (x >= bx) && (x < bx + BTN_W) && (y >= by) && (y < by + BTN_H);
+}
+
+void switch_button_center(int sw, uint16_t &x, uint16_t &y)
+{
+  x = (uint16_t)(sw - BTN_PAD - BTN_W / 2);
+  y = (uint16_t)(HUD_H / 2);
 }
 #endif
 
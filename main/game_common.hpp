@@ -6,51 +6,211 @@
 #endif
 
 #include "lgfx_setup.hpp"
+#include "scene.hpp"
+#include "autoplay_bot.hpp"
+#include "latency.hpp"
+#include "tap_stats.hpp"
+#include "emitter.hpp"
+#include "quality.hpp"
+#include "gesture.hpp"
+#include "game_sched.hpp"
 #include <cstdint>
 
 // ---- Build-time toggles ----
 #ifndef ENABLE_GAME_SWITCH
 #define ENABLE_GAME_SWITCH 0
 #endif
+#ifndef AUTOPLAY_BOT
+#define AUTOPLAY_BOT 0   // 1: a synthetic player drives the games on a virtual clock
+#endif
+#ifndef SPLIT_SCREEN
+#define SPLIT_SCREEN 0   // 1: two games at once, stacked in the two halves of the panel
+#endif
+#ifndef QUALITY_BUDGET_US
+#define QUALITY_BUDGET_US 8000   // frame work the effect governor stays under; ~40 fps with the 16 ms delay
+#endif
 
 // ---- Random helpers ----
 uint32_t urand();
 int      irand(int min_v, int max_v);
+// Non-zero: urand becomes a reproducible xorshift sequence from `seed`
+// (golden-frame runs); 0 returns to the hardware RNG
+void     rand_seed(uint32_t seed);
+
+// ---- Clock ----
+// Games read time and pace frames only through these, so soak runs can
+// swap in a virtual clock that advances one frame per loop iteration.
+constexpr uint32_t FRAME_MS = 16;
+
+struct FrameCost {
+  uint32_t last_us, max_us;
+  uint64_t sum_us;
+  uint32_t count;
+};
+
+uint32_t game_millis();
+void     frame_delay();
+void     clock_use_virtual(uint32_t start_ms);
+const FrameCost& frame_cost();   // work time per frame, excluding the delay
+void     frame_cost_reset();
 
 // ---- Touch helpers ----
 void fix_touch_coords(uint16_t &x, uint16_t &y, int screen_width, int screen_height);
+// Current touch in screen coordinates (already passed through fix_touch_coords)
+bool read_touch(LGFX& gfx, uint16_t &x, uint16_t &y);
 
-// ---- Effects ----
-struct Particle {
-  int x, y;
-  int px, py;
-  int vx, vy;
-  int r, pr;
-  int life;
-  uint16_t color;
-  bool active;
-};
+// Replaces the touch panel as input (nullptr restores the hardware)
+using TouchSourceFn = bool (*)(uint16_t &x, uint16_t &y);
+void set_touch_source(TouchSourceFn fn);
+
+// ---- Gestures ----
+// read_touch through one shared recognizer, at most one event per frame.
+// Games hit-test on GESTURE_DOWN; the recognizer outlives a game switch so
+// a finger still on the switch button is no fresh press in the next game.
+bool read_gesture(LGFX& gfx, GestureEvent &ev);
+void gesture_reset();   // drop any contact in progress (scripted runs)
+// Queues the next `frames` raw samples for touch_trace_drain, which hands
+// them out as "t_ms pressed x y" lines (no newline), the trace format
+// tools/gesture_check replays. The render task only pushes into a ring;
+// the console task formats and prints. Returns the samples drained.
+void touch_trace(int frames);
+int  touch_trace_drain(void (*out)(const char *line, void *ctx), void *ctx);
+
+// Games publish what a player should hit this frame
+void     publish_aim(int game, int x, int y, int r);
+void     clear_aim(int game);
+AimPoint current_aim();
+
+// ---- Latency ----
+// read_touch stamps acquisition and frame_delay stamps the finished flush;
+// games mark LAT_HIT after hit-testing a touch and LAT_STATE once they
+// have reacted to it
+void latency_mark(LatStage stage, int game = -1);
+
+// ---- Reports ----
+// reports_request only raises a flag, so the render task can ask for the
+// memory report and the per-game latency percentiles (which start a new
+// window) without touching the UART; a low-priority task prints them from
+// reports_service, which waits up to a second for the render task to hand
+// its latency window over. Never call reports_service from the render task.
+void reports_request();
+void reports_service();
+
+// ---- Tap analytics ----
+// Games record each contact they hit-test, in screen coordinates; the
+// target is the game's published aim, if any
+void tap_stats_screen(int w, int h);
+void tap_record(int game, int x, int y, TapOutcome outcome);
+// Copies the render task's counters into `dst` at its next frame (and
+// clears them if asked). Blocks the calling task for up to a second; false
+// when no frame ran meanwhile. Never call it from the render task.
+bool tap_stats_copy(TapStats &dst, bool reset);
 
+// ---- Effects ----
+// Each live effect owns one scene node on LAYER_EFFECTS. Particles are
+// Particle (emitter.hpp), moved by the game's Emitter.
 struct Ripple {
   int x, y;
   int radius;
-  int prev_rad;
   int max_rad;
   uint16_t color;
   bool active;
+  int node;
 };
 
 constexpr int MAX_PARTICLES = 48;
 constexpr int MAX_RIPPLES   = 6;
 
-void spawn_particles(Particle parts[], int cx, int cy, uint16_t base_col);
-void spawn_ripple(Ripple ripples[], int sw, int sh, int x, int y, uint16_t color);
+// Effect pools for one game slot, borrowed from effect_arena()
+struct Effects {
+  Particle *parts;
+  int       max_parts;
+  Ripple   *ripples;
+  int       max_ripples;
+};
+
+// May hand out fewer slots (or none) when the arena is short; effects
+// then just spawn less. A slot keeps its pools from game to game.
+Effects borrow_effects();
+// Forget every live effect; games call it after resetting their view,
+// which already dropped the nodes
+void clear_effects(Effects& fx);
+
+// The plain spark: square scatter of up to 3 px per frame, fading out
+using SparkEmitter = Emitter<Scatter<3>, FadeAlpha>;
+
+// Emitter sink over a scene view
+struct SceneSink {
+  SceneView &scene;
+  int  add(int x, int y, int r, uint16_t c) { return scene.add_circle(LAYER_EFFECTS, x, y, r, c); }
+  void remove(int node) { scene.remove(node); }
+  void move(int node, int x, int y) { scene.move(node, x, y); }
+  void alpha(int node, uint8_t a) { scene.set_alpha(node, a); }
+  void color(int node, uint16_t c) { scene.set_colors(node, c, c); }
+};
+
+// Burst size and lifetimes from the quality tier and effect limits
+EmitParams particle_params(int cx, int cy, uint16_t base_col);
+int  particle_cap(const Effects& fx);
+void count_live_particles(int n);   // for the stats console
+
+// A game uses one emitter type for all its particles, in both calls
+template <typename E = SparkEmitter>
+void spawn_particles(SceneView& scene, Effects& fx, int cx, int cy, uint16_t base_col)
+{
+  SceneSink sink{scene};
+  E::spawn(sink, fx.parts, particle_cap(fx), particle_params(cx, cy, base_col), irand);
+}
+
+void spawn_ripple(SceneView& scene, Effects& fx, int sw, int sh, int x, int y, uint16_t color);
+
+// Advance one frame; expired effects release their nodes
+template <typename E = SparkEmitter>
+void step_particles(SceneView& scene, Effects& fx)
+{
+  SceneSink sink{scene};
+  count_live_particles(E::step(sink, fx.parts, fx.max_parts));
+}
+void step_ripples(SceneView& scene, Effects& fx);
+
+// ---- Runtime control ----
+// Adjustable from any task (stats console); clamped to the pools above
+struct EffectLimits {
+  int burst;       // cap on particles per spawn_particles call; the quality tier picks below it
+  int particles;   // live particles
+  int ripples;     // live ripples
+};
+EffectLimits effect_limits();
+void set_effect_limits(const EffectLimits &lim);
+
+// Effect quality tier chosen by the governor in frame_delay
+int  quality_tier();
+bool quality_pinned();
+// Fix the tier from any task (-1: automatic); applied at the next frame
+void quality_pin(int tier);
+
+// Ask for `game` in the first slot from any task (console "game")
+void request_game(int game);
+int  take_game_request();    // the requested GameId, or -1
+
+// ---- Game loop ----
+// GameInputFn over read_gesture; ctx is the LGFX
+bool gesture_input(void *gfx, GestureEvent &ev);
+// One frame: every game in `sched` steps, the scene flushes, frame_delay
+// paces, then a pending game request switches the first slot
+void run_frame(GameScheduler& sched, Scene& scene);
 
 // ---- UI Helpers ----
-void draw_title(LGFX& gfx, const char* title, int sw);
+constexpr int HUD_H = 18;
+
+// Title bar on LAYER_HUD; returns the text node for later set_text calls.
+// Font0 is 6 px wide per size step: at size 2 only 21 characters end
+// before the switch button, so HUDs with two counters use size 1.
+int add_title(SceneView& scene, const char* title, int sw, int size = 2);
 
 #if ENABLE_GAME_SWITCH
 // Switch button helpers (top-right within title bar height ~18px)
-void draw_switch_button(LGFX& gfx, int sw, const char* label = "SW");
+void add_switch_button(SceneView& scene, int sw, const char* label = "SW");
 bool is_in_switch_button(int sw, uint16_t x, uint16_t y);
+void switch_button_center(int sw, uint16_t &x, uint16_t &y);
 #endif
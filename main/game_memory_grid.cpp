@@ -1,221 +1,253 @@
-extern "C" {
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
-#include "esp_log.h"
-}
-
 #include "game_common.hpp"
+#include "games.hpp"
+#include "score_store.hpp"
+#include "dlog.hpp"
+#include "boot.hpp"
 #include <algorithm>
+#include <new>
 
-static const char *TAG_GAME3 = "GAME3";
+namespace {
 
-void game_memory_grid(LGFX &gfx)
+class MemoryGrid : public GameTask
 {
-  const int sw = gfx.width();
-  const int sh = gfx.height();
-
-  gfx.fillScreen(TFT_BLACK);
-
-  int score = 0;
-  int miss = 0;
+public:
+  void     begin(GameView &v) override;
+  GameStep step(GameView &v) override;
+  void     end(GameView &v) override;
 
+private:
   static constexpr int COLS = 3;
   static constexpr int ROWS = 3;
   static constexpr int TOTAL = COLS * ROWS;
+  static constexpr int GRID_TOP = 24;
+  static constexpr int GRID_LEFT = 12;
+
+  void save_state();
+  void update_hud();
+  void cell_bounds(int idx, int &x, int &y, int &w, int &h) const;
+  void draw_idle_cell(int idx) { scene_.set_colors(cells_[idx], idle_fill_, TFT_DARKGREY); }
+  void draw_active_cell(int idx) { scene_.set_colors(cells_[idx], active_fill_, TFT_WHITE); }
+  int  touch_to_index(int tx, int ty) const;
+  void flash_cell(int idx, bool good, uint32_t now);
+  void spawn_target(uint32_t now);
+
+  SceneView scene_;
+  int       sw_ = 0, sh_ = 0;
+  int       score_ = 0;
+  int       miss_ = 0;
+  int       grid_width_ = 0, grid_height_ = 0;
+  int       cell_w_ = 0, cell_h_ = 0;
+  uint16_t  idle_fill_ = 0, active_fill_ = 0, bad_fill_ = 0;
+
+  int       active_idx_ = -1;
+  uint32_t  appear_ms_ = 0;
+  uint32_t  ttl_ms_ = 1500;
+  uint32_t  next_spawn_ms_ = 0;
+
+  int       feedback_idx_ = -1;
+  uint32_t  feedback_until_ = 0;
+
+  int       hud_text_ = -1, warn_ = -1;
+  int16_t   cells_[TOTAL] = {};
+};
+
+void MemoryGrid::save_state()
+{
+  GameSnapshot s = snapshot_make(GAME_MEMORY_GRID);
+  s.grid = { (int16_t)score_, (int16_t)miss_, (uint16_t)ttl_ms_ };
+  resume_save(s);
+}
+
+void MemoryGrid::update_hud()
+{
+  scene_.set_text(hud_text_, "Game 3  Score:%d  Miss:%d", score_, miss_);
+  scene_.set_visible(warn_, miss_ >= 8);
+  save_state();
+}
+
+void MemoryGrid::cell_bounds(int idx, int &x, int &y, int &w, int &h) const
+{
+  int row = idx / COLS;
+  int col = idx % COLS;
+  x = GRID_LEFT + col * cell_w_;
+  y = GRID_TOP + row * cell_h_;
+  int remaining_w = grid_width_ - col * cell_w_;
+  int remaining_h = grid_height_ - row * cell_h_;
+  w = (col == COLS - 1) ? remaining_w : cell_w_;
+  h = (row == ROWS - 1) ? remaining_h : cell_h_;
+}
+
+int MemoryGrid::touch_to_index(int tx, int ty) const
+{
+  if (tx < GRID_LEFT || ty < GRID_TOP)
+    return -1;
+  if (tx >= GRID_LEFT + grid_width_ || ty >= GRID_TOP + grid_height_)
+    return -1;
+  int rel_x = tx - GRID_LEFT;
+  int rel_y = ty - GRID_TOP;
+  int col = std::min(COLS - 1, rel_x / std::max(1, cell_w_));
+  int row = std::min(ROWS - 1, rel_y / std::max(1, cell_h_));
+  return row * COLS + col;
+}
+
+void MemoryGrid::flash_cell(int idx, bool good, uint32_t now)
+{
+  if (idx < 0)
+    return;
+  if (good)
+    scene_.set_colors(cells_[idx], TFT_GREEN, TFT_WHITE);
+  else
+    scene_.set_colors(cells_[idx], bad_fill_, TFT_RED);
+  feedback_idx_ = idx;
+  feedback_until_ = now + 220;
+}
+
+void MemoryGrid::spawn_target(uint32_t now)
+{
+  int next = irand(0, TOTAL - 1);
+  if (next == active_idx_)
+    next = (next + 1) % TOTAL;
+  if (active_idx_ >= 0)
+    draw_idle_cell(active_idx_);
+  active_idx_ = next;
+  appear_ms_ = now;
+  draw_active_cell(active_idx_);
+}
 
-  const int grid_top = 24;
-  const int grid_left = 12;
-  const int grid_width = sw - grid_left * 2;
-  const int grid_height = sh - grid_top - 12;
-  const int cell_w = grid_width / COLS;
-  const int cell_h = grid_height / ROWS;
-
-  const uint16_t idle_fill = gfx.color888(45, 45, 45);
-  const uint16_t active_fill = gfx.color888(80, 170, 255);
-
-  int active_idx = -1;
-  uint32_t appear_ms = 0;
-  uint32_t ttl_ms = 1500;
-  uint32_t next_spawn_ms = 0;
-
-  int feedback_idx = -1;
-  uint32_t feedback_until = 0;
-
-  auto draw_hud = [&]() {
-    gfx.setTextColor(TFT_WHITE, TFT_BLACK);
-    gfx.fillRect(0, 0, sw, 18, TFT_BLACK);
-    gfx.setCursor(4, 2);
-    gfx.printf("Game 3  Score:%d  Miss:%d", score, miss);
+void MemoryGrid::begin(GameView &v)
+{
+  scene_ = SceneView(*v.scene, v.view);
+  sw_ = v.w;
+  sh_ = v.h;
+  grid_width_ = sw_ - GRID_LEFT * 2;
+  grid_height_ = sh_ - GRID_TOP - 12;
+  cell_w_ = grid_width_ / COLS;
+  cell_h_ = grid_height_ / ROWS;
+
+  idle_fill_ = scene_.gfx().color888(45, 45, 45);
+  active_fill_ = scene_.gfx().color888(80, 170, 255);
+  bad_fill_ = scene_.gfx().color888(200, 50, 50);
+
+  GameSnapshot snap;
+  if (resume_claim(GAME_MEMORY_GRID, snap))
+  {
+    score_ = snap.grid.score;
+    miss_ = snap.grid.miss;
+    ttl_ms_ = snap.grid.ttl_ms;
+  }
+  save_state();
+
+  score_store_begin_session(GAME_MEMORY_GRID, score_, miss_);
+  score_store_log_best(GAME_MEMORY_GRID);
+
+  scene_.reset(TFT_BLACK);
+  clear_effects(*v.fx);
+  hud_text_ = add_title(scene_, "Game 3  Score:0  Miss:0", sw_, 1);
 #if ENABLE_GAME_SWITCH
-    draw_switch_button(gfx, sw, "SWITCH");
+  add_switch_button(scene_, sw_, "SWITCH");
 #endif
-  };
-
-  auto cell_bounds = [&](int idx, int &x, int &y, int &w, int &h) {
-    int row = idx / COLS;
-    int col = idx % COLS;
-    x = grid_left + col * cell_w;
-    y = grid_top + row * cell_h;
-    int remaining_w = grid_width - col * cell_w;
-    int remaining_h = grid_height - row * cell_h;
-    w = (col == COLS - 1) ? remaining_w : cell_w;
-    h = (row == ROWS - 1) ? remaining_h : cell_h;
-  };
-
-  auto draw_idle_cell = [&](int idx) {
-    int x, y, w, h;
-    cell_bounds(idx, x, y, w, h);
-    gfx.fillRect(x, y, w, h, TFT_BLACK);
-    if (w > 4 && h > 4)
-    {
-      gfx.fillRoundRect(x + 2, y + 2, w - 4, h - 4, 4, idle_fill);
-      gfx.drawRoundRect(x + 1, y + 1, w - 2, h - 2, 4, TFT_DARKGREY);
-    }
-    else
-    {
-      gfx.fillRect(x, y, w, h, idle_fill);
-    }
-  };
+  warn_ = scene_.add_text(LAYER_HUD, 10, sh_ - 20, 2, TFT_YELLOW, "Miss >= 8");
+  scene_.set_visible(warn_, false);
+  update_hud();
 
-  auto draw_active_cell = [&](int idx, uint16_t fill) {
-    int x, y, w, h;
-    cell_bounds(idx, x, y, w, h);
-    gfx.fillRect(x, y, w, h, TFT_BLACK);
-    if (w > 6 && h > 6)
-    {
-      gfx.fillRoundRect(x + 2, y + 2, w - 4, h - 4, 4, fill);
-      gfx.drawRoundRect(x + 1, y + 1, w - 2, h - 2, 4, TFT_WHITE);
-    }
-    else
-    {
-      gfx.fillRect(x, y, w, h, fill);
-    }
-  };
-
-  auto touch_to_index = [&](uint16_t tx, uint16_t ty) -> int {
-    if (tx < grid_left || ty < grid_top)
-      return -1;
-    if (tx >= grid_left + grid_width || ty >= grid_top + grid_height)
-      return -1;
-    int rel_x = tx - grid_left;
-    int rel_y = ty - grid_top;
-    int col = std::min(COLS - 1, rel_x / std::max(1, cell_w));
-    int row = std::min(ROWS - 1, rel_y / std::max(1, cell_h));
-    return row * COLS + col;
-  };
-
-  auto flash_cell = [&](int idx, bool good, uint32_t now) {
-    if (idx < 0)
-      return;
-    uint16_t fill = good ? TFT_GREEN : gfx.color888(200, 50, 50);
-    uint16_t border = good ? TFT_WHITE : TFT_RED;
-    int x, y, w, h;
-    cell_bounds(idx, x, y, w, h);
-    gfx.fillRect(x, y, w, h, TFT_BLACK);
-    if (w > 6 && h > 6)
-    {
-      gfx.fillRoundRect(x + 2, y + 2, w - 4, h - 4, 4, fill);
-      gfx.drawRoundRect(x + 1, y + 1, w - 2, h - 2, 4, border);
-    }
-    else
-    {
-      gfx.fillRect(x, y, w, h, fill);
-    }
-    feedback_idx = idx;
-    feedback_until = now + 220;
-  };
-
-  auto spawn_target = [&](uint32_t now) {
-    int next = irand(0, TOTAL - 1);
-    if (next == active_idx)
-      next = (next + 1) % TOTAL;
-    if (active_idx >= 0)
-      draw_idle_cell(active_idx);
-    active_idx = next;
-    appear_ms = now;
-    draw_active_cell(active_idx, active_fill);
-  };
-
-  draw_hud();
   for (int i = 0; i < TOTAL; ++i)
-    draw_idle_cell(i);
-  next_spawn_ms = lgfx::v1::millis();
+  {
+    int x, y, w, h;
+    cell_bounds(i, x, y, w, h);
+    cells_[i] = (int16_t)scene_.add_panel(LAYER_PLAY, x + 1, y + 1, w - 2, h - 2, 4, idle_fill_, TFT_DARKGREY);
+  }
 
-  while (true)
+  next_spawn_ms_ = game_millis();
+}
+
+GameStep MemoryGrid::step(GameView &v)
+{
+  uint32_t now = game_millis();
+
+  if (feedback_idx_ >= 0 && (int32_t)(now - feedback_until_) >= 0)
   {
-    uint32_t now = lgfx::v1::millis();
+    if (active_idx_ >= 0 && feedback_idx_ == active_idx_)
+      draw_active_cell(active_idx_);
+    else
+      draw_idle_cell(feedback_idx_);
+    feedback_idx_ = -1;
+  }
 
-    if (feedback_idx >= 0 && (int32_t)(now - feedback_until) >= 0)
+  if (active_idx_ < 0)
+  {
+    if ((int32_t)(now - next_spawn_ms_) >= 0)
     {
-      if (active_idx >= 0 && feedback_idx == active_idx)
-        draw_active_cell(active_idx, active_fill);
-      else
-        draw_idle_cell(feedback_idx);
-      feedback_idx = -1;
+      spawn_target(now);
     }
+  }
+  else if ((int32_t)(now - appear_ms_) > (int32_t)ttl_ms_)
+  {
+    miss_++;
+    update_hud();
+    score_store_update(GAME_MEMORY_GRID, score_, miss_);
+    flash_cell(active_idx_, false, now);
+    dlog(DLOG_GAME3_MISS_TIMEOUT, active_idx_);
+    active_idx_ = -1;
+    next_spawn_ms_ = now + 350;
+  }
 
-    if (active_idx < 0)
-    {
-      if ((int32_t)(now - next_spawn_ms) >= 0)
-      {
-        spawn_target(now);
-      }
-    }
-    else if ((int32_t)(now - appear_ms) > (int32_t)ttl_ms)
+  if (active_idx_ >= 0)
+  {
+    int x, y, w, h;
+    cell_bounds(active_idx_, x, y, w, h);
+    publish_aim(GAME_MEMORY_GRID, v.x + x + w / 2, v.y + y + h / 2, std::min(w, h) / 2);
+  }
+  else
+  {
+    clear_aim(GAME_MEMORY_GRID);
+  }
+
+  // One answer per contact: holding a finger on a wrong cell is one miss
+  const GestureEvent *ev = v.input();
+  if (ev && ev->type == GESTURE_DOWN)
+  {
+    const int tx = ev->x, ty = ev->y;
+#if ENABLE_GAME_SWITCH
+    if (is_in_switch_button(sw_, tx, ty))
     {
-      miss++;
-      draw_hud();
-      flash_cell(active_idx, false, now);
-      ESP_LOGI(TAG_GAME3, "Miss (timeout)");
-      active_idx = -1;
-      next_spawn_ms = now + 350;
+      dlog(DLOG_GAME_SWITCH, GAME_MEMORY_GRID);
+      return GAME_SWITCH;
     }
-
-    uint16_t tx, ty;
-    if (gfx.getTouch(&tx, &ty))
+#endif
+    const int idx = touch_to_index(tx, ty);
+    tap_record(GAME_MEMORY_GRID, v.x + tx, v.y + ty, idx < 0 ? TAP_STRAY : idx == active_idx_ ? TAP_HIT : TAP_MISS);
+    if (idx >= 0)
     {
-      fix_touch_coords(tx, ty, sw, sh);
-#if ENABLE_GAME_SWITCH
-      if (is_in_switch_button(sw, tx, ty))
+      latency_mark(LAT_HIT, GAME_MEMORY_GRID);
+      if (idx == active_idx_)
       {
-        gfx.fillScreen(TFT_BLACK);
-        ESP_LOGI(TAG_GAME3, "Switch button");
-        return;
+        score_++;
+        if (ttl_ms_ > 650)
+          ttl_ms_ -= 20;
+        update_hud();
+        score_store_update(GAME_MEMORY_GRID, score_, miss_);
+        flash_cell(active_idx_, true, now);
+        active_idx_ = -1;
+        next_spawn_ms_ = now + 300;
       }
-#endif
-      if (ty >= grid_top)
+      else
       {
-        int idx = touch_to_index(tx, ty);
-        if (idx >= 0)
-        {
-          if (idx == active_idx)
-          {
-            score++;
-            draw_hud();
-            flash_cell(active_idx, true, now);
-            active_idx = -1;
-            next_spawn_ms = now + 300;
-            if (ttl_ms > 650)
-              ttl_ms -= 20;
-          }
-          else
-          {
-            miss++;
-            draw_hud();
-            flash_cell(idx, false, now);
-            ESP_LOGI(TAG_GAME3, "Miss (wrong cell)");
-          }
-        }
+        miss_++;
+        update_hud();
+        score_store_update(GAME_MEMORY_GRID, score_, miss_);
+        flash_cell(idx, false, now);
+        dlog(DLOG_GAME3_MISS_WRONG, idx, active_idx_);
       }
+      latency_mark(LAT_STATE);
     }
-
-    if (miss >= 8)
-    {
-      gfx.setTextColor(TFT_YELLOW, TFT_BLACK);
-      gfx.setCursor(10, sh - 20);
-      gfx.print("Miss >= 8");
-    }
-
-    vTaskDelay(pdMS_TO_TICKS(16));
   }
+  return GAME_CONTINUE;
 }
+
+void MemoryGrid::end(GameView &) { score_store_end_session(GAME_MEMORY_GRID); }
+
+static_assert(sizeof(MemoryGrid) <= GAME_STATE_BYTES, "MemoryGrid outgrew its scheduler slot");
+
+} // namespace
+
+GameTask *make_memory_grid(void *mem) { return new (mem) MemoryGrid(); }
@@ -0,0 +1,109 @@
+#include "game_sched.hpp"
+
+const GestureEvent *GameView::input() const { return sched->input(slot); }
+
+GameView game_view(Scene *scene, Effects *fx, int view, int x, int y, int w, int h)
+{
+  GameView v = {};
+  v.scene = scene;
+  v.fx = fx;
+  v.view = (uint8_t)view;
+  v.x = (int16_t)x; v.y = (int16_t)y; v.w = (int16_t)w; v.h = (int16_t)h;
+  v.slot = -1;
+  return v;
+}
+
+GameScheduler::GameScheduler(const GameFactory *games, int game_count, GameInputFn input, void *input_ctx)
+  : games_(games), game_count_(game_count), input_(input), input_ctx_(input_ctx)
+{
+  for (Slot &s : slots_) s.game = -1;
+}
+
+void GameScheduler::start(int slot, int game, const GameView &view)
+{
+  if (slot < 0 || slot >= SCHED_SLOTS || game < 0 || game >= game_count_) return;
+  stop(slot);
+  Slot &s = slots_[slot];
+  s.view = view;
+  s.view.sched = this;
+  s.view.slot = (int8_t)slot;
+  s.game = (int8_t)game;
+  s.task = games_[game](s.mem);
+  s.task->begin(s.view);
+}
+
+void GameScheduler::stop(int slot)
+{
+  Slot &s = slots_[slot];
+  if (!s.task) return;
+  s.task->end(s.view);
+  s.task->~GameTask();
+  s.task = nullptr;
+  s.game = -1;
+  // The rest of a touch that went down in the old game is not the new one's
+  if (owner_ == slot) owner_ = -1;
+}
+
+bool GameScheduler::switch_to(int slot, int game)
+{
+  if (slot < 0 || slot >= SCHED_SLOTS || game < 0 || game >= game_count_) return false;
+  for (int i = 0; i < SCHED_SLOTS; ++i)
+    if (i != slot && slots_[i].game == game) return false;
+  const int from = slots_[slot].game;
+  const GameView view = slots_[slot].view;
+  stop(slot);
+  if (on_switch_) on_switch_(slot, from, game);
+  start(slot, game, view);
+  return true;
+}
+
+int GameScheduler::next_game(int slot) const
+{
+  int g = slots_[slot].game;
+  for (int tries = 0; tries < game_count_; ++tries) {
+    g = (g + 1) % game_count_;
+    bool taken = false;
+    for (int i = 0; i < SCHED_SLOTS; ++i) taken |= i != slot && slots_[i].game == g;
+    if (!taken) return g;
+  }
+  return slots_[slot].game;
+}
+
+int GameScheduler::slot_at(int x, int y) const
+{
+  for (int i = 0; i < SCHED_SLOTS; ++i) {
+    const Slot &s = slots_[i];
+    if (s.task && x >= s.view.x && x < s.view.x + s.view.w && y >= s.view.y && y < s.view.y + s.view.h) return i;
+  }
+  return -1;
+}
+
+void GameScheduler::poll()
+{
+  polled_ = true;
+  target_ = -1;
+  if (!input_(input_ctx_, ev_)) return;
+  // A contact belongs to the area it went down in, even when it drags out
+  if (ev_.type == GESTURE_DOWN) owner_ = (int8_t)slot_at(ev_.x, ev_.y);
+  target_ = owner_;
+  if (ev_.type >= GESTURE_TAP) owner_ = -1;
+  if (target_ < 0) return;
+  ev_.x -= slots_[target_].view.x;
+  ev_.y -= slots_[target_].view.y;
+}
+
+const GestureEvent *GameScheduler::input(int slot)
+{
+  if (!polled_) poll();
+  return target_ == slot ? &ev_ : nullptr;
+}
+
+void GameScheduler::frame()
+{
+  polled_ = false;
+  for (int i = 0; i < SCHED_SLOTS; ++i) {
+    Slot &s = slots_[i];
+    if (s.task && s.task->step(s.view) == GAME_SWITCH) switch_to(i, next_game(i));
+  }
+  if (!polled_) poll();
+}
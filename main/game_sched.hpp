@@ -0,0 +1,98 @@
+// Cooperative scheduler for games written as resumable state machines
+// (no ESP-IDF deps). A game object holds what used to live on its loop's
+// stack; step() runs one frame and returns, so several games share the
+// render task, each in its own screen area, without a task or stack of
+// their own. Slots hold the game object in place: switching games never
+// allocates.
+#pragma once
+
+#include "gesture.hpp"
+#include <cstddef>
+#include <cstdint>
+
+class Scene;
+struct Effects;
+class GameScheduler;
+
+constexpr int    SCHED_SLOTS = 2;
+constexpr size_t GAME_STATE_BYTES = 192;   // every game static_asserts it fits
+
+// Where a game runs. Games work in local coordinates, 0..w-1 by 0..h-1.
+struct GameView {
+  Scene         *scene;
+  Effects       *fx;          // the slot's effect pools, kept across game switches
+  uint8_t        view;        // scene view holding the game's nodes
+  int16_t        x, y, w, h;  // screen area
+  GameScheduler *sched;       // set by the scheduler
+  int8_t         slot;
+
+  // This frame's touch event for this game in local coordinates, or
+  // nullptr. The first call in a frame reads the panel, so games call it
+  // where they hit-test.
+  const GestureEvent *input() const;
+};
+
+GameView game_view(Scene *scene, Effects *fx, int view, int x, int y, int w, int h);
+
+enum GameStep : uint8_t {
+  GAME_CONTINUE = 0,
+  GAME_SWITCH,          // the player asked for the next game
+};
+
+class GameTask {
+public:
+  virtual ~GameTask() = default;
+  virtual void     begin(GameView &v) = 0;   // claim resume state, build the scene
+  virtual GameStep step(GameView &v) = 0;    // one frame
+  virtual void     end(GameView &v) = 0;     // close the score session
+};
+
+// Constructs a game in `mem` (GAME_STATE_BYTES, max-aligned)
+using GameFactory = GameTask *(*)(void *mem);
+// One touch sample turned into at most one event, screen coordinates
+using GameInputFn = bool (*)(void *ctx, GestureEvent &ev);
+// After `slot` changed game, before the new one begins (-1: none)
+using GameSwitchFn = void (*)(int slot, int from, int to);
+
+class GameScheduler {
+public:
+  GameScheduler(const GameFactory *games, int game_count, GameInputFn input, void *input_ctx);
+
+  void on_switch(GameSwitchFn fn) { on_switch_ = fn; }
+
+  // Runs `game` in `slot` over the view's area, ending whatever ran there
+  void start(int slot, int game, const GameView &view);
+  void stop(int slot);
+  // Replaces the game in `slot`; false when another slot is running `game`
+  bool switch_to(int slot, int game);
+
+  // One frame of every running game, in slot order. Exactly one touch
+  // sample is read whether or not any game asks for it.
+  void frame();
+
+  int game(int slot) const { return slots_[slot].game; }
+  const GestureEvent *input(int slot);
+
+private:
+  struct Slot {
+    alignas(std::max_align_t) uint8_t mem[GAME_STATE_BYTES];
+    GameTask *task;
+    GameView  view;
+    int8_t    game;
+  };
+
+  void poll();
+  int  slot_at(int x, int y) const;
+  int  next_game(int slot) const;
+
+  Slot              slots_[SCHED_SLOTS] = {};
+  const GameFactory *games_;
+  int               game_count_;
+  GameInputFn       input_;
+  void             *input_ctx_;
+  GameSwitchFn      on_switch_ = nullptr;
+  GestureEvent      ev_ = {};      // this frame's event, local to its slot
+  bool              polled_ = false;
+  int8_t            target_ = -1;  // slot this frame's event goes to
+  int8_t            owner_ = -1;   // slot the current contact went down in
+};
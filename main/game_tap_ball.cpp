@@ -1,133 +1,161 @@
-extern "C" {
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
-#include "esp_log.h"
-}
-
 #include "game_common.hpp"
+#include "games.hpp"
+#include "score_store.hpp"
+#include "dlog.hpp"
+#include "boot.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+// A hit pops a ring of sparks that slow down and whiten as they fade
+using HitSparks = Emitter<RadialBurst<48>, Drag<232>, ColorFade<TFT_WHITE>, FadeAlpha>;
 
-static const char* TAG_GAME1 = "GAME1";
+class TapBall : public GameTask {
+public:
+  void     begin(GameView &v) override;
+  GameStep step(GameView &v) override;
+  void     end(GameView &v) override;
 
-void game_tap_ball(LGFX& gfx)
+private:
+  void save_state();
+  void respawn_ball();
+
+  SceneView scene_;
+  int       sw_ = 0, sh_ = 0;
+  int       score_ = 0;
+  int       radius_ = 22;
+  int       cx_ = 0, cy_ = 0, vx_ = 0, vy_ = 0;
+  uint32_t  last_spawn_ms_ = 0;
+  uint32_t  last_touch_ms_ = 0;
+  uint16_t  ball_color_ = 0;
+  int       hud_text_ = -1, ball_ = -1;
+};
+
+void TapBall::save_state()
 {
-  const int sw = gfx.width();
-  const int sh = gfx.height();
-
-  int score = 0;
-  int radius = 22;
-  int cx = irand(radius, sw - radius);
-  int cy = irand(radius + 18, sh - radius);
-  int vx = (irand(0, 1) ? 1 : -1) * irand(2, 4);
-  int vy = (irand(0, 1) ? 1 : -1) * irand(2, 4);
-  uint32_t last_spawn_ms = 0;
-  uint32_t last_touch_ms = 0;
-#if ENABLE_GAME_SWITCH
-  uint32_t hold_switch_ms = 0;
-#endif
+  GameSnapshot s = snapshot_make(GAME_TAP_BALL);
+  s.tap = { (int16_t)score_, (int16_t)radius_, (int16_t)cx_, (int16_t)cy_, (int8_t)vx_, (int8_t)vy_, ball_color_ };
+  resume_save(s);
+}
+
+void TapBall::respawn_ball()
+{
+  radius_ = irand(16, 28);
+  cx_ = irand(radius_, sw_ - radius_);
+  cy_ = irand(radius_ + HUD_H, sh_ - radius_);
+  vx_ = (irand(0, 1) ? 1 : -1) * irand(2, 5);
+  vy_ = (irand(0, 1) ? 1 : -1) * irand(2, 5);
+  ball_color_ = scene_.gfx().color888(irand(100,255), irand(100,255), irand(100,255));
+  scene_.move(ball_, cx_, cy_);
+  scene_.set_radius(ball_, radius_);
+  scene_.set_colors(ball_, ball_color_, 0);
+  last_spawn_ms_ = game_millis();
+  save_state();
+}
 
-  uint16_t ball_color = gfx.color888(irand(100,255), irand(100,255), irand(100,255));
-  static Particle particles[MAX_PARTICLES] = {};
-  static Ripple   ripples[MAX_RIPPLES]     = {};
+void TapBall::begin(GameView &v)
+{
+  scene_ = SceneView(*v.scene, v.view);
+  sw_ = v.w;
+  sh_ = v.h;
+
+  cx_ = irand(radius_, sw_ - radius_);
+  cy_ = irand(radius_ + HUD_H, sh_ - radius_);
+  vx_ = (irand(0, 1) ? 1 : -1) * irand(2, 4);
+  vy_ = (irand(0, 1) ? 1 : -1) * irand(2, 4);
+  ball_color_ = scene_.gfx().color888(irand(100,255), irand(100,255), irand(100,255));
+
+  GameSnapshot snap;
+  if (resume_claim(GAME_TAP_BALL, snap)) {
+    score_ = snap.tap.score; radius_ = snap.tap.radius;
+    cx_ = snap.tap.cx; cy_ = snap.tap.cy;
+    vx_ = snap.tap.vx; vy_ = snap.tap.vy;
+    ball_color_ = snap.tap.color;
+  }
+  save_state();
 
-  gfx.fillScreen(TFT_BLACK);
-  draw_title(gfx, "Game 1  Score: 0", sw);
+  score_store_begin_session(GAME_TAP_BALL, score_, 0);
+  score_store_log_best(GAME_TAP_BALL);
 
-  auto draw_hud = [&](){
-    gfx.setTextColor(TFT_WHITE, TFT_BLACK);
-    gfx.fillRect(0, 0, sw, 18, TFT_BLACK);
-    gfx.setCursor(4, 2);
-    gfx.printf("Game 1  Score: %d", score);
+  scene_.reset(TFT_BLACK);
+  clear_effects(*v.fx);
+  hud_text_ = add_title(scene_, "Game 1  Score: 0", sw_);
+  if (score_) scene_.set_text(hud_text_, "Game 1  Score: %d", score_);
 #if ENABLE_GAME_SWITCH
-    draw_switch_button(gfx, sw, "SWITCH");
+  add_switch_button(scene_, sw_, "SWITCH");
 #endif
-  };
-  auto draw_ball = [&](int x, int y, uint16_t col){ gfx.fillCircle(x, y, radius, col); };
-
-  draw_ball(cx, cy, ball_color);
-
-  while (true)
-  {
-    // erase previous effects
-    for (int i = 0; i < MAX_PARTICLES; ++i) if (particles[i].active)
-      gfx.fillCircle(particles[i].px, particles[i].py, particles[i].pr + 1, TFT_BLACK);
-    for (int i = 0; i < MAX_RIPPLES; ++i) if (ripples[i].active && ripples[i].prev_rad > 0) {
-      gfx.drawCircle(ripples[i].x, ripples[i].y, ripples[i].prev_rad,     TFT_BLACK);
-      gfx.drawCircle(ripples[i].x, ripples[i].y, ripples[i].prev_rad - 1, TFT_BLACK);
-    }
+  ball_ = scene_.add_circle(LAYER_PLAY, cx_, cy_, radius_, ball_color_);
+}
+
+GameStep TapBall::step(GameView &v)
+{
+  Effects &fx = *v.fx;
 
-    // move ball
-    int nx = cx + vx;
-    int ny = cy + vy;
-    if (nx - radius < 0 || nx + radius >= sw) { vx = -vx; nx = cx + vx; }
-    if (ny - radius < 18 || ny + radius >= sh) { vy = -vy; ny = cy + vy; }
-    gfx.fillCircle(cx, cy, radius + 1, TFT_BLACK);
-    cx = nx; cy = ny;
-    draw_ball(cx, cy, ball_color);
-
-    // touch input
-    uint16_t tx, ty;
-    if (gfx.getTouch(&tx, &ty)) {
-      fix_touch_coords(tx, ty, sw, sh);
+  // move ball
+  int nx = cx_ + vx_;
+  int ny = cy_ + vy_;
+  if (nx - radius_ < 0 || nx + radius_ >= sw_) { vx_ = -vx_; nx = cx_ + vx_; }
+  if (ny - radius_ < HUD_H || ny + radius_ >= sh_) { vy_ = -vy_; ny = cy_ + vy_; }
+  cx_ = nx; cy_ = ny;
+  scene_.move(ball_, cx_, cy_);
+  publish_aim(GAME_TAP_BALL, v.x + cx_, v.y + cy_, radius_);
+
+  // touch input: a press hit-tests, a drag leaves ripples, a swipe
+  // flicks the ball the way the finger went
+  if (const GestureEvent *ev = v.input()) {
+    const int tx = ev->x, ty = ev->y;
+    uint32_t now = game_millis();
+    if (ev->type == GESTURE_DOWN) {
       // top-right switch button tap
 #if ENABLE_GAME_SWITCH
-      if (is_in_switch_button(sw, tx, ty))
+      if (is_in_switch_button(sw_, tx, ty))
       {
-        gfx.fillScreen(TFT_BLACK);
-        ESP_LOGI(TAG_GAME1, "Switch button");
-        return;
+        dlog(DLOG_GAME_SWITCH, GAME_TAP_BALL);
+        return GAME_SWITCH;
       }
 #endif
-      int dx = (int)tx - cx;
-      int dy = (int)ty - cy;
-      uint32_t now = lgfx::v1::millis();
-      if (now - last_touch_ms > 80) { spawn_ripple(ripples, sw, sh, tx, ty, TFT_DARKGREY); last_touch_ms = now; }
-      if (dx * dx + dy * dy <= radius * radius) {
-        gfx.fillCircle(cx, cy, radius + 2, TFT_BLACK);
-        score++; draw_hud();
-        radius = irand(16, 28);
-        cx = irand(radius, sw - radius);
-        cy = irand(radius + 18, sh - radius);
-        vx = (irand(0, 1) ? 1 : -1) * irand(2, 5);
-        vy = (irand(0, 1) ? 1 : -1) * irand(2, 5);
-        uint16_t col = gfx.color888(irand(0,255), irand(0,255), irand(0,255));
-        ball_color = gfx.color888(irand(100,255), irand(100,255), irand(100,255));
-        spawn_particles(particles, tx, ty, col);
-        spawn_ripple(ripples, sw, sh, tx, ty, col);
-        draw_ball(cx, cy, ball_color);
-        last_spawn_ms = lgfx::v1::millis();
+      int dx = tx - cx_;
+      int dy = ty - cy_;
+      const bool hit = dx * dx + dy * dy <= radius_ * radius_;
+      latency_mark(LAT_HIT, GAME_TAP_BALL);
+      tap_record(GAME_TAP_BALL, v.x + tx, v.y + ty, hit ? TAP_HIT : TAP_MISS);
+      spawn_ripple(scene_, fx, sw_, sh_, tx, ty, TFT_DARKGREY);
+      last_touch_ms_ = now;
+      if (hit) {
+        score_++;
+        scene_.set_text(hud_text_, "Game 1  Score: %d", score_);
+        score_store_update(GAME_TAP_BALL, score_, 0);
+        uint16_t col = scene_.gfx().color888(irand(0,255), irand(0,255), irand(0,255));
+        respawn_ball();
+        spawn_particles<HitSparks>(scene_, fx, tx, ty, col);
+        spawn_ripple(scene_, fx, sw_, sh_, tx, ty, col);
       }
+      latency_mark(LAT_STATE);
+    } else if (ev->type == GESTURE_DRAG && now - last_touch_ms_ > 80) {
+      spawn_ripple(scene_, fx, sw_, sh_, tx, ty, TFT_DARKGREY);
+      last_touch_ms_ = now;
+    } else if (ev->type == GESTURE_SWIPE) {
+      const int speed = std::max(std::abs(vx_), std::abs(vy_));
+      if (ev->dir == SWIPE_LEFT || ev->dir == SWIPE_RIGHT) vx_ = ev->dir == SWIPE_LEFT ? -speed : speed;
+      else vy_ = ev->dir == SWIPE_UP ? -speed : speed;
+      save_state();
     }
+  }
 
-    // auto-respawn if idle
-    if (lgfx::v1::millis() - last_spawn_ms > 5000) {
-      gfx.fillCircle(cx, cy, radius + 2, TFT_BLACK);
-      radius = irand(16, 28);
-      cx = irand(radius, sw - radius);
-      cy = irand(radius + 18, sh - radius);
-      vx = (irand(0, 1) ? 1 : -1) * irand(2, 5);
-      vy = (irand(0, 1) ? 1 : -1) * irand(2, 5);
-      ball_color = gfx.color888(irand(100,255), irand(100,255), irand(100,255));
-      draw_ball(cx, cy, ball_color);
-      last_spawn_ms = lgfx::v1::millis();
-    }
+  // auto-respawn if idle
+  if (game_millis() - last_spawn_ms_ > 5000) respawn_ball();
 
-    // update effects
-    for (int i = 0; i < MAX_PARTICLES; ++i) if (particles[i].active) {
-      particles[i].px = particles[i].x; particles[i].py = particles[i].y; particles[i].pr = particles[i].r;
-      particles[i].x += particles[i].vx; particles[i].y += particles[i].vy;
-      if ((particles[i].life & 1) == 0 && particles[i].r > 0) particles[i].r--;
-      particles[i].life--;
-      if (particles[i].life <= 0 || particles[i].r <= 0) { gfx.fillCircle(particles[i].px, particles[i].py, particles[i].pr + 1, TFT_BLACK); particles[i].active = false; continue; }
-      gfx.fillCircle(particles[i].x, particles[i].y, particles[i].r, particles[i].color);
-    }
-    for (int i = 0; i < MAX_RIPPLES; ++i) if (ripples[i].active) {
-      ripples[i].prev_rad = ripples[i].radius;
-      ripples[i].radius += 2;
-      if (ripples[i].radius >= ripples[i].max_rad) { gfx.drawCircle(ripples[i].x, ripples[i].y, ripples[i].prev_rad, TFT_BLACK); ripples[i].active = false; continue; }
-      gfx.drawCircle(ripples[i].x, ripples[i].y, ripples[i].radius, ripples[i].color);
-      gfx.drawCircle(ripples[i].x, ripples[i].y, ripples[i].radius - 1, ripples[i].color);
-    }
-
-    vTaskDelay(pdMS_TO_TICKS(16));
-  }
+  step_particles<HitSparks>(scene_, fx);
+  step_ripples(scene_, fx);
+  return GAME_CONTINUE;
 }
+
+void TapBall::end(GameView &) { score_store_end_session(GAME_TAP_BALL); }
+
+static_assert(sizeof(TapBall) <= GAME_STATE_BYTES, "TapBall outgrew its scheduler slot");
+
+} // namespace
+
+GameTask *make_tap_ball(void *mem) { return new (mem) TapBall(); }
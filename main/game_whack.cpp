@@ -1,109 +1,137 @@
-extern "C" {
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
-#include "esp_log.h"
+#include "game_common.hpp"
+#include "games.hpp"
+#include "score_store.hpp"
+#include "dlog.hpp"
+#include "boot.hpp"
+#include <new>
+
+namespace {
+
+// A hit throws a fountain upwards that falls back, bouncing off the HUD bar
+using HitFountain = Emitter<ConeSpray<48, 8, 96>, Gravity<5>, BounceTop<HUD_H>, FadeAlpha>;
+
+class Whack : public GameTask {
+public:
+  void     begin(GameView &v) override;
+  GameStep step(GameView &v) override;
+  void     end(GameView &v) override;
+
+private:
+  void save_state();
+  void update_hud();
+  void spawn_target();
+
+  SceneView scene_;
+  int       sw_ = 0, sh_ = 0;
+  int       score_ = 0, miss_ = 0;
+  int       radius_ = 16;
+  int       txc_ = 0, tyc_ = 0;
+  uint32_t  ttl_ms_ = 1200;
+  uint32_t  spawn_ms_ = 0;
+  int       hud_text_ = -1, warn_ = -1, target_ = -1, target_edge_ = -1;
+};
+
+void Whack::save_state()
+{
+  GameSnapshot s = snapshot_make(GAME_WHACK);
+  s.whack = { (int16_t)score_, (int16_t)miss_, (int16_t)txc_, (int16_t)tyc_, (uint16_t)ttl_ms_ };
+  resume_save(s);
 }
 
-#include "game_common.hpp"
+void Whack::update_hud()
+{
+  scene_.set_text(hud_text_, "Game 2  Score:%d  Miss:%d", score_, miss_);
+  scene_.set_visible(warn_, miss_ >= 5);
+}
 
-static const char* TAG_GAME2 = "GAME2";
+void Whack::spawn_target()
+{
+  txc_ = irand(radius_, sw_ - radius_);
+  tyc_ = irand(radius_ + HUD_H, sh_ - radius_);
+  spawn_ms_ = game_millis();
+  scene_.move(target_, txc_, tyc_);
+  scene_.move(target_edge_, txc_, tyc_);
+  save_state();
+}
 
-void game_whack(LGFX& gfx)
+void Whack::begin(GameView &v)
 {
-  const int sw = gfx.width();
-  const int sh = gfx.height();
-  gfx.fillScreen(TFT_BLACK);
-
-  int score = 0, miss = 0;
-  int radius = 16;
-  int txc = irand(radius, sw - radius);
-  int tyc = irand(radius + 18, sh - radius);
-  uint32_t ttl_ms = 1200;
-  uint32_t spawn_ms = lgfx::v1::millis();
-  uint32_t last_fx_ms = 0;
-#if ENABLE_GAME_SWITCH
-  uint32_t hold_switch_ms = 0;
-#endif
+  scene_ = SceneView(*v.scene, v.view);
+  sw_ = v.w;
+  sh_ = v.h;
 
-  static Ripple   ripples[MAX_RIPPLES]     = {};
-  static Particle particles[MAX_PARTICLES] = {};
+  txc_ = irand(radius_, sw_ - radius_);
+  tyc_ = irand(radius_ + HUD_H, sh_ - radius_);
+  spawn_ms_ = game_millis();
 
-  auto draw_hud = [&](){
-    gfx.setTextColor(TFT_WHITE, TFT_BLACK);
-    gfx.fillRect(0, 0, sw, 18, TFT_BLACK);
-    gfx.setCursor(4, 2);
-    gfx.printf("Game 2  Score:%d  Miss:%d", score, miss);
-#if ENABLE_GAME_SWITCH
-    draw_switch_button(gfx, sw, "SWITCH");
-#endif
-  };
-  draw_hud();
-
-  auto spawn_target = [&](){
-    txc = irand(radius, sw - radius);
-    tyc = irand(radius + 18, sh - radius);
-    spawn_ms = lgfx::v1::millis();
-  };
-  auto draw_target = [&](){
-    gfx.fillCircle(txc, tyc, radius, TFT_GREEN);
-    gfx.drawCircle(txc, tyc, radius + 1, TFT_DARKGREEN);
-  };
-  draw_target();
-
-  while (true) {
-    uint32_t now = lgfx::v1::millis();
-    if (now - spawn_ms > ttl_ms) {
-      gfx.fillCircle(txc, tyc, radius + 2, TFT_BLACK);
-      miss++; draw_hud(); spawn_target(); draw_target();
-    }
+  GameSnapshot snap;
+  if (resume_claim(GAME_WHACK, snap)) {
+    score_ = snap.whack.score; miss_ = snap.whack.miss;
+    txc_ = snap.whack.txc; tyc_ = snap.whack.tyc;
+    ttl_ms_ = snap.whack.ttl_ms;
+  }
+  save_state();
+
+  score_store_begin_session(GAME_WHACK, score_, miss_);
+  score_store_log_best(GAME_WHACK);
 
-    // touch
-    uint16_t x, y;
-    if (gfx.getTouch(&x, &y)) {
-      fix_touch_coords(x, y, sw, sh);
-      // top-right switch button tap
+  scene_.reset(TFT_BLACK);
+  clear_effects(*v.fx);
+  hud_text_ = add_title(scene_, "Game 2  Score:0  Miss:0", sw_, 1);
 #if ENABLE_GAME_SWITCH
-      if (is_in_switch_button(sw, x, y)) { gfx.fillScreen(TFT_BLACK); ESP_LOGI(TAG_GAME2, "Switch button"); return; }
+  add_switch_button(scene_, sw_, "SWITCH");
 #endif
-      int dx = (int)x - txc, dy = (int)y - tyc;
-      if ((dx*dx + dy*dy) <= radius*radius) {
-        gfx.fillCircle(txc, tyc, radius + 2, TFT_BLACK);
-        score++; draw_hud();
-        uint16_t col = gfx.color888(irand(64,255), irand(64,255), irand(64,255));
-        spawn_particles(particles, txc, tyc, col);
-        spawn_ripple(ripples, sw, sh, x, y, col);
-        spawn_target(); draw_target();
-      } else if (now - last_fx_ms > 80) {
-        spawn_ripple(ripples, sw, sh, x, y, TFT_DARKGREY);
-        last_fx_ms = now;
-      }
-    }
+  warn_ = scene_.add_text(LAYER_HUD, 10, sh_ - 20, 2, TFT_YELLOW, "Miss >= 5");
+  scene_.set_visible(warn_, false);
 
-    // update effects
-    for (int i = 0; i < MAX_PARTICLES; ++i) if (particles[i].active) {
-      gfx.fillCircle(particles[i].px, particles[i].py, particles[i].pr + 1, TFT_BLACK);
-      particles[i].px = particles[i].x; particles[i].py = particles[i].y; particles[i].pr = particles[i].r;
-      particles[i].x += particles[i].vx; particles[i].y += particles[i].vy;
-      if ((particles[i].life & 1) == 0 && particles[i].r > 0) particles[i].r--;
-      particles[i].life--; if (particles[i].life <= 0 || particles[i].r <= 0) { particles[i].active = false; continue; }
-      gfx.fillCircle(particles[i].x, particles[i].y, particles[i].r, particles[i].color);
-    }
-    for (int i = 0; i < MAX_RIPPLES; ++i) if (ripples[i].active) {
-      if (ripples[i].prev_rad > 0) {
-        gfx.drawCircle(ripples[i].x, ripples[i].y, ripples[i].prev_rad,     TFT_BLACK);
-        gfx.drawCircle(ripples[i].x, ripples[i].y, ripples[i].prev_rad - 1, TFT_BLACK);
-      }
-      ripples[i].prev_rad = ripples[i].radius; ripples[i].radius += 2;
-      if (ripples[i].radius >= ripples[i].max_rad) { ripples[i].active = false; continue; }
-      gfx.drawCircle(ripples[i].x, ripples[i].y, ripples[i].radius,     ripples[i].color);
-      gfx.drawCircle(ripples[i].x, ripples[i].y, ripples[i].radius - 1, ripples[i].color);
-    }
+  target_      = scene_.add_circle(LAYER_PLAY, txc_, tyc_, radius_, TFT_GREEN);
+  target_edge_ = scene_.add_ring(LAYER_PLAY, txc_, tyc_, radius_ + 1, 1, TFT_DARKGREEN);
+  update_hud();
+}
 
-    if (miss >= 5) {
-      gfx.setTextColor(TFT_YELLOW, TFT_BLACK);
-      gfx.setCursor(10, sh - 20);
-      gfx.print("Miss >= 5");
+GameStep Whack::step(GameView &v)
+{
+  Effects &fx = *v.fx;
+  uint32_t now = game_millis();
+  if (now - spawn_ms_ > ttl_ms_) {
+    miss_++; update_hud(); spawn_target();
+    score_store_update(GAME_WHACK, score_, miss_);
+  }
+  publish_aim(GAME_WHACK, v.x + txc_, v.y + tyc_, radius_);
+
+  // touch: one hit test per contact, so a held finger scores or misses once
+  const GestureEvent *ev = v.input();
+  if (ev && ev->type == GESTURE_DOWN) {
+    // top-right switch button tap
+#if ENABLE_GAME_SWITCH
+    if (is_in_switch_button(sw_, ev->x, ev->y)) { dlog(DLOG_GAME_SWITCH, GAME_WHACK); return GAME_SWITCH; }
+#endif
+    int dx = ev->x - txc_, dy = ev->y - tyc_;
+    const bool hit = (dx*dx + dy*dy) <= radius_*radius_;
+    latency_mark(LAT_HIT, GAME_WHACK);
+    tap_record(GAME_WHACK, v.x + ev->x, v.y + ev->y, hit ? TAP_HIT : TAP_MISS);
+    if (hit) {
+      score_++; update_hud();
+      score_store_update(GAME_WHACK, score_, miss_);
+      uint16_t col = scene_.gfx().color888(irand(64,255), irand(64,255), irand(64,255));
+      spawn_particles<HitFountain>(scene_, fx, txc_, tyc_, col);
+      spawn_ripple(scene_, fx, sw_, sh_, ev->x, ev->y, col);
+      spawn_target();
+    } else {
+      spawn_ripple(scene_, fx, sw_, sh_, ev->x, ev->y, TFT_DARKGREY);
     }
-    vTaskDelay(pdMS_TO_TICKS(16));
+    latency_mark(LAT_STATE);
   }
+
+  step_particles<HitFountain>(scene_, fx);
+  step_ripples(scene_, fx);
+  return GAME_CONTINUE;
 }
+
+void Whack::end(GameView &) { score_store_end_session(GAME_WHACK); }
+
+static_assert(sizeof(Whack) <= GAME_STATE_BYTES, "Whack outgrew its scheduler slot");
+
+} // namespace
+
+GameTask *make_whack(void *mem) { return new (mem) Whack(); }
@@ -3,7 +3,20 @@
 
 #include "game_common.hpp"
 
-void game_tap_ball(LGFX& gfx);
-void game_whack(LGFX& gfx);
-void game_memory_grid(LGFX& gfx);
+// Stable ids, also used as score-store slots: do not reorder
+enum GameId : int {
+  GAME_TAP_BALL = 0,
+  GAME_WHACK,
+  GAME_MEMORY_GRID,
+  GAME_COUNT
+};
+
+// Each game constructs itself in a GameScheduler slot, resets its view
+// in begin() and runs one frame per step()
+GameTask *make_tap_ball(void *mem);
+GameTask *make_whack(void *mem);
+GameTask *make_memory_grid(void *mem);
+
+// Indexed by GameId
+inline const GameFactory GAME_FACTORIES[GAME_COUNT] = { make_tap_ball, make_whack, make_memory_grid };
 
@@ -0,0 +1,106 @@
+#include "gesture.hpp"
+
+bool GestureRecognizer::far(int x0, int y0, int x1, int y1, int px) const
+{
+  const int dx = x1 - x0, dy = y1 - y0;
+  return dx * dx + dy * dy > px * px;
+}
+
+bool GestureRecognizer::emit(GestureEvent &ev, GestureType type, uint32_t now_ms, int dx, int dy)
+{
+  ev.type = type;
+  ev.dir = 0;
+  ev.x = x_; ev.y = y_;
+  ev.dx = (int16_t)dx; ev.dy = (int16_t)dy;
+  ev.ms = now_ms - down_ms_;
+  return true;
+}
+
+bool GestureRecognizer::finish(GestureEvent &ev)
+{
+  const State s = state_;
+  const uint32_t held = lift_ms_ - down_ms_;
+  const int dx = x_ - x0_, dy = y_ - y0_;
+  state_ = IDLE;
+  lifted_ = have_cand_ = false;
+
+  if (held <= cfg_.swipe_max_ms && far(x0_, y0_, x_, y_, cfg_.swipe_min_px)) {
+    emit(ev, GESTURE_SWIPE, lift_ms_, dx, dy);
+    const int ax = dx < 0 ? -dx : dx, ay = dy < 0 ? -dy : dy;
+    ev.dir = ax >= ay ? (dx < 0 ? SWIPE_LEFT : SWIPE_RIGHT) : (dy < 0 ? SWIPE_UP : SWIPE_DOWN);
+    return true;
+  }
+  if (s == DRAGGING) return emit(ev, GESTURE_DRAG_END, lift_ms_, dx, dy);
+  if (s == PRESSED && held <= cfg_.tap_max_ms) {
+    emit(ev, GESTURE_TAP, lift_ms_, dx, dy);
+    ev.x = x0_; ev.y = y0_;
+    return true;
+  }
+  return emit(ev, GESTURE_UP, lift_ms_, dx, dy);
+}
+
+bool GestureRecognizer::feed(uint32_t now_ms, bool pressed, uint16_t x, uint16_t y, GestureEvent &ev)
+{
+  if (!pressed) {
+    if (state_ == IDLE) return false;
+    if (!lifted_) { lifted_ = true; lift_ms_ = now_ms; }
+    if (now_ms - lift_ms_ < cfg_.debounce_ms) return false;
+    return finish(ev);
+  }
+
+  if (state_ == IDLE) {
+    state_ = PRESSED;
+    lifted_ = have_cand_ = false;
+    down_ms_ = now_ms;
+    x0_ = x_ = rx_ = (int16_t)x;
+    y0_ = y_ = ry_ = (int16_t)y;
+    sx_ = sy_ = 0;
+    return emit(ev, GESTURE_DOWN, now_ms, 0, 0);
+  }
+  lifted_ = false;   // back within debounce_ms: the lift was a dropout
+
+  // A lone far sample is usually the panel misreading as pressure changes.
+  // A real fast move either settles near it or carries on by the same step
+  // on the next sample, and once confirmed keeps that step per sample
+  bool accept = true;
+  const int half = cfg_.jump_px / 2;
+  if (cfg_.jump_px && far(x_, y_, x, y, cfg_.jump_px)) {
+    if (!far(x_ + sx_, y_ + sy_, x, y, half)) {
+      have_cand_ = false;
+    } else {
+      accept = have_cand_ && (!far(cx_, cy_, x, y, half) ||
+                              !far(2 * cx_ - x_, 2 * cy_ - y_, x, y, half));
+      if (accept) { x_ = cx_; y_ = cy_; }
+      have_cand_ = !accept;
+      cx_ = (int16_t)x; cy_ = (int16_t)y;
+    }
+  } else {
+    have_cand_ = false;
+  }
+  if (accept) {
+    sx_ = (int16_t)(x - x_); sy_ = (int16_t)(y - y_);
+    x_ = (int16_t)x; y_ = (int16_t)y;
+  }
+
+  switch (state_) {
+  case PRESSED:
+  case LONG:
+    if (far(x0_, y0_, x_, y_, cfg_.slop_px)) {
+      state_ = DRAGGING;
+      rx_ = x_; ry_ = y_;
+      return emit(ev, GESTURE_DRAG_START, now_ms, x_ - x0_, y_ - y0_);
+    }
+    if (state_ == PRESSED && now_ms - down_ms_ >= cfg_.long_press_ms) {
+      state_ = LONG;
+      return emit(ev, GESTURE_LONG_PRESS, now_ms, 0, 0);
+    }
+    return false;
+  case DRAGGING:
+    if (x_ == rx_ && y_ == ry_) return false;
+    emit(ev, GESTURE_DRAG, now_ms, x_ - rx_, y_ - ry_);
+    rx_ = x_; ry_ = y_;
+    return true;
+  default:
+    return false;
+  }
+}
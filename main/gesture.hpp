@@ -0,0 +1,72 @@
+// Streaming gesture recognizer (no ESP-IDF deps). Fed one touch sample
+// per frame; keeps a few words of state for the single contact, allocates
+// nothing and does constant work per sample. Every contact produces one
+// GESTURE_DOWN and, once the finger is gone, exactly one of TAP, SWIPE,
+// DRAG_END or UP, so a held finger can never trigger twice.
+#pragma once
+
+#include <cstdint>
+
+enum GestureType : uint8_t {
+  GESTURE_NONE = 0,
+  GESTURE_DOWN,         // contact began; games hit-test on this
+  GESTURE_LONG_PRESS,   // held still for long_press_ms
+  GESTURE_DRAG_START,   // moved beyond slop_px
+  GESTURE_DRAG,         // dx/dy: movement since the previous drag event
+  // Terminal events, one per contact
+  GESTURE_TAP,          // short and still; x/y where it went down
+  GESTURE_SWIPE,        // quick and far; dx/dy total, dir dominant axis
+  GESTURE_DRAG_END,
+  GESTURE_UP,           // anything else (slow press, long press)
+};
+
+enum SwipeDir : uint8_t { SWIPE_LEFT, SWIPE_RIGHT, SWIPE_UP, SWIPE_DOWN };
+
+struct GestureEvent {
+  GestureType type;
+  uint8_t  dir;          // SwipeDir, swipes only
+  int16_t  x, y;         // current position (TAP: where it went down)
+  int16_t  dx, dy;       // see GestureType
+  uint32_t ms;           // contact duration so far
+};
+
+struct GestureConfig {
+  uint16_t slop_px       = 10;    // movement still counted as holding still
+  uint16_t tap_max_ms    = 300;
+  uint16_t long_press_ms = 500;
+  uint16_t swipe_min_px  = 40;
+  uint16_t swipe_max_ms  = 400;
+  uint16_t debounce_ms   = 40;    // lifts shorter than this are touch dropouts
+  uint16_t jump_px       = 64;    // one-sample jumps this far need the next sample to confirm them; 0 off
+};
+
+class GestureRecognizer {
+public:
+  explicit GestureRecognizer(const GestureConfig &cfg = GestureConfig()) : cfg_(cfg) {}
+
+  void set_config(const GestureConfig &cfg) { cfg_ = cfg; }
+  const GestureConfig &config() const { return cfg_; }
+
+  // One touch sample (x/y ignored when not pressed); true when `ev` holds
+  // an event. Terminal events arrive debounce_ms after the lift.
+  bool feed(uint32_t now_ms, bool pressed, uint16_t x, uint16_t y, GestureEvent &ev);
+
+  bool active() const { return state_ != IDLE; }
+
+private:
+  enum State : uint8_t { IDLE, PRESSED, LONG, DRAGGING };
+
+  bool emit(GestureEvent &ev, GestureType type, uint32_t now_ms, int dx, int dy);
+  bool finish(GestureEvent &ev);
+  bool far(int x0, int y0, int x1, int y1, int px) const;
+
+  GestureConfig cfg_;
+  State    state_ = IDLE;
+  bool     lifted_ = false, have_cand_ = false;
+  uint32_t down_ms_ = 0, lift_ms_ = 0;
+  int16_t  x0_ = 0, y0_ = 0;       // where it went down
+  int16_t  x_ = 0, y_ = 0;         // last accepted sample
+  int16_t  rx_ = 0, ry_ = 0;       // last reported drag position
+  int16_t  cx_ = 0, cy_ = 0;       // unconfirmed jump
+  int16_t  sx_ = 0, sy_ = 0;       // step to the last accepted sample
+};
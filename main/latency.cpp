@@ -0,0 +1,90 @@
+#include "latency.hpp"
+#include <cstdio>
+#include <cstring>
+
+static const char *const SEGMENT_NAMES[LAT_SEGMENTS] = { "poll", "hit", "state", "flush", "total" };
+
+static int bucket_of(uint32_t us)
+{
+  if (us < 4) return (int)us;
+  int octave = 31 - __builtin_clz(us);
+  int b = (octave - 1) * 4 + (int)((us >> (octave - 2)) & 3);
+  return b < LAT_BUCKETS ? b : LAT_BUCKETS - 1;
+}
+
+static uint32_t bucket_upper(int b)
+{
+  if (b < 4) return (uint32_t)b;
+  int octave = b / 4 + 1, sub = b % 4;
+  return ((4u + sub + 1) << (octave - 2)) - 1;
+}
+
+void LatHistogram::add(uint32_t us)
+{
+  uint16_t &c = counts[bucket_of(us)];
+  if (c != UINT16_MAX) ++c;
+  ++n;
+  if (us > max_us) max_us = us;
+}
+
+uint32_t LatHistogram::percentile(int pct) const
+{
+  uint32_t total = 0;
+  for (int b = 0; b < LAT_BUCKETS; ++b) total += counts[b];
+  if (!total) return 0;
+  uint32_t want = (total * (uint32_t)pct + 99) / 100, seen = 0;
+  for (int b = 0; b < LAT_BUCKETS; ++b) {
+    seen += counts[b];
+    if (seen >= want) return b == LAT_BUCKETS - 1 ? max_us : bucket_upper(b);
+  }
+  return max_us;
+}
+
+void LatencyTracker::reset()
+{
+  std::memset(hist_, 0, sizeof(hist_));
+  active_ = false;
+  dropped_ = 0;
+}
+
+void LatencyTracker::sample(bool pressed, int64_t acquired_us, int64_t now_us)
+{
+  const bool edge = pressed && !was_pressed_;
+  was_pressed_ = pressed;
+  if (!edge || active_) return;
+  active_ = true;
+  game_ = -1;
+  stamp_[LAT_ACQUIRE] = acquired_us;
+  stamp_[LAT_READ] = now_us;
+  stamp_[LAT_HIT] = stamp_[LAT_STATE] = -1;
+}
+
+void LatencyTracker::mark(LatStage stage, int64_t now_us, int game)
+{
+  if (!active_ || stage <= LAT_READ || stage >= LAT_PHOTON || stamp_[stage] >= 0) return;
+  if (stage == LAT_HIT) game_ = game;
+  else if (stamp_[LAT_HIT] < 0) return;   // state change for something else
+  stamp_[stage] = now_us;
+}
+
+void LatencyTracker::flushed(int64_t now_us)
+{
+  if (!active_) return;
+  active_ = false;
+  if (stamp_[LAT_HIT] < 0 || game_ < 0 || game_ >= LAT_GAMES) { ++dropped_; return; }
+  if (stamp_[LAT_STATE] < 0) stamp_[LAT_STATE] = stamp_[LAT_HIT];
+  stamp_[LAT_PHOTON] = now_us;
+  for (int s = 0; s < LAT_PHOTON; ++s)
+    hist_[game_][s].add((uint32_t)(stamp_[s + 1] - stamp_[s]));
+  hist_[game_][LAT_SEGMENTS - 1].add((uint32_t)(stamp_[LAT_PHOTON] - stamp_[LAT_ACQUIRE]));
+}
+
+int LatencyTracker::format(int game, char *buf, size_t len) const
+{
+  const LatHistogram *h = hist_[game];
+  int n = snprintf(buf, len, "game %d n=%u", game, (unsigned)h[LAT_SEGMENTS - 1].n);
+  for (int s = 0; s < LAT_SEGMENTS && n > 0 && (size_t)n < len; ++s)
+    n += snprintf(buf + n, len - n, " %s %u/%u/%u", SEGMENT_NAMES[s], (unsigned)h[s].percentile(50),
+                  (unsigned)h[s].percentile(90), (unsigned)h[s].percentile(99));
+  return n;
+}
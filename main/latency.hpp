@@ -0,0 +1,63 @@
+// Touch-to-photon latency probes and histograms (no ESP-IDF deps; callers
+// pass timestamps, so the host simulator can drive it from a fake clock)
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Stamps along one touch's path to the screen
+enum LatStage : uint8_t {
+  LAT_ACQUIRE = 0,   // panel sampled (start of the SPI batch that saw it)
+  LAT_READ,          // read_touch handed it to the game
+  LAT_HIT,           // game finished hit-testing it
+  LAT_STATE,         // game state and scene updated in response
+  LAT_PHOTON,        // SPI transfer of the resulting pixels completed
+  LAT_STAGE_COUNT
+};
+
+// Segment i spans stage i to i+1; the last one is acquire to photon
+constexpr int LAT_SEGMENTS = LAT_STAGE_COUNT;
+constexpr int LAT_GAMES    = 4;
+
+// Log-linear buckets: 4 per power of two, 1 us .. 131 ms (<25% wide)
+constexpr int LAT_BUCKETS = 64;
+
+struct LatHistogram {
+  uint16_t counts[LAT_BUCKETS];   // saturating
+  uint32_t n;
+  uint32_t max_us;
+
+  void     add(uint32_t us);
+  uint32_t percentile(int pct) const;   // bucket upper bound, in us
+};
+
+class LatencyTracker {
+public:
+  LatencyTracker() { reset(); }
+
+  // Every touch poll, pressed or not. A probe starts on a press edge only:
+  // a held finger is not a new reaction to measure.
+  void sample(bool pressed, int64_t acquired_us, int64_t now_us);
+
+  // LAT_HIT names the game; a probe the game never hit-tests is dropped at
+  // the next flush. A missing LAT_STATE counts as zero time after the hit.
+  void mark(LatStage stage, int64_t now_us, int game = -1);
+
+  // Frame pixels are on the panel: completes the probe in flight
+  void flushed(int64_t now_us);
+
+  const LatHistogram &hist(int game, int segment) const { return hist_[game][segment]; }
+  uint32_t dropped() const { return dropped_; }
+  void reset();
+
+  // One line per game with samples: p50/p90/p99 per segment, in us
+  int format(int game, char *buf, size_t len) const;
+
+private:
+  int64_t      stamp_[LAT_STAGE_COUNT];   // -1 until reached
+  bool         active_ = false;
+  bool         was_pressed_ = false;
+  int          game_ = -1;
+  uint32_t     dropped_ = 0;
+  LatHistogram hist_[LAT_GAMES][LAT_SEGMENTS];
+};
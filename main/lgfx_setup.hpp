@@ -56,6 +56,29 @@
 #undef  TOUCH_ROTATION
 #define TOUCH_ROTATION 0
 
+// XPT2046 calibration (raw 12-bit range), shared by LGFX and touch_dma
+#ifndef TOUCH_X_MIN
+#define TOUCH_X_MIN 300
+#endif
+#ifndef TOUCH_X_MAX
+#define TOUCH_X_MAX 3900
+#endif
+#ifndef TOUCH_Y_MIN
+#define TOUCH_Y_MIN 300
+#endif
+#ifndef TOUCH_Y_MAX
+#define TOUCH_Y_MAX 3900
+#endif
+#ifndef TOUCH_Z_THRESHOLD
+#define TOUCH_Z_THRESHOLD 400
+#endif
+
+// 1: games read touch through the queued DMA driver (touch_dma.cpp) and
+//    LGFX leaves the touch SPI host alone; 0: blocking LGFX getTouch
+#ifndef TOUCH_DMA_DRIVER
+#define TOUCH_DMA_DRIVER 1
+#endif
+
 // If touch must be on a separate SPI host, define it here
 #ifndef TOUCH_SPI_HOST
 #define TOUCH_SPI_HOST SPI2_HOST
@@ -102,12 +125,30 @@
 #define TFT_BL_ACTIVE 1
 #endif
 
+#ifndef LGFX_HEADLESS
+#define LGFX_HEADLESS 0
+#endif
+
+#if LGFX_HEADLESS
+// Host builds (tools/golden): a 16-bit off-screen canvas the size of the
+// panel's memory stands in for it, so pixels can be read back and hashed
+class LGFX : public lgfx::LGFX_Sprite
+{
+public:
+  bool init()
+  {
+    setColorDepth(16);
+    return createSprite(TFT_WIDTH, TFT_HEIGHT) != nullptr;
+  }
+  bool getTouch(uint16_t *, uint16_t *) { return false; }
+};
+#else
 class LGFX : public lgfx::LGFX_Device
 {
   lgfx::Bus_SPI _bus;
   lgfx::Panel_ILI9341 _panel;
   lgfx::Light_PWM _light;
-#if TOUCH_XPT2046
+#if TOUCH_XPT2046 && !TOUCH_DMA_DRIVER
   lgfx::Touch_XPT2046 _touch;
 #endif
 
@@ -190,7 +231,7 @@ public:
       _panel.setLight(&_light);
     }
 
-#if TOUCH_XPT2046
+#if TOUCH_XPT2046 && !TOUCH_DMA_DRIVER
     // ---- Touch (XPT2046 over SPI, optional) ----
     // Only configure if CS is valid. Pins default to TFT_* if not provided.
     if (TOUCH_CS >= 0)
@@ -209,10 +250,10 @@ public:
 
       // XPT2046 校准参数 - 根据实际测试调整
       // 这些值需要根据您的硬件进行微调
-      tcfg.x_min = 300;  // X轴最小原始值
-      tcfg.x_max = 3900; // X轴最大原始值
-      tcfg.y_min = 300;  // Y轴最小原始值
-      tcfg.y_max = 3900; // Y轴最大原始值
+      tcfg.x_min = TOUCH_X_MIN; // X轴最小原始值
+      tcfg.x_max = TOUCH_X_MAX; // X轴最大原始值
+      tcfg.y_min = TOUCH_Y_MIN; // Y轴最小原始值
+      tcfg.y_max = TOUCH_Y_MAX; // Y轴最大原始值
 
       // 触摸变换和旋转
       tcfg.offset_rotation = TOUCH_ROTATION;
@@ -225,3 +266,4 @@ public:
     setPanel(&_panel);
   }
 };
+#endif
@@ -2,12 +2,21 @@ extern "C" {
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_log.h"
+#include "esp_random.h"
 #include "sdkconfig.h"
 }
 
 #include "lgfx_setup.hpp"
 #include "game_common.hpp"
 #include "games.hpp"
+#include "score_store.hpp"
+#include "touch_dma.hpp"
+#include "autoplay.hpp"
+#include "effect_arena.hpp"
+#include "mem_report.hpp"
+#include "dlog.hpp"
+#include "boot.hpp"
+#include "stats_console.hpp"
 
 // Build-time options
 #ifndef GAME_MODE
@@ -17,48 +26,103 @@ extern "C" {
 #define ENABLE_GAME_SWITCH 0
 #endif
 
+// Touch init runs before the panel reports its rotation, so pin it here
+#define DISPLAY_ROTATION 1
+
 static const char* TAG = "TOUCH_GAME";
 
+RAM_ACCOUNT(gfx,   "lgfx",         sizeof(LGFX));
+RAM_ACCOUNT(scene, "scene",        sizeof(Scene));
+RAM_ACCOUNT(arena, "effect arena", EFFECT_ARENA_BYTES);
+RAM_ACCOUNT(taps,  "tap stats",    sizeof(TapStats));
+
+#if TOUCH_DMA_DRIVER
+// Touch sits on its own SPI host, so its bring-up overlaps the panel's
+static void touch_init_task(void *)
+{
+  if (!touch_dma_init(DISPLAY_ROTATION, TFT_WIDTH, TFT_HEIGHT)) ESP_LOGE(TAG, "Touch init failed");
+  boot_mark(BOOT_TOUCH);
+  vTaskDelete(nullptr);
+}
+#endif
+
+static Scene *s_scene = nullptr;
+
+static const char *const GAME_NAMES[GAME_COUNT] = { "Tap Ball", "Whack-a-Mole", "Memory Grid" };
+
+// Runs inside the frame on the render task
+static void on_game_switch(int slot, int from, int to)
+{
+  dlog(DLOG_GAME_SLOT, slot, from + 1, to + 1);
+  reports_request();   // they cover the game that just left
+}
+
+// Nothing here is needed to draw or play the first frame
+static void deferred_setup()
+{
+  dlog_init();        // records logged before this sit in the ring
+  score_store_init(); // merges with whatever the running game already counted
+  mem_report_log();
+  stats_console_start(*s_scene);
+}
+
 extern "C" void app_main(void)
 {
+  boot_begin();
   ESP_LOGI(TAG, "Starting touch game (compile-time switch)...");
-  vTaskDelay(pdMS_TO_TICKS(100));
+
+#if TOUCH_DMA_DRIVER
+  xTaskCreate(touch_init_task, "touch_init", 3072, nullptr, tskIDLE_PRIORITY + 2, nullptr);
+#else
+  boot_mark(BOOT_TOUCH);
+#endif
 
   static LGFX gfx;
   if (!gfx.init()) { ESP_LOGE(TAG, "LGFX init failed"); while (1) vTaskDelay(pdMS_TO_TICKS(1000)); }
-  gfx.setRotation(1);
+  gfx.setRotation(DISPLAY_ROTATION);
   gfx.setColorDepth(16);
-  gfx.fillScreen(TFT_BLACK);
+  // No fillScreen: the scene's first flush repaints the whole panel anyway
+  boot_mark(BOOT_DISPLAY);
+
+  static Scene scene(gfx);
+  s_scene = &scene;
 
+#if AUTOPLAY_BOT
+  autoplay_start(esp_random(), scene);
+#endif
+
+  mem_report_track_task(xTaskGetCurrentTaskHandle(), "app_main");
+  boot_defer(deferred_setup);
+
+  static Effects fx[SCHED_SLOTS];
+  static GameScheduler sched(GAME_FACTORIES, GAME_COUNT, gesture_input, &gfx);
+  sched.on_switch(on_game_switch);
+
+#if GAME_MODE < 1 || GAME_MODE > 3
+  #error "Invalid GAME_MODE (use 1, 2 or 3)"
+#endif
+  int first = GAME_MODE - 1;
 #if ENABLE_GAME_SWITCH
-  int mode = (GAME_MODE >= 1 && GAME_MODE <= 3) ? GAME_MODE : 1;
-  while (true) {
-    if (mode == 1) {
-      ESP_LOGI(TAG, "GAME_MODE=1 (Tap Ball)");
-      game_tap_ball(gfx);
-      mode = 2;
-    } else if (mode == 2) {
-      ESP_LOGI(TAG, "GAME_MODE=2 (Whack-a-Mole)");
-      game_whack(gfx);
-      mode = 3;
-    } else {
-      ESP_LOGI(TAG, "GAME_MODE=3 (Memory Grid)");
-      game_memory_grid(gfx);
-      mode = 1;
-    }
-  }
+  if (resume_game() >= 0) first = resume_game();
+#endif
+  const int sw = gfx.width(), sh = gfx.height();
+  tap_stats_screen(sw, sh);
+#if SPLIT_SCREEN
+  // Two games stacked, each in its own scene view; touches go to the half
+  // they land in
+  const int half = sh / 2;
+  scene.set_view(1, 0, 0, sw, half);
+  scene.set_view(2, 0, half, sw, sh - half);
+  const int second = (first + 1) % GAME_COUNT;
+  fx[0] = borrow_effects();
+  fx[1] = borrow_effects();
+  ESP_LOGI(TAG, "Split screen: %s above %s", GAME_NAMES[first], GAME_NAMES[second]);
+  sched.start(0, first, game_view(&scene, &fx[0], 1, 0, 0, sw, half));
+  sched.start(1, second, game_view(&scene, &fx[1], 2, 0, half, sw, sh - half));
 #else
-  #if GAME_MODE == 1
-    ESP_LOGI(TAG, "GAME_MODE=1 (Tap Ball)");
-    game_tap_ball(gfx);
-  #elif GAME_MODE == 2
-    ESP_LOGI(TAG, "GAME_MODE=2 (Whack-a-Mole)");
-    game_whack(gfx);
-  #elif GAME_MODE == 3
-    ESP_LOGI(TAG, "GAME_MODE=3 (Memory Grid)");
-    game_memory_grid(gfx);
-  #else
-    #error "Invalid GAME_MODE (use 1, 2 or 3)"
-  #endif
+  ESP_LOGI(TAG, "GAME_MODE=%d (%s)", first + 1, GAME_NAMES[first]);
+  fx[0] = borrow_effects();
+  sched.start(0, first, game_view(&scene, &fx[0], 0, 0, 0, sw, sh));
 #endif
+  while (true) run_frame(sched, scene);
 }
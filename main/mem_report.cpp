@@ -0,0 +1,90 @@
+extern "C" {
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_system.h"
+}
+
+#include "mem_report.hpp"
+#include "effect_arena.hpp"
+#include <atomic>
+#include <cstdio>
+
+static const char *TAG_MEM = "MEM";
+
+static constexpr int MAX_TASKS = 8;
+
+// Constant-initialised, so accounts constructed before main() can link in safely
+static RamAccount *s_accounts = nullptr;
+
+// Tasks register from several tasks while the console reads the list: a
+// slot is claimed with fetch_add and counted in s_task_count only once
+// written. Slots are published in claim order, so a writer waits for the
+// one before it (registrations are a handful during startup).
+static struct {
+  TaskHandle_t handle;
+  const char  *name;
+} s_tasks[MAX_TASKS];
+static std::atomic<int> s_task_claimed{0};
+static std::atomic<int> s_task_count{0};
+
+RamAccount::RamAccount(const char *n, size_t b) : name(n), bytes(b), next(s_accounts)
+{
+  s_accounts = this;
+}
+
+void mem_report_track_task(void *task, const char *name)
+{
+  if (!task) return;
+  const int slot = s_task_claimed.fetch_add(1, std::memory_order_relaxed);
+  if (slot >= MAX_TASKS) return;
+  s_tasks[slot].handle = static_cast<TaskHandle_t>(task);
+  s_tasks[slot].name = name;
+  int expected = slot;
+  while (!s_task_count.compare_exchange_strong(expected, slot + 1, std::memory_order_release,
+                                               std::memory_order_relaxed)) {
+    expected = slot;
+    vTaskDelay(1);   // lets a lower-priority writer of the slot before finish
+  }
+}
+
+void mem_report(void (*out)(const char *line, void *ctx), void *ctx)
+{
+  char line[80];
+  size_t total = 0;
+  for (const RamAccount *a = s_accounts; a; a = a->next) {
+    snprintf(line, sizeof(line), "static %-14s %6u B", a->name, (unsigned)a->bytes);
+    out(line, ctx);
+    total += a->bytes;
+  }
+  snprintf(line, sizeof(line), "static %-14s %6u B", "(tracked)", (unsigned)total);
+  out(line, ctx);
+
+  // ESP-IDF reports stack high-water marks in bytes
+  const int tasks = s_task_count.load(std::memory_order_acquire);
+  for (int i = 0; i < tasks; ++i) {
+    snprintf(line, sizeof(line), "stack  %-14s %6u B never used", s_tasks[i].name,
+             (unsigned)uxTaskGetStackHighWaterMark(s_tasks[i].handle));
+    out(line, ctx);
+  }
+
+  const Arena &arena = effect_arena();
+  snprintf(line, sizeof(line), "arena  %u/%u B, peak %u, %u failed borrows", (unsigned)arena.used(),
+           (unsigned)arena.capacity(), (unsigned)arena.high_water(), (unsigned)arena.failures());
+  out(line, ctx);
+  snprintf(line, sizeof(line), "heap   %u B free, %u B minimum", (unsigned)esp_get_free_heap_size(),
+           (unsigned)esp_get_minimum_free_heap_size());
+  out(line, ctx);
+}
+
+void mem_report_log()
+{
+  mem_report([](const char *line, void *) { ESP_LOGI(TAG_MEM, "%s", line); }, nullptr);
+}
+
+void mem_report_stacks(void (*fn)(const char *name, unsigned free_bytes, void *ctx), void *ctx)
+{
+  const int tasks = s_task_count.load(std::memory_order_acquire);
+  for (int i = 0; i < tasks; ++i)
+    fn(s_tasks[i].name, (unsigned)uxTaskGetStackHighWaterMark(s_tasks[i].handle), ctx);
+}
@@ -0,0 +1,27 @@
+// Memory budget report: static RAM per subsystem, task stack high-water
+// marks and heap. For a per-object breakdown from the linker map, build
+// the `ram_report` target (see top-level CMakeLists.txt).
+#pragma once
+
+#include <cstddef>
+
+// Registers a subsystem's statically allocated bytes at startup
+struct RamAccount {
+  RamAccount(const char *name, size_t bytes);
+  const char *name;
+  size_t      bytes;
+  RamAccount *next;
+};
+
+#define RAM_ACCOUNT(id, name, bytes) static RamAccount ram_account_##id(name, bytes)
+
+// Adds a FreeRTOS task (TaskHandle_t) to the stack report
+void mem_report_track_task(void *task, const char *name);
+
+// The full report as text lines (no newline), for callers with their own
+// output such as the console; mem_report_log() sends them to the MEM log
+void mem_report(void (*out)(const char *line, void *ctx), void *ctx);
+void mem_report_log();
+
+// Tracked tasks' unused stack bytes
+void mem_report_stacks(void (*fn)(const char *name, unsigned free_bytes, void *ctx), void *ctx);
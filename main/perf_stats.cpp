@@ -0,0 +1,77 @@
+#include "perf_stats.hpp"
+#include "rect_merge.hpp"   // WINDOW_CMD_BYTES
+#include <algorithm>
+
+void PerfCounters::frame(int64_t now_us, uint32_t cost_us, uint32_t windows, uint32_t pixels, int game)
+{
+  if (reset_req_.exchange(false, std::memory_order_relaxed)) {
+    cost_ = {};
+    frames_ = 0;
+    win_start_us_ = -1;
+  }
+  if (win_start_us_ < 0) {
+    win_start_us_ = now_us;
+    win_frames_ = win_windows_ = win_touches_ = 0;
+    win_bytes_ = 0;
+  }
+
+  cost_.add(cost_us);
+  ++frames_;
+  ++win_frames_;
+  win_windows_ += windows;
+  win_bytes_ += (uint64_t)pixels * 2 + (uint64_t)windows * WINDOW_CMD_BYTES;
+
+  const int64_t span = now_us - win_start_us_;
+  if (span < WINDOW_US) return;
+
+  PerfSnapshot s;
+  s.at_us = now_us;
+  s.game = (int8_t)game;
+  s.frames = frames_;
+  // Bucket upper bounds can overshoot the largest sample
+  s.cost_max_us = cost_.max_us;
+  s.cost_p50_us = std::min(cost_.percentile(50), s.cost_max_us);
+  s.cost_p90_us = std::min(cost_.percentile(90), s.cost_max_us);
+  s.cost_p99_us = std::min(cost_.percentile(99), s.cost_max_us);
+  s.fps_x10 = (uint32_t)((int64_t)win_frames_ * 10000000 / span);
+  s.windows_x10 = win_windows_ * 10 / win_frames_;
+  s.bytes = (uint32_t)(win_bytes_ / win_frames_);
+  s.touches_x10 = (uint32_t)((int64_t)win_touches_ * 10000000 / span);
+  s.particles = particles_;
+  s.ripples = ripples_;
+  publish(s);
+  win_start_us_ = -1;
+}
+
+void PerfCounters::publish(const PerfSnapshot &s)
+{
+  const uint32_t seq = seq_.load(std::memory_order_relaxed);
+  seq_.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  snap_ = s;
+  seq_.store(seq + 2, std::memory_order_release);
+}
+
+bool PerfCounters::read(PerfSnapshot &out) const
+{
+  for (int tries = 0; tries < 4; ++tries) {
+    const uint32_t before = seq_.load(std::memory_order_acquire);
+    if (before & 1) continue;
+    out = snap_;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (seq_.load(std::memory_order_relaxed) == before) return before != 0;
+  }
+  return false;
+}
+
+void perf_print(const PerfSnapshot &s, Console &con)
+{
+  con.printf("game %d, %u frames since reset\r\n", s.game + 1, (unsigned)s.frames);
+  con.printf("fps %u.%u   frame work p50/p90/p99/max %u/%u/%u/%u us\r\n",
+             (unsigned)(s.fps_x10 / 10), (unsigned)(s.fps_x10 % 10), (unsigned)s.cost_p50_us,
+             (unsigned)s.cost_p90_us, (unsigned)s.cost_p99_us, (unsigned)s.cost_max_us);
+  con.printf("draw %u.%u windows/frame, %u B/frame   touch %u.%u/s\r\n",
+             (unsigned)(s.windows_x10 / 10), (unsigned)(s.windows_x10 % 10), (unsigned)s.bytes,
+             (unsigned)(s.touches_x10 / 10), (unsigned)(s.touches_x10 % 10));
+  con.printf("effects %u particles, %u ripples\r\n", (unsigned)s.particles, (unsigned)s.ripples);
+}
@@ -0,0 +1,56 @@
+// Live performance counters (no ESP-IDF deps). Only the render loop
+// writes; it publishes a snapshot once per window through a seqlock, so
+// console readers on other tasks never block or slow a frame.
+#pragma once
+
+#include "console.hpp"
+#include "latency.hpp"   // LatHistogram
+#include <atomic>
+#include <cstdint>
+
+struct PerfSnapshot {
+  int64_t  at_us;                     // when published
+  int8_t   game;
+  uint32_t frames;                    // since reset
+  uint32_t cost_p50_us, cost_p90_us, cost_p99_us, cost_max_us;   // frame work, since reset
+  // Over the last window
+  uint32_t fps_x10;
+  uint32_t windows_x10;               // panel windows (draw calls) per frame
+  uint32_t bytes;                     // SPI bytes per frame
+  uint32_t touches_x10;               // touch-down events per second
+  uint16_t particles, ripples;        // active at publication
+};
+
+class PerfCounters {
+public:
+  static constexpr int64_t WINDOW_US = 1000000;
+
+  // ---- Render loop only ----
+  // `windows`/`pixels` are this frame's flush
+  void frame(int64_t now_us, uint32_t cost_us, uint32_t windows, uint32_t pixels, int game);
+  void touch_event() { ++win_touches_; }
+  void effects(int particles, int ripples) { particles_ = (uint16_t)particles; ripples_ = (uint16_t)ripples; }
+
+  // ---- Any task ----
+  // Applied by the render loop at its next frame
+  void request_reset() { reset_req_.store(true, std::memory_order_relaxed); }
+  // False before the first publication, or if the writer kept
+  // publishing through every retry
+  bool read(PerfSnapshot &out) const;
+
+private:
+  void publish(const PerfSnapshot &s);
+
+  LatHistogram cost_ = {};
+  uint32_t frames_ = 0;
+  int64_t  win_start_us_ = -1;
+  uint32_t win_frames_ = 0, win_windows_ = 0, win_touches_ = 0;
+  uint64_t win_bytes_ = 0;
+  uint16_t particles_ = 0, ripples_ = 0;
+
+  std::atomic<bool>     reset_req_{false};
+  std::atomic<uint32_t> seq_{0};      // odd while a publish is in progress
+  PerfSnapshot          snap_ = {};
+};
+
+void perf_print(const PerfSnapshot &s, Console &con);
@@ -0,0 +1,54 @@
+#include "quality.hpp"
+
+QualityGovernor::QualityGovernor(uint32_t budget_us, int tier)
+  : budget_us_(budget_us), calm_us_(budget_us * CALM_PCT / 100), tier_(tier)
+{
+}
+
+bool QualityGovernor::frame(uint32_t work_us)
+{
+  if (filled_ == WINDOW) {
+    over_ -= cls_[pos_] & 1;
+    calm_ -= cls_[pos_] >> 1;
+  } else {
+    ++filled_;
+  }
+  const uint8_t c = (work_us > budget_us_ ? 1 : 0) | (work_us <= calm_us_ ? 2 : 0);
+  cls_[pos_] = c;
+  over_ += c & 1;
+  calm_ += c >> 1;
+  pos_ = (pos_ + 1) % WINDOW;
+  ++since_change_;
+
+  // A step up that has held through probation was a good one
+  if (last_up_ && since_change_ == PROBATION) up_hold_ = UP_HOLD;
+  if (pinned_) return false;
+
+  if (over_ >= DOWN_OVER && since_change_ >= DOWN_HOLD && tier_ > 0) {
+    if (last_up_ && since_change_ < PROBATION) up_hold_ = up_hold_ * 2 > UP_HOLD_MAX ? UP_HOLD_MAX : up_hold_ * 2;
+    change(tier_ - 1);
+    last_up_ = false;
+    return true;
+  }
+  if (filled_ == WINDOW && calm_ == WINDOW && since_change_ >= up_hold_ && tier_ < QUALITY_TIER_COUNT - 1) {
+    change(tier_ + 1);
+    last_up_ = true;
+    return true;
+  }
+  return false;
+}
+
+void QualityGovernor::pin(int tier)
+{
+  pinned_ = tier >= 0;
+  if (pinned_) change(tier < QUALITY_TIER_COUNT ? tier : QUALITY_TIER_COUNT - 1);
+  last_up_ = false;
+}
+
+// The old window describes the old tier's cost; start measuring afresh
+void QualityGovernor::change(int tier)
+{
+  tier_ = tier;
+  filled_ = pos_ = over_ = calm_ = 0;
+  since_change_ = 0;
+}
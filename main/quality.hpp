@@ -0,0 +1,64 @@
+// Effect-quality governor (no ESP-IDF deps). Watches a rolling window of
+// per-frame work time and moves between quality tiers: down quickly when
+// frames run over budget, up slowly once the whole window is well under it.
+// An up-step that gets undone soon after doubles the wait before the next
+// attempt, so a tier that only just fits is not retried every window.
+#pragma once
+
+#include <cstdint>
+
+struct QualityTier {
+  uint8_t burst;               // particles per spawn_particles call
+  uint8_t ring_thickness;      // ripple ring width, px
+  uint8_t life_min, life_max;  // particle lifetime, frames
+};
+
+constexpr QualityTier QUALITY_TIERS[] = {
+  {  6, 1,  8, 12 },
+  { 12, 1, 10, 16 },
+  { 24, 2, 14, 22 },   // the fixed settings before the governor
+  { 32, 3, 18, 26 },
+  { 40, 3, 22, 30 },
+};
+constexpr int QUALITY_TIER_COUNT = sizeof(QUALITY_TIERS) / sizeof(QUALITY_TIERS[0]);
+constexpr int QUALITY_DEFAULT_TIER = 2;
+
+class QualityGovernor {
+public:
+  static constexpr int WINDOW     = 32;   // frames
+  static constexpr int DOWN_OVER  = 2;    // frames over budget in the window that force a step down
+  static constexpr int DOWN_HOLD  = WINDOW / 2;    // effects spawned at the old tier take this long to fade
+  static constexpr int CALM_PCT   = 70;   // a frame under this % of budget counts as headroom
+  static constexpr int UP_HOLD    = 2 * WINDOW;    // calm frames before stepping up
+  static constexpr int UP_HOLD_MAX = 16 * WINDOW;
+  static constexpr int PROBATION  = 4 * WINDOW;    // an up-step undone within this backs off
+
+  explicit QualityGovernor(uint32_t budget_us, int tier = QUALITY_DEFAULT_TIER);
+
+  // Once per frame with the frame's work time; true when the tier changed
+  bool frame(uint32_t work_us);
+
+  // Fixes the tier (-1 returns to automatic control)
+  void pin(int tier);
+
+  int  tier() const { return tier_; }
+  bool pinned() const { return pinned_; }
+  const QualityTier &params() const { return QUALITY_TIERS[tier_]; }
+  uint32_t budget_us() const { return budget_us_; }
+  // Window counts as of the last frame
+  int over() const { return over_; }
+  int calm() const { return calm_; }
+
+private:
+  void change(int tier);
+
+  uint32_t budget_us_, calm_us_;
+  int      tier_;
+  bool     pinned_ = false;
+  uint8_t  cls_[WINDOW] = {};   // per frame: bit 0 over budget, bit 1 calm
+  int      pos_ = 0, filled_ = 0;
+  int      over_ = 0, calm_ = 0;
+  int      since_change_ = 0;
+  bool     last_up_ = false;
+  int      up_hold_ = UP_HOLD;
+};
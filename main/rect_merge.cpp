@@ -0,0 +1,59 @@
+#include "rect_merge.hpp"
+#include <algorithm>
+
+Rect rect_unite(const Rect &a, const Rect &b)
+{
+  int x0 = std::min(a.x, b.x), y0 = std::min(a.y, b.y);
+  int x1 = std::max(a.x + a.w, b.x + b.w), y1 = std::max(a.y + a.h, b.y + b.h);
+  return { (int16_t)x0, (int16_t)y0, (int16_t)(x1 - x0), (int16_t)(y1 - y0) };
+}
+
+bool rect_clip(Rect &r, int w, int h)
+{
+  int x0 = std::max<int>(r.x, 0), y0 = std::max<int>(r.y, 0);
+  int x1 = std::min<int>(r.x + r.w, w), y1 = std::min<int>(r.y + r.h, h);
+  if (x1 <= x0 || y1 <= y0) return false;
+  r = { (int16_t)x0, (int16_t)y0, (int16_t)(x1 - x0), (int16_t)(y1 - y0) };
+  return true;
+}
+
+bool rect_clip(Rect &r, const Rect &area)
+{
+  int x0 = std::max(r.x, area.x), y0 = std::max(r.y, area.y);
+  int x1 = std::min(r.x + r.w, area.x + area.w), y1 = std::min(r.y + r.h, area.y + area.h);
+  if (x1 <= x0 || y1 <= y0) return false;
+  r = { (int16_t)x0, (int16_t)y0, (int16_t)(x1 - x0), (int16_t)(y1 - y0) };
+  return true;
+}
+
+static inline int32_t area(const Rect &r) { return (int32_t)r.w * r.h; }
+
+int rect_merge(Rect *r, int n, int window_cost, int band_px)
+{
+  auto cost = [=](const Rect &a) { return area(a) + (int32_t)rect_windows(a, band_px) * window_cost; };
+  // Sorted by top edge, a candidate more than `window_cost` rows below the
+  // current rectangle can never pay off: the gap alone costs that much, and
+  // banding saves at most one window (the pair's partial bands)
+  bool changed = true;
+  while (changed && n > 1) {
+    changed = false;
+    std::sort(r, r + n, [](const Rect &a, const Rect &b) { return a.y < b.y; });
+    for (int i = 0; i < n; ++i) {
+      if (r[i].w == 0) continue;
+      for (int j = i + 1; j < n; ++j) {
+        if (r[j].w == 0) continue;
+        if (r[j].y > r[i].y + r[i].h + window_cost) break;
+        Rect u = rect_unite(r[i], r[j]);
+        if (cost(u) <= cost(r[i]) + cost(r[j])) {
+          r[i] = u;
+          r[j].w = 0;       // tombstone, compacted below
+          changed = true;
+        }
+      }
+    }
+    int k = 0;
+    for (int i = 0; i < n; ++i) if (r[i].w) r[k++] = r[i];
+    n = k;
+  }
+  return n;
+}
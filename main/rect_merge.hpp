@@ -0,0 +1,52 @@
+// Dirty-rectangle coalescing for the panel's window-per-transfer cost model
+// (no ESP-IDF deps)
+#pragma once
+
+#include <cstdint>
+
+struct Rect {
+  int16_t x, y, w, h;
+};
+
+inline bool rect_overlaps(const Rect &a, const Rect &b)
+{
+  return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+}
+
+Rect rect_unite(const Rect &a, const Rect &b);
+
+// Clip to [0,w) x [0,h); false when nothing is left
+bool rect_clip(Rect &r, int w, int h);
+// Clip to `area`; false when nothing is left
+bool rect_clip(Rect &r, const Rect &area);
+
+// Every window costs a CASET/RASET/RAMWR sequence plus a queued transaction,
+// worth about this many pixels of payload at 40 MHz
+constexpr int WINDOW_COST_PX = 64;
+// Command and argument bytes of one such sequence
+constexpr int WINDOW_CMD_BYTES = 11;
+
+// Rows of `r` that fit in one band buffer of `band_px` pixels (0: no band
+// limit, the whole rectangle)
+inline int rect_band_rows(const Rect &r, int band_px)
+{
+  if (band_px <= 0 || r.w <= 0) return r.h;
+  const int rows = band_px / r.w;
+  return rows < 1 ? 1 : rows < r.h ? rows : r.h;
+}
+
+// Windows `r` goes out as when it is composed and sent band by band
+inline int rect_windows(const Rect &r, int band_px)
+{
+  if (r.w <= 0 || r.h <= 0) return 0;
+  const int rows = rect_band_rows(r, band_px);
+  return (r.h + rows - 1) / rows;
+}
+
+// Merge pairs of rectangles in place while their bounding rectangle costs no
+// more than the two sent separately, counting its pixels plus `window_cost`
+// per window it is sent as (rect_windows with `band_px`). A pair whose
+// bounding box is mostly empty stays apart even when they touch: 100x1 and
+// 1x100 at a corner would send 10000 pixels for 200. Returns the new count;
+// order is not kept.
+int rect_merge(Rect *r, int n, int window_cost = WINDOW_COST_PX, int band_px = 0);
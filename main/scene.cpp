@@ -0,0 +1,386 @@
+#include "scene.hpp"
+#include "blend565.hpp"
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+static int isqrt(int v)
+{
+  if (v <= 0) return 0;
+  int r = 0;
+  for (int bit = 1 << 14; bit; bit >>= 1) if ((r + bit) * (r + bit) <= v) r += bit;
+  return r;
+}
+
+Scene::Scene(lgfx::LovyanGFX &gfx) : gfx_(gfx), band_{ lgfx::LGFX_Sprite(&gfx), lgfx::LGFX_Sprite(&gfx) } {}
+
+void Scene::set_view(int v, int x, int y, int w, int h)
+{
+  if (v <= 0 || v >= MAX_VIEWS) return;
+  views_[v].area = { (int16_t)x, (int16_t)y, (int16_t)w, (int16_t)h };
+}
+
+void Scene::select_view(int v) { view_ = (v > 0 && v < MAX_VIEWS) ? (uint8_t)v : 0; }
+
+void Scene::reset(uint16_t bg_color, BackgroundFn pattern)
+{
+  if (view_) {
+    View &v = views_[view_];
+    for (auto &n : nodes_) if (n.view == view_) n.kind = KIND_NONE;
+    v.bg_color = bg_color;
+    v.bg_pattern = pattern;
+    v.live = true;
+    mark_rect(v.area);
+    return;
+  }
+  for (auto &n : nodes_) n.kind = KIND_NONE;
+  for (auto &v : views_) v.live = false;
+  bg_color_ = bg_color;
+  bg_pattern_ = pattern;
+  dirty_count_ = 0;
+  full_redraw_ = true;
+}
+
+int Scene::alloc(Layer l, uint8_t kind)
+{
+  for (int i = 0; i < MAX_NODES; ++i) if (nodes_[i].kind == KIND_NONE) {
+    Node &n = nodes_[i];
+    std::memset(&n, 0, sizeof(n));
+    n.kind = kind; n.layer = l; n.visible = true; n.alpha = 255; n.view = view_;
+    return i;
+  }
+  return -1;
+}
+
+Scene::Node *Scene::get(int h)
+{
+  if (h < 0 || h >= MAX_NODES || nodes_[h].kind == KIND_NONE) return nullptr;
+  return &nodes_[h];
+}
+
+int Scene::add_rect(Layer l, int x, int y, int w, int h, uint16_t color)
+{
+  int id = alloc(l, KIND_RECT);
+  if (id < 0) return -1;
+  Node &n = nodes_[id];
+  n.x = x + views_[view_].area.x; n.y = y + views_[view_].area.y;
+  n.w = w; n.h = h; n.color = color;
+  mark(n);
+  return id;
+}
+
+int Scene::add_circle(Layer l, int cx, int cy, int r, uint16_t color)
+{
+  int id = alloc(l, KIND_CIRCLE);
+  if (id < 0) return -1;
+  Node &n = nodes_[id];
+  n.x = cx + views_[view_].area.x; n.y = cy + views_[view_].area.y;
+  n.w = r; n.color = color;
+  mark(n);
+  return id;
+}
+
+int Scene::add_ring(Layer l, int cx, int cy, int r, int thickness, uint16_t color)
+{
+  int id = alloc(l, KIND_RING);
+  if (id < 0) return -1;
+  Node &n = nodes_[id];
+  n.x = cx + views_[view_].area.x; n.y = cy + views_[view_].area.y;
+  n.w = r; n.h = thickness; n.color = color;
+  mark(n);
+  return id;
+}
+
+int Scene::add_panel(Layer l, int x, int y, int w, int h, int radius, uint16_t fill, uint16_t border)
+{
+  int id = alloc(l, KIND_PANEL);
+  if (id < 0) return -1;
+  Node &n = nodes_[id];
+  n.x = x + views_[view_].area.x; n.y = y + views_[view_].area.y;
+  n.w = w; n.h = h; n.aux = radius; n.color = fill; n.color2 = border;
+  mark(n);
+  return id;
+}
+
+int Scene::add_text(Layer l, int x, int y, int size, uint16_t color, const char *text)
+{
+  int id = alloc(l, KIND_TEXT);
+  if (id < 0) return -1;
+  Node &n = nodes_[id];
+  n.x = x + views_[view_].area.x; n.y = y + views_[view_].area.y;
+  n.aux = size; n.color = color;
+  set_text(id, "%s", text);   // sizes and marks the node
+  return id;
+}
+
+void Scene::remove(int h)
+{
+  Node *n = get(h);
+  if (!n) return;
+  mark(*n);
+  n->kind = KIND_NONE;
+}
+
+void Scene::move(int h, int x, int y)
+{
+  Node *n = get(h);
+  if (!n) return;
+  x += views_[n->view].area.x; y += views_[n->view].area.y;
+  if (n->x == x && n->y == y) return;
+  mark(*n);
+  n->x = x; n->y = y;
+  mark(*n);
+}
+
+void Scene::set_radius(int h, int r)
+{
+  Node *n = get(h);
+  if (!n || n->w == r) return;
+  if (n->kind == KIND_RING && n->visible) {
+    // One annulus spanning both the old and the new ring
+    int outer = std::max<int>(n->w, r);
+    int inner = std::min<int>(n->w, r) - n->h;
+    Node span = *n;
+    span.w = outer; span.h = outer - inner;
+    mark_ring(span);
+    n->w = r;
+    return;
+  }
+  mark(*n);
+  n->w = r;
+  mark(*n);
+}
+
+void Scene::set_colors(int h, uint16_t color, uint16_t color2)
+{
+  Node *n = get(h);
+  if (!n || (n->color == color && n->color2 == color2)) return;
+  n->color = color; n->color2 = color2;
+  mark(*n);
+}
+
+void Scene::set_visible(int h, bool visible)
+{
+  Node *n = get(h);
+  if (!n || n->visible == visible) return;
+  n->visible = true;   // mark() skips hidden nodes
+  mark(*n);
+  n->visible = visible;
+}
+
+void Scene::set_alpha(int h, uint8_t alpha)
+{
+  Node *n = get(h);
+  if (!n || n->alpha == alpha) return;
+  n->alpha = alpha;
+  mark(*n);
+}
+
+void Scene::set_text(int h, const char *fmt, ...)
+{
+  va_list ap;
+  va_start(ap, fmt);
+  set_text_v(h, fmt, ap);
+  va_end(ap);
+}
+
+void Scene::set_text_v(int h, const char *fmt, va_list ap)
+{
+  Node *n = get(h);
+  if (!n || n->kind != KIND_TEXT) return;
+  char buf[TEXT_LEN];
+  vsnprintf(buf, sizeof(buf), fmt, ap);
+  if (std::strcmp(buf, n->text) == 0) return;
+  mark(*n);
+  std::memcpy(n->text, buf, sizeof(buf));
+  // Font0 is a fixed 6x8 cell
+  n->w = (int16_t)(std::strlen(n->text) * 6 * n->aux);
+  n->h = (int16_t)(8 * n->aux);
+  mark(*n);
+}
+
+Rect Scene::bounds(const Node &n) const
+{
+  switch (n.kind) {
+    case KIND_CIRCLE:
+    case KIND_RING:
+      return { (int16_t)(n.x - n.w - 1), (int16_t)(n.y - n.w - 1), (int16_t)(2 * n.w + 3), (int16_t)(2 * n.w + 3) };
+    default:
+      return { n.x, n.y, n.w, n.h };
+  }
+}
+
+void Scene::mark(const Node &n)
+{
+  if (!n.visible) return;
+  if (n.kind == KIND_RING) mark_ring(n);
+  else mark_rect(bounds(n), n.view);
+}
+
+void Scene::mark_rect(const Rect &area, int view)
+{
+  if (full_redraw_ || area.w <= 0 || area.h <= 0) return;
+  Rect r = area;
+  if (view && !rect_clip(r, views_[view].area)) return;
+  if (dirty_count_ == MAX_DIRTY) {
+    // Out of slots: grow the last region rather than dropping the repaint
+    dirty_[MAX_DIRTY - 1] = rect_unite(dirty_[MAX_DIRTY - 1], r);
+    return;
+  }
+  dirty_[dirty_count_++] = r;
+}
+
+void Scene::mark_ring(const Node &n)
+{
+  // A ring only covers a thin annulus, so mark it as bands of rows split
+  // around the hole instead of dirtying its whole bounding box.
+  constexpr int BAND = 8;
+  const int r  = n.w + 1;               // one pixel of slack for the raster
+  const int ri = n.w - n.h;             // pixels nearer than this are untouched
+  for (int y0 = -r; y0 <= r; y0 += BAND) {
+    int y1 = std::min(y0 + BAND - 1, r);
+    int outer = 0, hole = 1 << 14;
+    for (int dy = y0; dy <= y1; ++dy) {
+      outer = std::max(outer, isqrt(r * r - dy * dy) + 1);
+      hole  = std::min(hole, (dy * dy < ri * ri) ? isqrt(ri * ri - dy * dy) - 1 : 0);
+    }
+    const int16_t ry = (int16_t)(n.y + y0), rh = (int16_t)(y1 - y0 + 1);
+    if (hole <= 0) {
+      mark_rect({ (int16_t)(n.x - outer), ry, (int16_t)(2 * outer + 1), rh }, n.view);
+    } else {
+      int16_t w = (int16_t)(outer - hole + 1);
+      mark_rect({ (int16_t)(n.x - outer), ry, w, rh }, n.view);
+      mark_rect({ (int16_t)(n.x + hole),  ry, w, rh }, n.view);
+    }
+  }
+}
+
+void Scene::draw(lgfx::LovyanGFX &dst, const Node &n, int ox, int oy)
+{
+  const int x = n.x - ox, y = n.y - oy;
+  switch (n.kind) {
+    case KIND_RECT:
+      dst.fillRect(x, y, n.w, n.h, n.color);
+      break;
+    case KIND_CIRCLE:
+      dst.fillCircle(x, y, n.w, n.color);
+      break;
+    case KIND_RING:
+      for (int k = 0; k < n.h && n.w - k > 0; ++k) dst.drawCircle(x, y, n.w - k, n.color);
+      break;
+    case KIND_PANEL:
+      dst.fillRoundRect(x, y, n.w, n.h, n.aux, n.color);
+      dst.drawRoundRect(x, y, n.w, n.h, n.aux, n.color2);
+      break;
+    case KIND_TEXT:
+      dst.setFont(&fonts::Font0);
+      dst.setTextSize(n.aux);
+      dst.setTextColor(n.color);
+      dst.setCursor(x, y);
+      dst.print(n.text);
+      break;
+    default:
+      break;
+  }
+}
+
+void Scene::draw_blended(uint16_t *buf, const Rect &strip, const Rect &clip, const Node &n)
+{
+  // Span rasteriser straight into the band buffer; LGFX primitives only
+  // overwrite. Rings are the pixels between radius n.w - n.h and n.w.
+  const int x_lo = clip.x, x_hi = clip.x + clip.w - 1;
+  auto span = [&](int y, int x0, int x1) {
+    x0 = std::max(x0, x_lo); x1 = std::min(x1, x_hi);
+    if (x0 <= x1) blend565_span_be(buf + (y - strip.y) * strip.w + (x0 - strip.x), x1 - x0 + 1, n.color, n.alpha);
+  };
+  int y0, y1;
+  if (n.kind == KIND_RECT) {
+    y0 = std::max<int>(n.y, clip.y); y1 = std::min(n.y + n.h, clip.y + clip.h) - 1;
+    for (int y = y0; y <= y1; ++y) span(y, n.x, n.x + n.w - 1);
+    return;
+  }
+  const int r = n.w, ri = (n.kind == KIND_RING) ? n.w - n.h : -1;
+  y0 = std::max(n.y - r, (int)clip.y); y1 = std::min(n.y + r, clip.y + clip.h - 1);
+  for (int y = y0; y <= y1; ++y) {
+    const int dy = y - n.y;
+    const int outer = isqrt(r * r - dy * dy);
+    if (ri < 0 || dy * dy > ri * ri) { span(y, n.x - outer, n.x + outer); continue; }
+    const int hole = isqrt(ri * ri - dy * dy);
+    span(y, n.x - outer, n.x - hole - 1);
+    span(y, n.x + hole + 1, n.x + outer);
+  }
+}
+
+void Scene::compose(const Rect &r)
+{
+  // Windows wider than a band buffer cannot occur: BAND_PIXELS covers a
+  // full row in either orientation
+  const int rows = rect_band_rows(r, BAND_PIXELS);
+  for (int y0 = r.y; y0 < r.y + r.h; y0 += rows) {
+    const Rect strip = { r.x, (int16_t)y0, r.w, (int16_t)std::min(rows, r.y + r.h - y0) };
+    lgfx::LGFX_Sprite &spr = band_[band_next_];
+    // Composing here overlaps the DMA still sending the other buffer
+    spr.setBuffer(band_buf_[band_next_], strip.w, strip.h, 16);
+    if (bg_pattern_) bg_pattern_(spr, strip.x, strip.y, strip.x, strip.y, strip.w, strip.h);
+    else spr.fillRect(0, 0, strip.w, strip.h, bg_color_);
+    for (int v = 1; v < MAX_VIEWS; ++v) {
+      Rect c = views_[v].area;
+      if (!views_[v].live || !rect_clip(c, strip)) continue;
+      spr.setClipRect(c.x - strip.x, c.y - strip.y, c.w, c.h);
+      if (views_[v].bg_pattern) views_[v].bg_pattern(spr, strip.x, strip.y, c.x, c.y, c.w, c.h);
+      else spr.fillRect(c.x - strip.x, c.y - strip.y, c.w, c.h, views_[v].bg_color);
+      spr.clearClipRect();
+    }
+    for (int l = 0; l < LAYER_COUNT; ++l)
+      for (const Node &n : nodes_) {
+        if (n.kind == KIND_NONE || n.layer != l || !n.visible || !n.alpha) continue;
+        const Rect b = bounds(n);
+        Rect clip = strip;
+        if (!rect_overlaps(b, strip) || (n.view && !rect_clip(clip, views_[n.view].area))) continue;
+        if (n.alpha < 255 && (n.kind == KIND_RECT || n.kind == KIND_CIRCLE || n.kind == KIND_RING)) {
+          draw_blended(band_buf_[band_next_], strip, clip, n);
+        } else if (clip.w == strip.w && clip.h == strip.h) {
+          draw(spr, n, strip.x, strip.y);
+        } else {
+          spr.setClipRect(clip.x - strip.x, clip.y - strip.y, clip.w, clip.h);
+          draw(spr, n, strip.x, strip.y);
+          spr.clearClipRect();
+        }
+      }
+    gfx_.waitDMA();
+    gfx_.pushImageDMA(strip.x, strip.y, strip.w, strip.h,
+                      static_cast<const lgfx::swap565_t *>(spr.getBuffer()));
+    band_next_ ^= 1;
+    stats_.windows++;
+    stats_.pixels += (uint32_t)strip.w * strip.h;
+  }
+}
+
+void Scene::flush()
+{
+  const int sw = gfx_.width(), sh = gfx_.height();
+  gfx_.startWrite();
+  if (full_redraw_) {
+    compose({ 0, 0, (int16_t)sw, (int16_t)sh });
+    full_redraw_ = false;
+  } else {
+    int n = 0;
+    for (int i = 0; i < dirty_count_; ++i)
+      if (rect_clip(dirty_[i], sw, sh)) dirty_[n++] = dirty_[i];
+    stats_.dirty_rects += n;
+    n = rect_merge(dirty_, n, WINDOW_COST_PX, BAND_PIXELS);
+    for (int i = 0; i < n; ++i) compose(dirty_[i]);
+  }
+  dirty_count_ = 0;
+  gfx_.waitDMA();   // the band buffers are reused next frame
+  gfx_.endWrite();
+}
+
+void SceneView::set_text(int h, const char *fmt, ...)
+{
+  va_list ap;
+  va_start(ap, fmt);
+  s_->set_text_v(h, fmt, ap);
+  va_end(ap);
+}
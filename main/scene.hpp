@@ -0,0 +1,165 @@
+// Z-ordered retained scene. Moving, changing or removing a node marks the
+// area it covered as dirty; flush() coalesces the dirty areas into as few
+// panel windows as pays off, composes each one off-screen from the
+// background up through every layer, and sends it as a single DMA burst,
+// so erasing one object never damages another. Views split the panel into
+// areas that each clip their own nodes, so several games can share it.
+#pragma once
+
+#ifndef LGFX_USE_V1
+#define LGFX_USE_V1
+#endif
+
+#include "lgfx_setup.hpp"
+#include "rect_merge.hpp"
+#include <cstdarg>
+#include <cstdint>
+
+enum Layer : uint8_t {
+  LAYER_BACKGROUND = 0,   // static decor above the background fill
+  LAYER_PLAY,             // balls, targets, grid cells
+  LAYER_EFFECTS,          // particles, ripples
+  LAYER_HUD,              // title bar, buttons, status text
+  LAYER_COUNT
+};
+
+// Paints the screen region (x, y, w, h) into `dst`, whose pixel (0, 0) is
+// screen (ox, oy); `dst` already clips to the region
+using BackgroundFn = void (*)(lgfx::LovyanGFX &dst, int ox, int oy, int x, int y, int w, int h);
+
+// Flush counters since boot; one window is one CASET/RASET/RAMWR sequence.
+// Readers keep their own previous copy and diff.
+struct FlushStats {
+  uint32_t dirty_rects;   // before coalescing
+  uint32_t windows;
+  uint32_t pixels;
+};
+
+class Scene {
+public:
+  static constexpr int MAX_NODES = 96;
+  static constexpr int MAX_DIRTY = 256;
+  static constexpr int TEXT_LEN  = 32;
+  // Compose buffer per DMA burst; two so one fills while the other is sent
+  static constexpr int BAND_PIXELS = 320 * 16;
+  // View 0 is the whole panel; the others are split-screen areas
+  static constexpr int MAX_VIEWS = 3;
+
+  explicit Scene(lgfx::LovyanGFX &gfx);
+
+  lgfx::LovyanGFX &gfx() { return gfx_; }
+
+  // Gives view `v` (1 .. MAX_VIEWS - 1) the screen area (x, y, w, h)
+  void set_view(int v, int x, int y, int w, int h);
+  // Node factories and reset() that follow work in view `v`: coordinates
+  // are relative to its area and its nodes are clipped to it. Moving or
+  // changing a node later always uses the view it was created in.
+  void select_view(int v);
+
+  // Drop every node of the selected view and repaint its area on the next
+  // flush; in view 0, every node of every view and the whole screen
+  void reset(uint16_t bg_color, BackgroundFn pattern = nullptr);
+
+  // Node factories return a handle, or -1 when the node pool is full
+  int add_rect(Layer l, int x, int y, int w, int h, uint16_t color);
+  int add_circle(Layer l, int cx, int cy, int r, uint16_t color);
+  int add_ring(Layer l, int cx, int cy, int r, int thickness, uint16_t color);
+  int add_panel(Layer l, int x, int y, int w, int h, int radius, uint16_t fill, uint16_t border);
+  int add_text(Layer l, int x, int y, int size, uint16_t color, const char *text);  // Font0 only
+
+  void remove(int h);
+  void move(int h, int x, int y);
+  void set_radius(int h, int r);
+  void set_colors(int h, uint16_t color, uint16_t color2);
+  void set_visible(int h, bool visible);
+  // 255 opaque, 0 invisible; rects, circles and rings blend over what is
+  // underneath, other kinds draw opaque while alpha > 0
+  void set_alpha(int h, uint8_t alpha);
+  void set_text(int h, const char *fmt, ...) __attribute__((format(printf, 3, 4)));
+  void set_text_v(int h, const char *fmt, va_list ap);
+
+  // Repaint everything marked dirty since the last flush
+  void flush();
+
+  const FlushStats &flush_stats() const { return stats_; }
+
+private:
+  enum Kind : uint8_t { KIND_NONE = 0, KIND_RECT, KIND_CIRCLE, KIND_RING, KIND_PANEL, KIND_TEXT };
+
+  struct Node {
+    int16_t  x, y;        // circle/ring: center; others: top-left
+    int16_t  w, h;        // circle/ring: radius, thickness; text: cached extent
+    uint16_t color, color2;
+    uint8_t  kind, layer, aux;   // aux: panel corner radius or text size
+    uint8_t  alpha, view;
+    bool     visible;
+    char     text[TEXT_LEN];
+  };
+
+  struct View {
+    Rect         area;
+    uint16_t     bg_color;
+    BackgroundFn bg_pattern;
+    bool         live;        // painted under its nodes since its reset()
+  };
+
+  int  alloc(Layer l, uint8_t kind);
+  Node *get(int h);
+  Rect bounds(const Node &n) const;
+  void mark(const Node &n);
+  void mark_rect(const Rect &r, int view = 0);
+  void mark_ring(const Node &n);
+  void compose(const Rect &r);
+  void draw(lgfx::LovyanGFX &dst, const Node &n, int ox, int oy);
+  void draw_blended(uint16_t *buf, const Rect &strip, const Rect &clip, const Node &n);
+
+  lgfx::LovyanGFX &gfx_;
+  lgfx::LGFX_Sprite band_[2];
+  int          band_next_ = 0;
+  FlushStats   stats_ = {};
+  Node         nodes_[MAX_NODES] = {};
+  Rect         dirty_[MAX_DIRTY];
+  int          dirty_count_ = 0;
+  bool         full_redraw_ = true;
+  uint16_t     bg_color_ = 0;
+  BackgroundFn bg_pattern_ = nullptr;
+  View         views_[MAX_VIEWS] = {};
+  uint8_t      view_ = 0;   // selected for factories and reset()
+  alignas(4) uint16_t band_buf_[2][BAND_PIXELS];   // internal RAM, DMA-capable
+};
+
+// One game's window onto a shared scene: the Scene calls, in coordinates
+// relative to the view's area
+class SceneView {
+public:
+  SceneView() = default;
+  SceneView(Scene &scene, int view) : s_(&scene), v_((uint8_t)view) {}
+
+  Scene &scene() const { return *s_; }
+  lgfx::LovyanGFX &gfx() const { return s_->gfx(); }
+
+  void reset(uint16_t bg_color, BackgroundFn pattern = nullptr) { s_->select_view(v_); s_->reset(bg_color, pattern); }
+
+  int add_rect(Layer l, int x, int y, int w, int h, uint16_t color)
+  { s_->select_view(v_); return s_->add_rect(l, x, y, w, h, color); }
+  int add_circle(Layer l, int cx, int cy, int r, uint16_t color)
+  { s_->select_view(v_); return s_->add_circle(l, cx, cy, r, color); }
+  int add_ring(Layer l, int cx, int cy, int r, int thickness, uint16_t color)
+  { s_->select_view(v_); return s_->add_ring(l, cx, cy, r, thickness, color); }
+  int add_panel(Layer l, int x, int y, int w, int h, int radius, uint16_t fill, uint16_t border)
+  { s_->select_view(v_); return s_->add_panel(l, x, y, w, h, radius, fill, border); }
+  int add_text(Layer l, int x, int y, int size, uint16_t color, const char *text)
+  { s_->select_view(v_); return s_->add_text(l, x, y, size, color, text); }
+
+  void remove(int h) { s_->remove(h); }
+  void move(int h, int x, int y) { s_->move(h, x, y); }
+  void set_radius(int h, int r) { s_->set_radius(h, r); }
+  void set_colors(int h, uint16_t color, uint16_t color2) { s_->set_colors(h, color, color2); }
+  void set_visible(int h, bool visible) { s_->set_visible(h, visible); }
+  void set_alpha(int h, uint8_t alpha) { s_->set_alpha(h, alpha); }
+  void set_text(int h, const char *fmt, ...) __attribute__((format(printf, 3, 4)));
+
+private:
+  Scene  *s_ = nullptr;
+  uint8_t v_ = 0;
+};
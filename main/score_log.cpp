@@ -0,0 +1,151 @@
+#include "score_log.hpp"
+#include <cstddef>
+#include <cstring>
+
+namespace {
+
+constexpr uint32_t SECTOR_MAGIC = 0x31475348; // "HSG1"
+constexpr uint16_t RECORD_MAGIC = 0x5352;     // "RS"
+
+struct SectorHeader {
+  uint32_t magic;
+  uint32_t generation;
+  uint32_t reserved;
+  uint32_t crc;
+};
+
+struct Record {
+  uint16_t  magic;
+  uint8_t   slot;
+  uint8_t   reserved;
+  uint32_t  seq;
+  GameStats stats;
+  uint32_t  pad;
+  uint32_t  crc;
+};
+
+static_assert(sizeof(Record) == ScoreLog::RECORD_SIZE, "record must fill one slot");
+static_assert(sizeof(SectorHeader) <= ScoreLog::RECORD_SIZE, "header must fit in slot 0");
+
+bool is_erased(const void *p, size_t len)
+{
+  const uint8_t *b = static_cast<const uint8_t *>(p);
+  for (size_t i = 0; i < len; ++i) if (b[i] != 0xFF) return false;
+  return true;
+}
+
+bool header_ok(const SectorHeader &h)
+{
+  return h.magic == SECTOR_MAGIC && h.crc == crc32_le(0, &h, offsetof(SectorHeader, crc));
+}
+
+} // namespace
+
+uint32_t crc32_le(uint32_t crc, const void *data, size_t len)
+{
+  const uint8_t *p = static_cast<const uint8_t *>(data);
+  crc = ~crc;
+  while (len--) {
+    crc ^= *p++;
+    for (int k = 0; k < 8; ++k) crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+  }
+  return ~crc;
+}
+
+bool ScoreLog::load(GameStats out[SCORE_SLOTS])
+{
+  std::memset(out, 0, sizeof(GameStats) * SCORE_SLOTS);
+  active_ = -1; generation_ = 0; seq_ = 0; next_off_ = 0;
+
+  SectorHeader h[2];
+  bool valid[2];
+  for (int s = 0; s < 2; ++s) {
+    if (!flash_.read(s, 0, &h[s], sizeof(h[s]))) return false;
+    valid[s] = header_ok(h[s]);
+  }
+  if (!valid[0] && !valid[1]) return true;
+
+  int pick = valid[0] ? 0 : 1;
+  if (valid[0] && valid[1] && (int32_t)(h[1].generation - h[0].generation) > 0) pick = 1;
+
+  uint32_t max_seq = 0;
+  if (!scan(pick, out, next_off_, max_seq)) return false;
+  active_ = pick;
+  generation_ = h[pick].generation;
+  seq_ = max_seq + 1;
+  return true;
+}
+
+bool ScoreLog::scan(int sector, GameStats out[SCORE_SLOTS], size_t &next_off, uint32_t &max_seq)
+{
+  const size_t end = flash_.sector_size();
+  size_t off = RECORD_SIZE;
+  for (; off + RECORD_SIZE <= end; off += RECORD_SIZE) {
+    Record r;
+    if (!flash_.read(sector, off, &r, sizeof(r))) return false;
+    if (is_erased(&r, sizeof(r))) break;
+    if (r.magic != RECORD_MAGIC || r.slot >= SCORE_SLOTS) continue;
+    if (r.crc != crc32_le(0, &r, offsetof(Record, crc))) continue; // torn write
+    out[r.slot] = r.stats;   // later records supersede earlier ones
+    if ((int32_t)(r.seq - max_seq) > 0) max_seq = r.seq;
+  }
+  next_off = off;
+  return true;
+}
+
+bool ScoreLog::write_record(int sector, size_t off, uint8_t slot, const GameStats &st)
+{
+  Record r;
+  std::memset(&r, 0, sizeof(r));
+  r.magic = RECORD_MAGIC;
+  r.slot  = slot;
+  r.seq   = seq_++;
+  r.stats = st;
+  r.crc   = crc32_le(0, &r, offsetof(Record, crc));
+  return flash_.write(sector, off, &r, sizeof(r));
+}
+
+bool ScoreLog::compact(const GameStats stats[SCORE_SLOTS])
+{
+  const int target = (active_ < 0) ? 0 : 1 - active_;
+  if (!flash_.erase(target)) return false;
+
+  size_t off = RECORD_SIZE;
+  for (int i = 0; i < SCORE_SLOTS; ++i, off += RECORD_SIZE)
+    if (!write_record(target, off, (uint8_t)i, stats[i])) return false;
+
+  // Commit point: until this header lands the previous sector stays authoritative
+  SectorHeader h = {};
+  h.magic = SECTOR_MAGIC;
+  h.generation = generation_ + 1;
+  h.crc = crc32_le(0, &h, offsetof(SectorHeader, crc));
+  if (!flash_.write(target, 0, &h, sizeof(h))) return false;
+
+  active_ = target;
+  generation_ = h.generation;
+  next_off_ = off;
+  return true;
+}
+
+bool ScoreLog::append(const GameStats stats[SCORE_SLOTS], uint32_t mask)
+{
+  size_t need = 0;
+  for (int i = 0; i < SCORE_SLOTS; ++i) if (mask & (1u << i)) need += RECORD_SIZE;
+  if (need == 0) return true;
+
+  if (active_ < 0 || next_off_ + need > flash_.sector_size()) return compact(stats);
+
+  for (int i = 0; i < SCORE_SLOTS; ++i) if (mask & (1u << i)) {
+    // Advance first: a failed write may still have dirtied the slot
+    size_t off = next_off_;
+    next_off_ += RECORD_SIZE;
+    if (!write_record(active_, off, (uint8_t)i, stats[i])) return false;
+  }
+  return true;
+}
+
+size_t ScoreLog::free_slots() const
+{
+  if (active_ < 0) return 0;
+  return (flash_.sector_size() - next_off_) / RECORD_SIZE;
+}
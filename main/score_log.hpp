@@ -0,0 +1,60 @@
+// Append-only, CRC-checked record log for per-game stats (no ESP-IDF deps)
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+constexpr int SCORE_SLOTS = 4;   // games that can own a stats record
+
+struct GameStats {
+  uint32_t best_score;
+  uint32_t sessions;
+  uint32_t total_score;
+  uint32_t total_miss;
+};
+
+// Raw storage under the log: two equally sized, independently erasable
+// sectors used as a ping-pong pair. Erased bytes must read back as 0xFF.
+class FlashBackend {
+public:
+  virtual ~FlashBackend() = default;
+  virtual size_t sector_size() const = 0;
+  virtual bool read(int sector, size_t off, void *dst, size_t len) = 0;
+  virtual bool write(int sector, size_t off, const void *src, size_t len) = 0;
+  virtual bool erase(int sector) = 0;
+};
+
+uint32_t crc32_le(uint32_t crc, const void *data, size_t len);
+
+// Sector layout: [header][record][record]...[0xFF padding]
+// The header is written last during compaction, so a sector only becomes
+// valid once all of its records are on flash. Torn records fail their CRC
+// and are skipped; appends always go to the first fully erased slot.
+class ScoreLog {
+public:
+  static constexpr size_t RECORD_SIZE = 32;
+
+  explicit ScoreLog(FlashBackend &flash) : flash_(flash) {}
+
+  // Scan both sectors and rebuild stats from the newest valid one.
+  // Returns false only on backend errors; an empty flash is a valid log.
+  bool load(GameStats out[SCORE_SLOTS]);
+
+  // Append one record per slot set in `mask`. Compacts into the other
+  // sector when the active one runs out of room.
+  bool append(const GameStats stats[SCORE_SLOTS], uint32_t mask);
+
+  uint32_t generation() const { return generation_; }
+  size_t   free_slots() const;
+
+private:
+  bool scan(int sector, GameStats out[SCORE_SLOTS], size_t &next_off, uint32_t &max_seq);
+  bool write_record(int sector, size_t off, uint8_t slot, const GameStats &st);
+  bool compact(const GameStats stats[SCORE_SLOTS]);
+
+  FlashBackend &flash_;
+  int      active_ = -1;     // -1: nothing formatted yet
+  uint32_t generation_ = 0;
+  uint32_t seq_ = 0;
+  size_t   next_off_ = 0;
+};
@@ -0,0 +1,190 @@
+extern "C" {
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+}
+
+#include "score_store.hpp"
+#include "games.hpp"
+#include "mem_report.hpp"
+#include "dlog.hpp"
+
+static const char *TAG_STORE = "SCORES";
+
+static_assert(GAME_COUNT <= SCORE_SLOTS, "score log has no slot for every game");
+
+// Flush once updates have been quiet this long, or right away on game switch
+static constexpr uint32_t IDLE_FLUSH_MS = 3000;
+static constexpr uint32_t POLL_MS       = 1000;
+
+namespace {
+
+class PartitionFlash : public FlashBackend {
+public:
+  explicit PartitionFlash(const esp_partition_t *p) : part_(p), half_(p->size / 2) {}
+  size_t sector_size() const override { return half_; }
+  bool read(int sector, size_t off, void *dst, size_t len) override
+  {
+    return esp_partition_read(part_, sector * half_ + off, dst, len) == ESP_OK;
+  }
+  bool write(int sector, size_t off, const void *src, size_t len) override
+  {
+    return esp_partition_write(part_, sector * half_ + off, src, len) == ESP_OK;
+  }
+  bool erase(int sector) override
+  {
+    return esp_partition_erase_range(part_, sector * half_, half_) == ESP_OK;
+  }
+
+private:
+  const esp_partition_t *part_;
+  size_t half_;
+};
+
+struct Session {
+  int score;
+  int miss;
+};
+
+portMUX_TYPE  s_lock = portMUX_INITIALIZER_UNLOCKED;
+GameStats     s_stats[SCORE_SLOTS];
+Session       s_session[SCORE_SLOTS];
+uint32_t      s_dirty = 0;
+TickType_t    s_last_update = 0;
+ScoreLog     *s_log = nullptr;
+TaskHandle_t  s_task = nullptr;
+bool          s_merged = false;      // best scores include what flash holds
+uint32_t      s_best_pending = 0;    // games that asked to log before that
+
+bool valid_game(int game) { return game >= 0 && game < GAME_COUNT; }
+
+void flush_pending()
+{
+  if (!s_log) return;
+  GameStats snap[SCORE_SLOTS];
+  uint32_t mask;
+  portENTER_CRITICAL(&s_lock);
+  for (int i = 0; i < SCORE_SLOTS; ++i) snap[i] = s_stats[i];
+  mask = s_dirty;
+  s_dirty = 0;
+  portEXIT_CRITICAL(&s_lock);
+  if (!mask) return;
+
+  if (!s_log->append(snap, mask)) {
+    ESP_LOGW(TAG_STORE, "flush failed, will retry");
+    portENTER_CRITICAL(&s_lock);
+    s_dirty |= mask;
+    portEXIT_CRITICAL(&s_lock);
+  }
+}
+
+// Flash is merged in, or known to be unavailable: log the held bests
+void mark_merged()
+{
+  portENTER_CRITICAL(&s_lock);
+  s_merged = true;
+  const uint32_t pending = s_best_pending;
+  s_best_pending = 0;
+  portEXIT_CRITICAL(&s_lock);
+  for (int i = 0; i < GAME_COUNT; ++i)
+    if (pending & (1u << i)) dlog(DLOG_GAME_BEST, i, (int32_t)score_store_get(i).best_score);
+}
+
+void flush_task(void *)
+{
+  while (true) {
+    bool kicked = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(POLL_MS)) > 0;
+    portENTER_CRITICAL(&s_lock);
+    bool idle = s_dirty && (xTaskGetTickCount() - s_last_update) >= pdMS_TO_TICKS(IDLE_FLUSH_MS);
+    portEXIT_CRITICAL(&s_lock);
+    if (kicked || idle) flush_pending();
+  }
+}
+
+} // namespace
+
+RAM_ACCOUNT(score_store, "score store", sizeof(s_stats) + sizeof(s_session) + sizeof(PartitionFlash) + sizeof(ScoreLog));
+
+void score_store_init()
+{
+  const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "scores");
+  if (!part) { ESP_LOGW(TAG_STORE, "no \"scores\" partition, stats are RAM-only"); mark_merged(); return; }
+
+  static PartitionFlash flash(part);
+  static ScoreLog log(flash);
+  GameStats loaded[SCORE_SLOTS];
+  if (!log.load(loaded)) { ESP_LOGE(TAG_STORE, "log read failed"); mark_merged(); return; }
+
+  // Boot defers this load past the first frame, so a game may already have
+  // counted into s_stats; fold that on top of what flash holds
+  portENTER_CRITICAL(&s_lock);
+  for (int i = 0; i < SCORE_SLOTS; ++i) {
+    GameStats &st = s_stats[i];
+    if (st.sessions) s_dirty |= 1u << i;
+    if (loaded[i].best_score > st.best_score) st.best_score = loaded[i].best_score;
+    st.sessions    += loaded[i].sessions;
+    st.total_score += loaded[i].total_score;
+    st.total_miss  += loaded[i].total_miss;
+  }
+  s_log = &log;
+  portEXIT_CRITICAL(&s_lock);
+  mark_merged();
+  ESP_LOGI(TAG_STORE, "loaded gen %u, %u free slots", (unsigned)log.generation(), (unsigned)log.free_slots());
+
+  xTaskCreate(flush_task, "score_flush", 3072, nullptr, tskIDLE_PRIORITY + 1, &s_task);
+  mem_report_track_task(s_task, "score_flush");
+}
+
+void score_store_begin_session(int game, int score, int miss)
+{
+  if (!valid_game(game)) return;
+  portENTER_CRITICAL(&s_lock);
+  s_session[game] = {score, miss};
+  s_stats[game].sessions++;
+  s_dirty |= 1u << game;
+  s_last_update = xTaskGetTickCount();
+  portEXIT_CRITICAL(&s_lock);
+}
+
+void score_store_update(int game, int score, int miss)
+{
+  if (!valid_game(game)) return;
+  portENTER_CRITICAL(&s_lock);
+  Session &ses = s_session[game];
+  GameStats &st = s_stats[game];
+  st.total_score += (uint32_t)(score - ses.score);
+  st.total_miss  += (uint32_t)(miss - ses.miss);
+  ses.score = score; ses.miss = miss;
+  if ((uint32_t)score > st.best_score) st.best_score = (uint32_t)score;
+  s_dirty |= 1u << game;
+  s_last_update = xTaskGetTickCount();
+  portEXIT_CRITICAL(&s_lock);
+}
+
+void score_store_end_session(int game)
+{
+  (void)game;
+  if (s_task) xTaskNotifyGive(s_task);
+}
+
+GameStats score_store_get(int game)
+{
+  GameStats st = {};
+  if (!valid_game(game)) return st;
+  portENTER_CRITICAL(&s_lock);
+  st = s_stats[game];
+  portEXIT_CRITICAL(&s_lock);
+  return st;
+}
+
+void score_store_log_best(int game)
+{
+  if (!valid_game(game)) return;
+  portENTER_CRITICAL(&s_lock);
+  const bool merged = s_merged;
+  const uint32_t best = s_stats[game].best_score;
+  if (!merged) s_best_pending |= 1u << game;
+  portEXIT_CRITICAL(&s_lock);
+  if (merged) dlog(DLOG_GAME_BEST, game, (int32_t)best);
+}
@@ -0,0 +1,23 @@
+// Persistent high scores and session stats, batched in RAM and flushed
+// from a low-priority task (see score_log.hpp for the on-flash format)
+#pragma once
+
+#include "score_log.hpp"
+
+// Load the log from the "scores" partition and start the flush task.
+// Safe to skip: without a partition, stats simply live in RAM only.
+// May run after a game has started; anything counted so far is merged in.
+void score_store_init();
+
+// Hot-path calls: RAM-only, no flash access
+// A resumed session passes its restored score/miss as the baseline so
+// only progress made after the resume is added to the totals
+void score_store_begin_session(int game, int score = 0, int miss = 0);
+void score_store_update(int game, int score, int miss);
+void score_store_end_session(int game);   // also requests a flush
+
+GameStats score_store_get(int game);
+
+// Logs the game's best score (DLOG_GAME_BEST). Before score_store_init has
+// merged in flash the best is not known yet; the log is held until then.
+void score_store_log_best(int game);
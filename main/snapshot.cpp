@@ -0,0 +1,52 @@
+#include "snapshot.hpp"
+#include "score_log.hpp"   // crc32_le
+#include <cstddef>
+#include <cstring>
+
+static constexpr uint32_t SNAPSHOT_MAGIC   = 0x534E4150; // "SNAP"
+static constexpr uint16_t SNAPSHOT_VERSION = 1;
+
+GameSnapshot snapshot_make(int game)
+{
+  GameSnapshot s;
+  std::memset(&s, 0, sizeof(s));   // padding too, it is covered by the CRC
+  s.game = (uint8_t)game;
+  return s;
+}
+
+void snapshot_seal(GameSnapshot &s)
+{
+  s.magic = SNAPSHOT_MAGIC;
+  s.version = SNAPSHOT_VERSION;
+  s.crc = crc32_le(0, &s, offsetof(GameSnapshot, crc));
+}
+
+bool snapshot_valid(const GameSnapshot &s, int game_count)
+{
+  if (s.magic != SNAPSHOT_MAGIC || s.version != SNAPSHOT_VERSION) return false;
+  if (s.game >= game_count) return false;
+  return s.crc == crc32_le(0, &s, offsetof(GameSnapshot, crc));
+}
+
+bool SnapshotStore::boot(bool trusted, int game_count)
+{
+  valid_ = trusted && snapshot_valid(retained_, game_count);
+  if (valid_) boot_ = retained_;
+  seq_ = valid_ ? boot_.seq : 0;
+  return valid_;
+}
+
+bool SnapshotStore::claim(int game, GameSnapshot &out)
+{
+  if (!valid_ || boot_.game != game) return false;
+  valid_ = false;
+  out = boot_;
+  return true;
+}
+
+void SnapshotStore::save(GameSnapshot &snap)
+{
+  snap.seq = ++seq_;
+  snapshot_seal(snap);
+  retained_ = snap;
+}
@@ -0,0 +1,73 @@
+// Compact per-game state kept across resets for instant resume
+// (encoding and validation only, no ESP-IDF deps)
+#pragma once
+
+#include <cstdint>
+
+struct TapBallState {
+  int16_t  score;
+  int16_t  radius;
+  int16_t  cx, cy;
+  int8_t   vx, vy;
+  uint16_t color;
+};
+
+struct WhackState {
+  int16_t  score, miss;
+  int16_t  txc, tyc;
+  uint16_t ttl_ms;
+};
+
+struct GridState {
+  int16_t  score, miss;
+  uint16_t ttl_ms;
+};
+
+struct GameSnapshot {
+  uint32_t magic;
+  uint16_t version;
+  uint8_t  game;       // GameId
+  uint8_t  reserved;
+  uint32_t seq;        // bumped on every save, for debugging stale restores
+  union {
+    TapBallState tap;
+    WhackState   whack;
+    GridState    grid;
+  };
+  uint32_t crc;
+};
+
+// Blank snapshot for `game`; fill the matching state member, then seal
+GameSnapshot snapshot_make(int game);
+
+// Stamp magic/version and the CRC over everything before it
+void snapshot_seal(GameSnapshot &s);
+
+// Rejects power-on garbage, other firmware layouts and torn writes
+bool snapshot_valid(const GameSnapshot &s, int game_count);
+
+// Resume bookkeeping around one retained copy (boot.cpp keeps it in RTC
+// memory): takes it at boot, hands it to its game once, and numbers saves
+// on from the sequence it carried
+class SnapshotStore {
+public:
+  explicit SnapshotStore(GameSnapshot &retained) : retained_(retained) {}
+
+  // `trusted`: the reset left retained memory meaningful. A snapshot that
+  // is not trusted or not valid is ignored and numbering starts over.
+  bool boot(bool trusted, int game_count);
+
+  int  game() const { return valid_ ? boot_.game : -1; }
+  // One-shot: true (and fills `out`) if the boot snapshot belongs to `game`
+  bool claim(int game, GameSnapshot &out);
+  // Numbers, seals and stores `snap`
+  void save(GameSnapshot &snap);
+
+  uint32_t seq() const { return seq_; }
+
+private:
+  GameSnapshot &retained_;
+  GameSnapshot  boot_ = {};
+  bool          valid_ = false;
+  uint32_t      seq_ = 0;
+};
@@ -0,0 +1,83 @@
+extern "C" {
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/uart.h"
+#include "esp_cpu.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include "sdkconfig.h"
+}
+
+#include "stats_console.hpp"
+#include "console_commands.hpp"
+#include "game_common.hpp"
+#include "mem_report.hpp"
+#include <atomic>
+
+static const char *TAG_CON = "CONSOLE";
+
+#ifdef CONFIG_ESP_CONSOLE_UART_NUM
+static constexpr uart_port_t CONSOLE_UART = (uart_port_t)CONFIG_ESP_CONSOLE_UART_NUM;
+#else
+static constexpr uart_port_t CONSOLE_UART = UART_NUM_0;
+#endif
+
+namespace {
+
+std::atomic<Scene *> s_scene{nullptr};   // set by the deferred start, read per frame
+FlushStats   s_last_flush = {};          // render task only
+bool         s_flush_primed = false;
+
+void uart_out(const char *data, size_t len) { uart_write_bytes(CONSOLE_UART, data, len); }
+
+void console_task(void *)
+{
+  static Console con(CONSOLE_COMMANDS, CONSOLE_COMMAND_COUNT, uart_out, true);
+  char buf[32];
+  while (true) {
+    int n = uart_read_bytes(CONSOLE_UART, buf, sizeof(buf), pdMS_TO_TICKS(100));
+    if (n > 0) con.feed(buf, (size_t)n);
+    reports_service();
+    touch_trace_drain([](const char *line, void *ctx) { static_cast<Console *>(ctx)->printf("%s\r\n", line); }, &con);
+  }
+}
+
+} // namespace
+
+RAM_ACCOUNT(stats_console, "stats console", sizeof(PerfCounters) + sizeof(Console) + sizeof(TapStats));
+
+void stats_console_start(Scene &scene)
+{
+  s_scene.store(&scene, std::memory_order_release);
+  esp_err_t ret = uart_driver_install(CONSOLE_UART, 256, 0, 0, nullptr, 0);
+  if (ret != ESP_OK) { ESP_LOGE(TAG_CON, "uart driver: %s", esp_err_to_name(ret)); return; }
+  TaskHandle_t task;
+  xTaskCreate(console_task, "console", 3072, nullptr, tskIDLE_PRIORITY + 1, &task);
+  mem_report_track_task(task, "console");
+}
+
+void stats_frame(int64_t now_us, uint32_t cost_us, int game, int particles, int ripples)
+{
+  uint32_t windows = 0, pixels = 0;
+  if (Scene *scene = s_scene.load(std::memory_order_acquire)) {
+    const FlushStats &fs = scene->flush_stats();
+    if (s_flush_primed) {
+      windows = fs.windows - s_last_flush.windows;
+      pixels = fs.pixels - s_last_flush.pixels;
+    }
+    s_last_flush = fs;
+    s_flush_primed = true;
+  }
+  PerfCounters &perf = console_perf();
+  perf.effects(particles, ripples);
+  perf.frame(now_us, cost_us, windows, pixels, game);
+}
+
+void stats_touch_event() { console_perf().touch_event(); }
+
+// ---- console_commands.hpp platform side ----
+ConsoleHeap console_heap() { return { (uint32_t)esp_get_free_heap_size(), (uint32_t)esp_get_minimum_free_heap_size() }; }
+uint32_t console_cycles() { return esp_cpu_get_cycle_count(); }
+void *console_alloc_internal(size_t bytes) { return heap_caps_malloc(bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_32BIT); }
+void console_free_internal(void *p) { heap_caps_free(p); }
@@ -0,0 +1,13 @@
+// Live stats console on the console UART, running the commands in
+// console_commands.hpp
+#pragma once
+
+#include "scene.hpp"
+#include <cstdint>
+
+// Installs the UART driver and starts the low-priority console task
+void stats_console_start(Scene &scene);
+
+// ---- Render-loop hooks (never block) ----
+void stats_frame(int64_t now_us, uint32_t cost_us, int game, int particles, int ripples);
+void stats_touch_event();
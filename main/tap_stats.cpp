@@ -0,0 +1,88 @@
+#include "tap_stats.hpp"
+#include <cstdio>
+#include <cstring>
+
+static inline void bump(uint16_t &c)
+{
+  if (c != UINT16_MAX) ++c;
+}
+
+static inline int clampi(int v, int lo, int hi) { return v < lo ? lo : v > hi ? hi : v; }
+
+void TapStats::set_screen(int w, int h)
+{
+  if (w <= 0 || h <= 0) return;
+  cell_w_ = (int16_t)((w + TAP_HEAT_COLS - 1) / TAP_HEAT_COLS);
+  cell_h_ = (int16_t)((h + TAP_HEAT_ROWS - 1) / TAP_HEAT_ROWS);
+  region_w_ = (int16_t)((w + TAP_REGION_COLS - 1) / TAP_REGION_COLS);
+  region_h_ = (int16_t)((h + TAP_REGION_ROWS - 1) / TAP_REGION_ROWS);
+}
+
+void TapStats::reset()
+{
+  taps_ = 0;
+  std::memset(heat_, 0, sizeof(heat_));
+  std::memset(games_, 0, sizeof(games_));
+}
+
+void TapStats::record(int game, int x, int y, TapOutcome outcome, bool has_target, int tx, int ty)
+{
+  ++taps_;
+  bump(heat_[clampi(y / cell_h_, 0, TAP_HEAT_ROWS - 1)][clampi(x / cell_w_, 0, TAP_HEAT_COLS - 1)]);
+  if (game < 0 || game >= TAP_GAMES) return;
+
+  TapGameStats &g = games_[game];
+  ++g.taps;
+  g.hits += outcome == TAP_HIT;
+  g.misses += outcome == TAP_MISS;
+  if (!has_target || outcome == TAP_STRAY) return;
+
+  // Bin b covers offsets [b*4 - 26, b*4 - 22): bin 6 holds -2..1
+  constexpr int HALF = TAP_OFF_BINS * TAP_OFF_BIN_PX / 2;
+  const int dx = x - tx, dy = y - ty;
+  if (dx >= -HALF && dx < HALF && dy >= -HALF && dy < HALF) {
+    ++g.near;
+    g.sum_dx += dx;
+    g.sum_dy += dy;
+  }
+  const int bx = clampi(dx + HALF, 0, 2 * HALF - 1) / TAP_OFF_BIN_PX;
+  const int by = clampi(dy + HALF, 0, 2 * HALF - 1) / TAP_OFF_BIN_PX;
+  bump(g.offsets[by][bx]);
+
+  const int rr = clampi(ty / region_h_, 0, TAP_REGION_ROWS - 1), rc = clampi(tx / region_w_, 0, TAP_REGION_COLS - 1);
+  bump(g.region_taps[rr][rc]);
+  if (outcome == TAP_HIT) bump(g.region_hits[rr][rc]);
+}
+
+void TapStats::format(LineFn out, void *ctx) const
+{
+  char line[200];
+  std::snprintf(line, sizeof(line), "taps heat %d %d %d %d %u", TAP_HEAT_COLS, TAP_HEAT_ROWS, cell_w_, cell_h_,
+                (unsigned)taps_);
+  out(line, ctx);
+  for (int r = 0; r < TAP_HEAT_ROWS; ++r) {
+    int n = std::snprintf(line, sizeof(line), "taps h %d", r);
+    for (int c = 0; c < TAP_HEAT_COLS; ++c) n += std::snprintf(line + n, sizeof(line) - n, " %u", heat_[r][c]);
+    out(line, ctx);
+  }
+
+  for (int gi = 0; gi < TAP_GAMES; ++gi) {
+    const TapGameStats &g = games_[gi];
+    if (!g.taps) continue;
+    std::snprintf(line, sizeof(line), "taps game %d %u %u %u %u %d %d", gi, (unsigned)g.taps, (unsigned)g.hits,
+                  (unsigned)g.misses, (unsigned)g.near, (int)g.sum_dx, (int)g.sum_dy);
+    out(line, ctx);
+    for (int r = 0; r < TAP_OFF_BINS; ++r) {
+      int n = std::snprintf(line, sizeof(line), "taps off %d %d", gi, r);
+      for (int c = 0; c < TAP_OFF_BINS; ++c) n += std::snprintf(line + n, sizeof(line) - n, " %u", g.offsets[r][c]);
+      out(line, ctx);
+    }
+    int n = std::snprintf(line, sizeof(line), "taps region %d %d %d %d %d", gi, TAP_REGION_COLS, TAP_REGION_ROWS,
+                          region_w_, region_h_);
+    for (int r = 0; r < TAP_REGION_ROWS; ++r)
+      for (int c = 0; c < TAP_REGION_COLS; ++c)
+        n += std::snprintf(line + n, sizeof(line) - n, " %u/%u", g.region_hits[r][c], g.region_taps[r][c]);
+    out(line, ctx);
+  }
+  out("taps end", ctx);
+}
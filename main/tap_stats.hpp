@@ -0,0 +1,62 @@
+// Where taps land and how far they miss (no ESP-IDF deps): a downsampled
+// heatmap of every tap, per game a histogram of tap-minus-target-center
+// offsets, and per game hit/tap counts for each screen region of the
+// target. Fixed arrays with saturating 16-bit counts: record() is O(1)
+// and never allocates.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+constexpr int TAP_GAMES       = 3;
+constexpr int TAP_HEAT_COLS   = 20;   // 16 px cells on a 320x240 panel
+constexpr int TAP_HEAT_ROWS   = 15;
+constexpr int TAP_OFF_BINS    = 13;   // per axis, centred on the target
+constexpr int TAP_OFF_BIN_PX  = 4;    // +-26 px; farther taps land in the edge bins
+constexpr int TAP_REGION_COLS = 4;
+constexpr int TAP_REGION_ROWS = 3;
+
+enum TapOutcome : uint8_t {
+  TAP_STRAY = 0,   // not judged (outside the play field, nothing to hit)
+  TAP_HIT,
+  TAP_MISS,
+};
+
+struct TapGameStats {
+  uint32_t taps, hits, misses;
+  uint32_t near;                   // taps within the histogram range,
+  int32_t  sum_dx, sum_dy;         // whose offsets these sum: the mean is the aim bias
+  uint16_t offsets[TAP_OFF_BINS][TAP_OFF_BINS];                 // [dy][dx]
+  uint16_t region_taps[TAP_REGION_ROWS][TAP_REGION_COLS];      // by target position
+  uint16_t region_hits[TAP_REGION_ROWS][TAP_REGION_COLS];
+};
+
+class TapStats {
+public:
+  TapStats() { reset(); }
+
+  // Screen size the heatmap and regions divide up; keeps the counts
+  void set_screen(int w, int h);
+
+  // One contact at screen (x, y). With a target, (tx, ty) is its center:
+  // the offset is histogrammed and the target's region scored; without one
+  // only the heatmap and the game's totals count it.
+  void record(int game, int x, int y, TapOutcome outcome, bool has_target, int tx, int ty);
+  void reset();
+
+  uint32_t taps() const { return taps_; }
+  const TapGameStats &game(int g) const { return games_[g]; }
+  uint16_t heat(int row, int col) const { return heat_[row][col]; }
+
+  // The whole state as "taps ..." text lines, the format tools/tap_render
+  // reads back from a UART capture; `line` is only valid during the call
+  using LineFn = void (*)(const char *line, void *ctx);
+  void format(LineFn out, void *ctx) const;
+
+private:
+  int16_t      cell_w_ = 16, cell_h_ = 16;
+  int16_t      region_w_ = 80, region_h_ = 80;
+  uint32_t     taps_ = 0;
+  uint16_t     heat_[TAP_HEAT_ROWS][TAP_HEAT_COLS];
+  TapGameStats games_[TAP_GAMES];
+};
@@ -0,0 +1,116 @@
+extern "C" {
+#include "driver/spi_master.h"
+#include "driver/gpio.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+}
+
+#include "lgfx_setup.hpp"
+#include "touch_dma.hpp"
+#include "xpt2046.hpp"
+#include "mem_report.hpp"
+#include <atomic>
+
+static const char *TAG_TOUCH = "TOUCH";
+
+namespace {
+
+class EspSpiPort : public TouchSpiPort {
+public:
+  void attach(spi_device_handle_t dev) { dev_ = dev; }
+
+  bool queue(const uint8_t *tx, uint8_t *rx, size_t len) override
+  {
+    spi_transaction_t &t = trans_[head_ % XPT_SAMPLES];
+    t = {};
+    t.length    = len * 8;
+    t.tx_buffer = tx;
+    t.rx_buffer = rx;
+    if (spi_device_queue_trans(dev_, &t, 0) != ESP_OK) return false;
+    ++head_;
+    return true;
+  }
+
+  int collect() override
+  {
+    int n = 0;
+    spi_transaction_t *done;
+    while (spi_device_get_trans_result(dev_, &done, 0) == ESP_OK) ++n;
+    return n;
+  }
+
+private:
+  spi_device_handle_t dev_ = nullptr;
+  spi_transaction_t   trans_[XPT_SAMPLES];
+  uint32_t            head_ = 0;
+};
+
+const XptCalib CALIB = { TOUCH_X_MIN, TOUCH_X_MAX, TOUCH_Y_MIN, TOUCH_Y_MAX, TOUCH_Z_THRESHOLD };
+
+EspSpiPort     s_port;
+Xpt2046Reader  s_reader(s_port, CALIB);   // static: rx buffers must sit in DMA-capable RAM
+std::atomic<bool> s_ready{false};   // set from the boot-time init task
+int64_t        s_kick_us = 0;     // current batch queued
+int64_t        s_sample_us = 0;   // batch behind last() queued
+int            s_rotation = 0;
+int            s_panel_w = TFT_WIDTH;
+int            s_panel_h = TFT_HEIGHT;
+
+} // namespace
+
+RAM_ACCOUNT(touch, "touch dma", sizeof(s_port) + sizeof(s_reader));
+
+bool touch_dma_init(int rotation, int panel_w, int panel_h)
+{
+  s_rotation = rotation;
+  s_panel_w = panel_w;
+  s_panel_h = panel_h;
+
+  spi_bus_config_t buscfg = {};
+  buscfg.mosi_io_num = TOUCH_MOSI;
+  buscfg.miso_io_num = TOUCH_MISO;
+  buscfg.sclk_io_num = TOUCH_SCLK;
+  buscfg.quadwp_io_num = -1;
+  buscfg.quadhd_io_num = -1;
+  buscfg.max_transfer_sz = XPT_FRAME_BYTES * XPT_SAMPLES;
+
+  // Floating MISO reads back as 0xFFF, which looks like a hard press
+  gpio_set_pull_mode((gpio_num_t)TOUCH_MISO, GPIO_PULLDOWN_ONLY);
+
+  esp_err_t ret = spi_bus_initialize(TOUCH_SPI_HOST, &buscfg, SPI_DMA_CH_AUTO);
+  if (ret != ESP_OK) { ESP_LOGE(TAG_TOUCH, "bus init failed: %s", esp_err_to_name(ret)); return false; }
+
+  spi_device_interface_config_t devcfg = {};
+  devcfg.clock_speed_hz = TOUCH_FREQ;
+  devcfg.mode = 0;
+  devcfg.spics_io_num = TOUCH_CS;
+  devcfg.queue_size = XPT_SAMPLES;
+  devcfg.cs_ena_pretrans = 2;
+  devcfg.cs_ena_posttrans = 2;
+
+  spi_device_handle_t dev;
+  ret = spi_bus_add_device(TOUCH_SPI_HOST, &devcfg, &dev);
+  if (ret != ESP_OK) { ESP_LOGE(TAG_TOUCH, "add device failed: %s", esp_err_to_name(ret)); return false; }
+
+  s_port.attach(dev);
+  s_reader.poll();   // queue the first batch
+  s_kick_us = esp_timer_get_time();
+  s_ready.store(true, std::memory_order_release);
+  return true;
+}
+
+bool touch_dma_read(uint16_t &x, uint16_t &y)
+{
+  if (!s_ready.load(std::memory_order_acquire)) return false;
+  const uint32_t done = s_reader.batches();
+  s_reader.poll();
+  if (s_reader.batches() != done) {   // a batch landed and the next was queued
+    s_sample_us = s_kick_us;
+    s_kick_us = esp_timer_get_time();
+  }
+  if (!s_reader.pressed()) return false;
+  xpt_map(s_reader.last(), CALIB, s_rotation, s_panel_w, s_panel_h, x, y);
+  return true;
+}
+
+int64_t touch_dma_sample_us() { return s_sample_us; }
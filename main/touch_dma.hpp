@@ -0,0 +1,15 @@
+// XPT2046 on its own SPI host, read through queued DMA transactions
+#pragma once
+
+#include <cstdint>
+
+// Bus and device setup; rotation and panel size match the LGFX instance
+bool touch_dma_init(int rotation, int panel_w, int panel_h);
+
+// Latest batch result in screen coordinates. Only checks whether the
+// queued batch has finished; never waits on the SPI bus.
+bool touch_dma_read(uint16_t &x, uint16_t &y);
+
+// When the batch behind the latest reading was queued, i.e. when the
+// panel was sampled (esp_timer microseconds)
+int64_t touch_dma_sample_us();
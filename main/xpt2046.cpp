@@ -0,0 +1,93 @@
+#include "xpt2046.hpp"
+#include <algorithm>
+#include <cstring>
+
+void xpt_build_frame(uint8_t tx[XPT_FRAME_BYTES])
+{
+  // Each command byte is clocked out while the low byte of the previous
+  // result is clocked in, so 4 conversions fit in 9 bytes instead of 12.
+  // The frame is padded to a word for DMA, and a transaction clocks all
+  // XPT_FRAME_BYTES of it.
+  std::memset(tx, 0, XPT_FRAME_BYTES);
+  tx[0] = XPT_CMD_Z1;
+  tx[2] = XPT_CMD_Z2;
+  tx[4] = XPT_CMD_X;
+  tx[6] = XPT_CMD_Y;
+}
+
+static inline uint16_t conv(const uint8_t *rx, int i)
+{
+  return (uint16_t)((((uint16_t)rx[1 + 2 * i] << 8) | rx[2 + 2 * i]) >> 3) & 0x0FFF;
+}
+
+static uint16_t median(uint16_t *v, int n)
+{
+  std::sort(v, v + n);
+  return v[n / 2];
+}
+
+bool xpt_decode(const uint8_t rx[][XPT_FRAME_BYTES], int count, const XptCalib &cal, XptRaw &out)
+{
+  uint16_t xs[XPT_SAMPLES], ys[XPT_SAMPLES];
+  int zsum = 0;
+  int used = 0;
+  count = std::min(count, XPT_SAMPLES);
+  for (int k = 0; k < count; ++k) {
+    int z1 = conv(rx[k], 0);
+    int z2 = conv(rx[k], 1);
+    int z  = z1 + 4095 - z2;
+    if (z1 == 0 || z < cal.z_threshold) continue;
+    xs[used] = conv(rx[k], 2);
+    ys[used] = conv(rx[k], 3);
+    zsum += z; ++used;
+  }
+  out.used = (uint8_t)used;
+  // Need a majority of the batch to agree the panel is pressed; edges of a
+  // touch produce single noisy samples.
+  if (used * 2 <= count) { out.z = 0; return false; }
+  out.x = median(xs, used);
+  out.y = median(ys, used);
+  out.z = (uint16_t)(zsum / used);
+  return true;
+}
+
+void xpt_map(const XptRaw &raw, const XptCalib &cal, int rotation,
+             int panel_w, int panel_h, uint16_t &sx, uint16_t &sy)
+{
+  int nx = (int)(raw.x - cal.x_min) * panel_w / std::max(1, cal.x_max - cal.x_min);
+  int ny = (int)(raw.y - cal.y_min) * panel_h / std::max(1, cal.y_max - cal.y_min);
+  nx = std::max(0, std::min(panel_w - 1, nx));
+  ny = std::max(0, std::min(panel_h - 1, ny));
+  // Same orientation convention as LGFX_Device::setRotation
+  switch (rotation & 3) {
+    default:
+    case 0: sx = nx;               sy = ny;               break;
+    case 1: sx = ny;               sy = panel_w - 1 - nx; break;
+    case 2: sx = panel_w - 1 - nx; sy = panel_h - 1 - ny; break;
+    case 3: sx = panel_h - 1 - ny; sy = nx;               break;
+  }
+}
+
+void Xpt2046Reader::kick()
+{
+  for (queued_ = 0; queued_ < XPT_SAMPLES; ++queued_)
+    if (!port_.queue(tx_, rx_[queued_], XPT_FRAME_BYTES)) break;
+  in_flight_ = queued_;
+  // Nothing on the wire means nothing to decode next poll: read as
+  // released rather than holding the last contact until the queue recovers
+  if (queued_ == 0) pressed_ = false;
+}
+
+void Xpt2046Reader::poll()
+{
+  if (in_flight_ > 0) {
+    in_flight_ -= port_.collect();
+    if (in_flight_ > 0) return;   // batch still on the wire
+    in_flight_ = 0;
+    XptRaw raw;
+    pressed_ = xpt_decode(rx_, queued_, cal_, raw);
+    if (pressed_) last_ = raw;
+    ++batches_;
+  }
+  kick();
+}
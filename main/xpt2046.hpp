@@ -0,0 +1,73 @@
+// XPT2046 batched reader: command sequencing and sample decoding
+// (no ESP-IDF deps; the SPI side is behind TouchSpiPort)
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+constexpr int    XPT_SAMPLES     = 4;    // samples per batch, one SPI transaction each
+constexpr size_t XPT_FRAME_BYTES = 12;   // 9 used, padded to a word for DMA; all 12 clocked
+
+// Control bytes: S | A2..A0 | MODE(12 bit) | SER/DFR(diff) | PD1..PD0
+// PD=01 keeps the ADC powered between chained conversions; the last one
+// of a frame uses PD=00 so PENIRQ is re-armed.
+constexpr uint8_t XPT_CMD_Z1 = 0xB1;
+constexpr uint8_t XPT_CMD_Z2 = 0xC1;
+constexpr uint8_t XPT_CMD_X  = 0xD1;
+constexpr uint8_t XPT_CMD_Y  = 0x90;
+
+struct XptRaw {
+  uint16_t x, y;   // 12-bit medians of the accepted samples
+  uint16_t z;      // pressure estimate, 0 when released
+  uint8_t  used;   // samples that passed the pressure gate
+};
+
+struct XptCalib {
+  int x_min, x_max, y_min, y_max;
+  int z_threshold;
+};
+
+// One transaction per sample; transfers complete in queue order
+class TouchSpiPort {
+public:
+  virtual ~TouchSpiPort() = default;
+  virtual bool queue(const uint8_t *tx, uint8_t *rx, size_t len) = 0;  // non-blocking
+  virtual int  collect() = 0;   // finished transfers since last call, never waits
+};
+
+// Fill one frame of overlapped 16-clock conversions: Z1, Z2, X, Y
+void xpt_build_frame(uint8_t tx[XPT_FRAME_BYTES]);
+
+// Decode `count` frames of received bytes. Returns false when released.
+bool xpt_decode(const uint8_t rx[][XPT_FRAME_BYTES], int count, const XptCalib &cal, XptRaw &out);
+
+// Calibrated raw reading to screen coordinates for a LovyanGFX rotation
+void xpt_map(const XptRaw &raw, const XptCalib &cal, int rotation,
+             int panel_w, int panel_h, uint16_t &sx, uint16_t &sy);
+
+class Xpt2046Reader {
+public:
+  Xpt2046Reader(TouchSpiPort &port, const XptCalib &cal) : port_(port), cal_(cal) { xpt_build_frame(tx_); }
+
+  // Frame-loop entry: harvest a finished batch, decode it and queue the
+  // next one. Costs a completion check unless a batch just landed. When
+  // no transaction could be queued, reads as released.
+  void poll();
+
+  bool   pressed() const { return pressed_; }
+  const XptRaw &last() const { return last_; }
+  uint32_t batches() const { return batches_; }
+
+private:
+  void kick();
+
+  TouchSpiPort &port_;
+  XptCalib cal_;
+  alignas(4) uint8_t tx_[XPT_FRAME_BYTES];
+  alignas(4) uint8_t rx_[XPT_SAMPLES][XPT_FRAME_BYTES];
+  int      queued_ = 0;
+  int      in_flight_ = 0;
+  bool     pressed_ = false;
+  XptRaw   last_ = {};
+  uint32_t batches_ = 0;
+};
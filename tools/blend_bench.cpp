@@ -0,0 +1,86 @@
+// Host check and benchmark for the RGB565 blend kernel:
+//   g++ -std=c++17 -O3 -march=native -I main tools/blend_bench.cpp main/blend565.cpp -o blend_bench
+//   ./blend_bench
+// Every channel pair at every alpha is compared against a float reference
+// first: exact at the kernel's 1/32 alpha steps, and against the 8-bit
+// alpha within the quantisation bound (1 LSB red/blue, 1.5 LSB green).
+// The pixel-pair loop must then match the per-pixel one at every alpha,
+// length and 16-bit offset. Timing only runs when both pass; on the device
+// the console's `blend` command times the two loops in CPU cycles.
+#include "blend565.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+static uint16_t pack(int r, int g, int b) { return (uint16_t)((r << 11) | (g << 5) | b); }
+
+static int check()
+{
+  int exact_fail = 0, loose_fail = 0;
+  for (int a = 0; a < 256; ++a) {
+    const double q = blend565_alpha5((uint8_t)a) / 32.0, f = a / 255.0;
+    for (int s = 0; s < 64; ++s) for (int d = 0; d < 64; ++d) {
+      const int s5 = s >> 1, d5 = d >> 1;
+      uint16_t px = pack(d5, d, d5);
+      blend565_span(&px, 1, pack(s5, s, s5), (uint8_t)a);
+      const int got[3] = { px >> 11, (px >> 5) & 63, px & 31 };
+      const int src[3] = { s5, s, s5 }, dst[3] = { d5, d, d5 };
+      for (int c = 0; c < 3; ++c) {
+        if (got[c] != (int)std::floor(src[c] * q + dst[c] * (1 - q) + 0.5)) ++exact_fail;
+        if (std::fabs(got[c] - (src[c] * f + dst[c] * (1 - f))) > (c == 1 ? 1.5 : 1.0)) ++loose_fail;
+      }
+      uint16_t be = __builtin_bswap16(pack(d5, d, d5));
+      blend565_span_be(&be, 1, pack(s5, s, s5), (uint8_t)a);
+      if (__builtin_bswap16(be) != px) ++exact_fail;
+      if (blend565(pack(d5, d, d5), pack(s5, s, s5), (uint8_t)a) != px) ++exact_fail;
+    }
+  }
+  std::printf("check: %d exact mismatches, %d outside the 8-bit alpha bound\n", exact_fail, loose_fail);
+  return exact_fail + loose_fail;
+}
+
+static int check_pairs()
+{
+  alignas(4) uint16_t base[72], px[72], pairs[72];
+  for (int i = 0; i < 72; ++i) base[i] = (uint16_t)(i * 2654435761u >> 13);
+  int fail = 0;
+  for (int a = 0; a < 256; ++a)
+    for (int off = 0; off < 2; ++off)
+      for (int n = 0; n + off < 70; ++n) {
+        std::memcpy(px, base, sizeof(base));
+        std::memcpy(pairs, base, sizeof(base));
+        const uint16_t src = (uint16_t)(a * 40503u + n);
+        blend565_span_be_px(px + off, n, src, (uint8_t)a);
+        blend565_span_be_pairs(pairs + off, n, src, (uint8_t)a);
+        fail += std::memcmp(px, pairs, sizeof(px)) != 0;
+      }
+  std::printf("check: %d pixel-pair spans differ from per-pixel\n", fail);
+  return fail;
+}
+
+template <typename Fn>
+static void bench(const char *name, Fn fn)
+{
+  std::vector<uint16_t> buf(320 * 16);   // one scene band
+  for (size_t i = 0; i < buf.size(); ++i) buf[i] = (uint16_t)(i * 2654435761u >> 16);
+  const int rounds = 20000;
+  auto t0 = std::chrono::steady_clock::now();
+  for (int r = 0; r < rounds; ++r) fn(buf.data(), (int)buf.size(), (uint8_t)(r * 7));
+  const double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  unsigned sink = 0;
+  for (uint16_t v : buf) sink += v;
+  std::printf("%-22s %8.1f Mpx/s  (%u)\n", name, rounds * buf.size() / s / 1e6, sink & 0xFF);
+}
+
+int main()
+{
+  if (check() || check_pairs()) return 1;
+  bench("per-pixel blend565", [](uint16_t *p, int n, uint8_t a) { for (int i = 0; i < n; ++i) p[i] = blend565(p[i], 0xFD20, a); });
+  bench("blend565_span", [](uint16_t *p, int n, uint8_t a) { blend565_span(p, n, 0xFD20, a); });
+  bench("blend565_span_be", [](uint16_t *p, int n, uint8_t a) { blend565_span_be(p, n, 0xFD20, a); });
+  bench("blend565_span_be_px", [](uint16_t *p, int n, uint8_t a) { blend565_span_be_px(p, n, 0xFD20, a); });
+  bench("blend565_span_be_pairs", [](uint16_t *p, int n, uint8_t a) { blend565_span_be_pairs(p, n, 0xFD20, a); });
+  return 0;
+}
@@ -0,0 +1,217 @@
+// The stats console on a host terminal: the device's command table
+// (main/console_commands.cpp) over a synthetic render loop on its own
+// thread, which answers the same render-task handshakes the games' loop
+// does (game requests, quality pins, effect limits, touch traces, tap
+// stats copies), to try commands and output without a board:
+//   g++ -std=gnu++17 -O2 -pthread -DLGFX_HEADLESS=1 -DENABLE_GAME_SWITCH=1 -I tools/golden/include
+//       -I tools/host_lgfx -I main tools/console_host.cpp main/console.cpp main/console_commands.cpp
+//       main/perf_stats.cpp main/latency.cpp main/tap_stats.cpp main/blend565.cpp -o console_host
+//   ./console_host            interactive; "help", any device command, "quit"
+//   ./console_host check      hammers read() against a 10 kHz writer and
+//                             reports torn or inconsistent snapshots, then
+//                             runs every command once through the table
+#include "console_commands.hpp"
+#include "game_common.hpp"
+#include "games.hpp"
+#include "mem_report.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::atomic<bool> s_quit{false};
+std::atomic<int>  s_burst{24}, s_particles{MAX_PARTICLES}, s_ripples{MAX_RIPPLES};
+std::atomic<int>  s_game_req{-1}, s_pin_req{-2}, s_trace{0};
+std::atomic<int>  s_tier{QUALITY_DEFAULT_TIER};
+std::atomic<bool> s_pinned{false}, s_running{false};
+std::atomic<TapStats *> s_copy_req{nullptr};
+std::atomic<bool> s_copy_reset{false}, s_copied{false};
+TapStats          s_loop_taps;   // render thread only
+
+int64_t now_us()
+{
+  using namespace std::chrono;
+  return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+uint32_t s_rng = 1;
+int rnd(int lo, int hi)
+{
+  s_rng ^= s_rng << 13; s_rng ^= s_rng >> 17; s_rng ^= s_rng << 5;
+  return lo + (int)(s_rng % (uint32_t)(hi - lo + 1));
+}
+
+// Roughly the device's frame: 60 Hz, cost grows with live effects. Takes
+// the console's requests at the top of each frame, as run_frame does.
+void render_loop(int period_us)
+{
+  PerfCounters &perf = console_perf();
+  int parts = 0, ripples = 0, game = 0;
+  const int64_t t0 = now_us();
+  s_loop_taps.set_screen(320, 240);
+  s_running = true;
+  while (!s_quit.load(std::memory_order_relaxed)) {
+    const int g = s_game_req.exchange(-1, std::memory_order_relaxed);
+    if (g >= 0 && g < GAME_COUNT) game = g;
+    const int pin = s_pin_req.exchange(-2, std::memory_order_relaxed);
+    if (pin != -2) {
+      s_pinned = pin >= 0;
+      if (pin >= 0) s_tier = std::min(pin, QUALITY_TIER_COUNT - 1);
+    }
+    if (TapStats *dst = s_copy_req.exchange(nullptr, std::memory_order_acquire)) {
+      *dst = s_loop_taps;
+      if (s_copy_reset.load(std::memory_order_relaxed)) s_loop_taps.reset();
+      s_copied.store(true, std::memory_order_release);
+    }
+
+    const bool tap = rnd(0, 30) == 0;
+    const int x = rnd(0, 319), y = rnd(HUD_H, 239);
+    if (tap) {
+      perf.touch_event();
+      s_loop_taps.record(game, x, y, rnd(0, 3) ? TAP_HIT : TAP_MISS, true, x + rnd(-8, 8), y + rnd(-8, 8));
+      const int burst = std::min(s_burst.load(), (int)QUALITY_TIERS[s_tier.load()].burst);
+      parts = std::min(parts + burst, s_particles.load());
+      ripples = std::min(ripples + 1, s_ripples.load());
+    }
+    if (s_trace.load(std::memory_order_relaxed) > 0) {
+      s_trace.fetch_sub(1, std::memory_order_relaxed);
+      std::printf("%u %d %d %d\n", (unsigned)((now_us() - t0) / 1000), tap ? 1 : 0, tap ? x : 0, tap ? y : 0);
+    }
+    if (parts) parts -= rnd(0, 2) > 0 ? 1 : 0;
+    if (ripples && rnd(0, 20) == 0) --ripples;
+    const uint32_t cost = 1500 + 40 * parts + 300 * ripples + rnd(0, 400);
+    const uint32_t windows = 2 + parts / 4 + ripples;
+    perf.effects(parts, ripples);
+    perf.frame(now_us(), cost, windows, windows * 600, game);
+    std::this_thread::sleep_for(std::chrono::microseconds(period_us));
+  }
+  s_running = false;
+}
+
+void out(const char *data, size_t len) { std::fwrite(data, 1, len, stdout); std::fflush(stdout); }
+
+void cmd_quit(Console &, int, char **) { s_quit = true; }
+
+// The device table plus "quit"
+std::vector<ConsoleCommand> host_commands()
+{
+  std::vector<ConsoleCommand> cmds(CONSOLE_COMMANDS, CONSOLE_COMMANDS + CONSOLE_COMMAND_COUNT);
+  cmds.push_back({ "quit", "exit", cmd_quit });
+  return cmds;
+}
+
+int check()
+{
+  std::thread writer(render_loop, 100);
+  long reads = 0, misses = 0, bad = 0;
+  uint32_t last_frames = 0;
+  const int64_t end = now_us() + 3000000;
+  while (now_us() < end) {
+    PerfSnapshot s;
+    if (!console_perf().read(s)) { ++misses; continue; }
+    ++reads;
+    // A torn copy mixes fields from two publications
+    if (s.cost_p50_us > s.cost_p90_us || s.cost_p90_us > s.cost_p99_us || s.cost_p99_us > s.cost_max_us ||
+        s.frames < last_frames || s.game != 0 || s.fps_x10 == 0)
+      ++bad;
+    last_frames = s.frames;
+  }
+  s_quit = true;
+  writer.join();
+  std::printf("check: %ld reads, %ld without a snapshot, %ld inconsistent\n", reads, misses, bad);
+  return bad ? 1 : 0;
+}
+
+// Every device command once, with the loop running; each must answer
+std::string s_out;
+void capture(const char *data, size_t len) { s_out.append(data, len); }
+
+int check_commands()
+{
+  s_quit = false;
+  std::thread loop(render_loop, 2000);
+  while (!s_running) std::this_thread::yield();
+  const std::vector<ConsoleCommand> cmds = host_commands();
+  Console con(cmds.data(), (int)cmds.size(), capture, false);
+  const char *const LINES[] = { "help", "stats", "mem", "reset", "game 2", "fx burst=8", "quality 1", "quality auto",
+                                "taps", "taps reset", "blend 2" };
+  int silent = 0;
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  for (const char *line : LINES) {
+    s_out.clear();
+    con.feed(line, std::strlen(line));
+    con.feed("\n", 1);
+    if (s_out.empty() || s_out.find("unknown") != std::string::npos) {
+      std::printf("  command '%s' gave no answer\n", line);
+      ++silent;
+    }
+  }
+  s_quit = true;
+  loop.join();
+  std::printf("check: %d of %zu device commands answered\n", (int)(sizeof(LINES) / sizeof(LINES[0])) - silent,
+              sizeof(LINES) / sizeof(LINES[0]));
+  return silent ? 1 : 0;
+}
+
+} // namespace
+
+// ---- game_common.hpp handshakes, answered by render_loop ----
+void request_game(int game) { s_game_req.store(game, std::memory_order_relaxed); }
+int  quality_tier() { return s_tier.load(std::memory_order_relaxed); }
+bool quality_pinned() { return s_pinned.load(std::memory_order_relaxed); }
+void quality_pin(int tier) { s_pin_req.store(tier < 0 ? -1 : tier, std::memory_order_relaxed); }
+void touch_trace(int frames) { s_trace.store(frames, std::memory_order_relaxed); }
+EffectLimits effect_limits() { return { s_burst.load(), s_particles.load(), s_ripples.load() }; }
+
+void set_effect_limits(const EffectLimits &lim)
+{
+  s_burst = std::max(0, std::min(lim.burst, MAX_PARTICLES));
+  s_particles = std::max(0, std::min(lim.particles, MAX_PARTICLES));
+  s_ripples = std::max(0, std::min(lim.ripples, MAX_RIPPLES));
+}
+
+bool tap_stats_copy(TapStats &dst, bool reset)
+{
+  if (!s_running) return false;
+  s_copied.store(false, std::memory_order_relaxed);
+  s_copy_reset.store(reset, std::memory_order_relaxed);
+  s_copy_req.store(&dst, std::memory_order_release);
+  while (!s_copied.load(std::memory_order_acquire)) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  return true;
+}
+
+// ---- mem_report.hpp: a host process has no task stacks to report ----
+void mem_report(void (*out)(const char *line, void *ctx), void *ctx) { out("(no memory report on the host)", ctx); }
+void mem_report_stacks(void (*)(const char *, unsigned, void *), void *) {}
+
+// ---- console_commands.hpp platform side ----
+ConsoleHeap console_heap() { return { 0, 0 }; }
+uint32_t console_cycles()   // nanoseconds stand in for cycles
+{
+  using namespace std::chrono;
+  return (uint32_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+void *console_alloc_internal(size_t bytes) { return std::malloc(bytes); }
+void console_free_internal(void *p) { std::free(p); }
+
+int main(int argc, char **argv)
+{
+  if (argc > 1 && !std::strcmp(argv[1], "check")) return check() | check_commands();
+
+  std::thread writer(render_loop, 16667);
+  const std::vector<ConsoleCommand> cmds = host_commands();
+  Console con(cmds.data(), (int)cmds.size(), out, false);
+  con.print("stats console (host); type help\r\n");
+  char buf[64];
+  while (!s_quit && std::fgets(buf, sizeof(buf), stdin)) con.feed(buf, std::strlen(buf));
+  s_quit = true;
+  writer.join();
+  return 0;
+}
@@ -0,0 +1,224 @@
+// Host benchmark of a frame-loop log call: dlog (a record pushed into the
+// DlogRing, drained by a consumer thread as the dlog task does) against
+// the ESP_LOGI path it replaced (the line formatted with the same format
+// table, then written through a line-buffered stdio stream to /dev/null).
+// Both run from 1, 2 and 4 producer threads; every dlog record must come
+// out once and in order per producer, or be counted as dropped:
+//   g++ -std=c++17 -O2 -pthread -I main tools/dlog_bench.cpp -o dlog_bench
+//   ./dlog_bench [calls=1000000] [rounds=5]
+// The old path's cost on the device is dominated by the UART, which a
+// write to /dev/null does not have; the last line puts a number on it.
+#include "dlog_ring.hpp"
+#include "dlog_messages.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <time.h>
+#include <vector>
+
+namespace {
+
+#define DLOG_TAG_ENTRY(id, tag, fmt) tag,
+#define DLOG_FMT_ENTRY(id, tag, fmt) fmt,
+const char *const TAGS[] = { DLOG_MESSAGES(DLOG_TAG_ENTRY) };
+const char *const FMTS[] = { DLOG_MESSAGES(DLOG_FMT_ENTRY) };
+#undef DLOG_TAG_ENTRY
+#undef DLOG_FMT_ENTRY
+
+constexpr size_t RING_SIZE = 128;          // as dlog.cpp
+constexpr uint32_t UART_BAUD = 115200;     // CONFIG_ESP_CONSOLE_UART_BAUDRATE default
+constexpr DlogId MSG = DLOG_GAME3_MISS_WRONG;
+
+using Clock = std::chrono::steady_clock;
+
+inline uint32_t now_us()
+{
+  return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(Clock::now().time_since_epoch()).count();
+}
+
+// CPU time of the calling thread: with more producers than cores, wall
+// time would also count the other producers' slices
+inline int64_t cpu_ns()
+{
+  timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// What one cpu_ns() read adds to a timed interval (a system call on some
+// hosts), taken off each timed burst
+double clock_overhead_ns()
+{
+  constexpr int N = 20000;
+  int64_t sum = 0;
+  for (int i = 0; i < N; ++i) {
+    const int64_t t0 = cpu_ns();
+    sum += cpu_ns() - t0;
+  }
+  return (double)sum / N;
+}
+
+// ---- dlog: what dlog_write does, into one shared ring ----
+struct DlogRun {
+  double   ns_per_call;
+  uint64_t popped, dropped;
+  bool     in_order;
+};
+
+DlogRecord make_record(int producer, long i)
+{
+  DlogRecord r;
+  r.ts_us = now_us();
+  r.id = MSG;
+  r.nargs = 3;
+  r.args[0] = producer; r.args[1] = (int32_t)i; r.args[2] = 0;
+  return r;
+}
+
+// Producers push in bursts a frame might log and then wait for the drain,
+// so the ring has room as on the device; only the bursts are timed
+DlogRun run_dlog(int producers, long calls, double overhead_ns)
+{
+  constexpr long BURST = RING_SIZE / 8;
+  DlogRing<RING_SIZE> ring;
+  std::atomic<int> running{producers};
+  std::atomic<uint64_t> pushed{0}, popped{0};
+  std::vector<int32_t> last(producers, -1);
+  bool in_order = true;
+  std::thread drain([&] {
+    DlogRecord r;
+    for (;;) {
+      const bool last_pass = running.load(std::memory_order_acquire) == 0;
+      bool any = false;
+      while (ring.pop(r)) {
+        any = true;
+        in_order &= r.args[1] > last[r.args[0]];
+        last[r.args[0]] = r.args[1];
+        popped.fetch_add(1, std::memory_order_release);
+      }
+      if (last_pass) break;
+      if (!any) std::this_thread::yield();
+    }
+  });
+
+  std::vector<double> ns(producers);
+  std::vector<std::thread> ps;
+  for (int p = 0; p < producers; ++p)
+    ps.emplace_back([&, p] {
+      double spent = 0;
+      for (long i = 0; i < calls;) {
+        const long end = std::min(calls, i + BURST);
+        pushed.fetch_add((uint64_t)(end - i), std::memory_order_relaxed);
+        const int64_t t0 = cpu_ns();
+        for (; i < end; ++i) ring.push(make_record(p, i));
+        spent += (double)(cpu_ns() - t0) - overhead_ns;
+        while (popped.load(std::memory_order_acquire) + ring.dropped() + RING_SIZE / 2 <
+               pushed.load(std::memory_order_relaxed))
+          std::this_thread::yield();
+      }
+      ns[p] = spent / calls;
+      running.fetch_sub(1, std::memory_order_release);
+    });
+  for (std::thread &t : ps) t.join();
+  drain.join();
+  double sum = 0;
+  for (double v : ns) sum += v;
+  return { sum / producers, popped.load(), ring.dropped(), in_order };
+}
+
+// A ring nobody drains: every call after the first N is the drop path
+double run_full(long calls)
+{
+  DlogRing<RING_SIZE> ring;
+  const int64_t t0 = cpu_ns();
+  for (long i = 0; i < calls; ++i) ring.push(make_record(0, i));
+  const double ns = (double)(cpu_ns() - t0) / calls;
+  return ring.dropped() == (uint32_t)(calls - (long)RING_SIZE) ? ns : -1;
+}
+
+// ---- ESP_LOGI: "I (ms) TAG: message\n", formatted and written per call ----
+double run_logi(int producers, long calls, size_t &line_len)
+{
+  FILE *sink = std::fopen("/dev/null", "w");
+  if (!sink) return 0;
+  std::setvbuf(sink, nullptr, _IOLBF, 256);   // a write per line, as to the console UART
+  std::vector<double> ns(producers);
+  std::vector<size_t> len(producers);
+  std::vector<std::thread> ps;
+  for (int p = 0; p < producers; ++p)
+    ps.emplace_back([&, p] {
+      char msg[96], line[160];
+      const int64_t t0 = cpu_ns();
+      for (long i = 0; i < calls; ++i) {
+        std::snprintf(msg, sizeof(msg), FMTS[MSG], p, (int)i, 0);
+        const int n = std::snprintf(line, sizeof(line), "I (%u) %s: %s\n", (unsigned)(now_us() / 1000), TAGS[MSG], msg);
+        std::fwrite(line, 1, (size_t)n, sink);
+        len[p] = (size_t)n;
+      }
+      ns[p] = (double)(cpu_ns() - t0) / calls;
+    });
+  for (std::thread &t : ps) t.join();
+  std::fclose(sink);
+  line_len = len[0];
+  double sum = 0;
+  for (double v : ns) sum += v;
+  return sum / producers;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  long calls = 1000000;
+  int rounds = 5;
+  for (int i = 1; i < argc; ++i) {
+    const char *eq = std::strchr(argv[i], '=');
+    const std::string key = eq ? std::string(argv[i], eq - argv[i]) : argv[i];
+    const long v = eq ? std::atol(eq + 1) : 0;
+    if      (key == "calls" && v > 0)  calls = v;
+    else if (key == "rounds" && v > 0) rounds = (int)v;
+    else { std::fprintf(stderr, "usage: %s [calls=N] [rounds=N]\n", argv[0]); return 2; }
+  }
+
+  const double overhead = clock_overhead_ns();
+  std::printf("%ld calls per producer, best of %d, %u hardware threads; message \"%s\"\n", calls, rounds,
+              std::thread::hardware_concurrency(), FMTS[MSG]);
+  std::printf("dlog bursts of %zu calls, %.0f ns clock read taken off each\n", RING_SIZE / 8, overhead);
+  bool ok = true;
+  size_t line_len = 0;
+  for (int producers : { 1, 2, 4 }) {
+    DlogRun best = { 1e30, 0, 0, true };
+    double logi = 1e30;
+    for (int r = 0; r < rounds; ++r) {
+      const DlogRun d = run_dlog(producers, calls, overhead);
+      const bool counted = d.in_order && d.popped + d.dropped == (uint64_t)producers * calls;
+      if (!counted)
+        std::printf("  FAIL %d producers: %llu popped + %llu dropped of %ld, %s\n", producers,
+                    (unsigned long long)d.popped, (unsigned long long)d.dropped, producers * calls,
+                    d.in_order ? "in order" : "out of order");
+      ok &= counted;
+      if (d.ns_per_call < best.ns_per_call) best = d;
+      logi = std::min(logi, run_logi(producers, calls, line_len));
+    }
+    std::printf("  %d producer%s: dlog %6.1f ns/call (%.2f%% dropped)  ESP_LOGI path %7.1f ns/call  (%.0fx)\n",
+                producers, producers > 1 ? "s" : " ", best.ns_per_call,
+                100.0 * best.dropped / ((double)producers * calls), logi, logi / best.ns_per_call);
+  }
+  double full = 1e30;
+  for (int r = 0; r < rounds; ++r) {
+    const double f = run_full(calls);
+    if (f < 0) { std::printf("  FAIL full ring: drops not counted\n"); ok = false; break; }
+    full = std::min(full, f);
+  }
+  std::printf("  full ring (every call dropped): %.1f ns/call\n", full);
+  // 10 bits per byte on the wire; a caller blocks once the TX FIFO is full
+  std::printf("on the device the old path also clocks %zu bytes out at %u baud: %.0f us per line\n", line_len,
+              (unsigned)UART_BAUD, line_len * 10 * 1e6 / UART_BAUD);
+  std::printf("%s\n", ok ? "ok: every record popped once, in order per producer, or counted as dropped" : "FAIL");
+  return ok ? 0 : 1;
+}
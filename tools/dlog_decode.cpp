@@ -0,0 +1,57 @@
+// Host decoder for deferred-log records captured from the serial console
+// of a DLOG_BINARY_OUTPUT=1 build:
+//   g++ -std=c++17 -I main tools/dlog_decode.cpp -o dlog_decode
+//   idf.py monitor | tee capture.txt;  ./dlog_decode < capture.txt
+// Lines without a "DLOG:" record are passed through unchanged.
+#include "dlog_messages.hpp"
+#include "dlog_ring.hpp"
+#include <cstdio>
+#include <string>
+#include <iostream>
+
+#define DLOG_TAG_ENTRY(id, tag, fmt) tag,
+#define DLOG_FMT_ENTRY(id, tag, fmt) fmt,
+static const char *const TAGS[] = { DLOG_MESSAGES(DLOG_TAG_ENTRY) };
+static const char *const FMTS[] = { DLOG_MESSAGES(DLOG_FMT_ENTRY) };
+
+static int hexval(char c)
+{
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+static bool parse(const char *hex, DlogRecord &r)
+{
+  uint8_t *b = reinterpret_cast<uint8_t *>(&r);
+  for (size_t i = 0; i < sizeof(r); ++i) {
+    int hi = hexval(hex[i * 2]), lo = (hi < 0) ? -1 : hexval(hex[i * 2 + 1]);
+    if (hi < 0 || lo < 0) return false;
+    b[i] = (uint8_t)(hi << 4 | lo);
+  }
+  return true;
+}
+
+int main()
+{
+  std::string line;
+  uint32_t last_ts = 0;
+  uint64_t wrap = 0;
+  while (std::getline(std::cin, line)) {
+    size_t at = line.find("DLOG:");
+    DlogRecord r;
+    if (at == std::string::npos || line.size() < at + 5 + sizeof(r) * 2 || !parse(line.c_str() + at + 5, r)) {
+      std::cout << line << '\n';
+      continue;
+    }
+    if (r.ts_us < last_ts) wrap += 1ull << 32;   // 32-bit microseconds wrap every ~71 min
+    last_ts = r.ts_us;
+    double ms = (double)(wrap + r.ts_us) / 1000.0;
+    if (r.id >= DLOG_COUNT) { std::printf("%12.3f ms  ?  unknown id %u\n", ms, r.id); continue; }
+    char msg[128];
+    std::snprintf(msg, sizeof(msg), FMTS[r.id], r.args[0], r.args[1], r.args[2]);
+    std::printf("%12.3f ms  %-6s %s\n", ms, TAGS[r.id], msg);
+  }
+  return 0;
+}
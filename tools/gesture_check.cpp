@@ -0,0 +1,240 @@
+// Host replay of touch traces through the gesture recognizer, and a
+// per-sample cost benchmark:
+//   g++ -std=c++17 -O2 -I main tools/gesture_check.cpp main/gesture.cpp -o gesture_check
+//   ./gesture_check tools/gesture_traces/*.trace [verbose=1]
+//   ./gesture_check bench=1 [samples=2000000] [seed=1]
+// A trace is "t_ms pressed x y" lines, as the console "touch" command
+// prints them; anything else (log lines from a UART capture) is skipped.
+// "# config key=value ..." overrides GestureConfig fields and
+// "# expect ..." lists the events the trace must produce, a run of DRAG
+// events counting as one. SWIPE:left checks the direction and TAP@x,y the
+// tap position (within 6 px). Exits non-zero when any trace differs.
+#include "gesture.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#else
+#define HAVE_TSC 0
+#endif
+
+namespace {
+
+const char *const TYPE_NAMES[] = { "NONE", "DOWN", "LONG_PRESS", "DRAG_START", "DRAG", "TAP", "SWIPE", "DRAG_END", "UP" };
+const char *const DIR_NAMES[] = { "left", "right", "up", "down" };
+
+struct Sample {
+  uint32_t t;
+  bool     pressed;
+  uint16_t x, y;
+};
+
+bool set_config(GestureConfig &c, const std::string &kv)
+{
+  const size_t eq = kv.find('=');
+  if (eq == std::string::npos) return false;
+  const std::string k = kv.substr(0, eq);
+  const uint16_t v = (uint16_t)std::atoi(kv.c_str() + eq + 1);
+  if      (k == "slop_px")       c.slop_px = v;
+  else if (k == "tap_max_ms")    c.tap_max_ms = v;
+  else if (k == "long_press_ms") c.long_press_ms = v;
+  else if (k == "swipe_min_px")  c.swipe_min_px = v;
+  else if (k == "swipe_max_ms")  c.swipe_max_ms = v;
+  else if (k == "debounce_ms")   c.debounce_ms = v;
+  else if (k == "jump_px")       c.jump_px = v;
+  else return false;
+  return true;
+}
+
+std::vector<std::string> words(const char *s)
+{
+  std::vector<std::string> out;
+  char buf[256];
+  std::snprintf(buf, sizeof(buf), "%s", s);
+  for (char *w = std::strtok(buf, " \t\r\n"); w; w = std::strtok(nullptr, " \t\r\n")) out.push_back(w);
+  return out;
+}
+
+// Matches one expected token against one event
+bool matches(const std::string &want, const GestureEvent &ev)
+{
+  const size_t colon = want.find(':'), at = want.find('@');
+  const std::string name = want.substr(0, std::min(colon, at));
+  if (name != TYPE_NAMES[ev.type]) return false;
+  if (colon != std::string::npos && want.substr(colon + 1) != DIR_NAMES[ev.dir]) return false;
+  if (at != std::string::npos) {
+    int x = 0, y = 0;
+    if (std::sscanf(want.c_str() + at + 1, "%d,%d", &x, &y) != 2) return false;
+    if (std::abs(ev.x - x) > 6 || std::abs(ev.y - y) > 6) return false;
+  }
+  return true;
+}
+
+bool replay(const char *path, bool verbose)
+{
+  FILE *f = std::fopen(path, "r");
+  if (!f) { std::printf("  [FAIL] %s: cannot open\n", path); return false; }
+  GestureConfig cfg;
+  std::vector<std::string> expect;
+  std::vector<Sample> samples;
+  char line[256];
+  bool ok = true;
+  while (std::fgets(line, sizeof(line), f)) {
+    if (!std::strncmp(line, "# expect", 8)) {
+      expect = words(line + 8);
+    } else if (!std::strncmp(line, "# config", 8)) {
+      for (const std::string &kv : words(line + 8))
+        if (!set_config(cfg, kv)) { std::printf("  [FAIL] %s: bad config %s\n", path, kv.c_str()); ok = false; }
+    } else {
+      unsigned t, p, x, y;
+      if (std::sscanf(line, "%u %u %u %u", &t, &p, &x, &y) == 4) samples.push_back({ t, p != 0, (uint16_t)x, (uint16_t)y });
+    }
+  }
+  std::fclose(f);
+
+  GestureRecognizer g(cfg);
+  std::vector<GestureEvent> events;
+  for (const Sample &s : samples) {
+    GestureEvent ev;
+    if (!g.feed(s.t, s.pressed, s.x, s.y, ev)) continue;
+    if (verbose)
+      std::printf("    %10u %-10s x=%d y=%d dx=%d dy=%d %u ms%s%s\n", (unsigned)s.t, TYPE_NAMES[ev.type], ev.x, ev.y,
+                  ev.dx, ev.dy, (unsigned)ev.ms, ev.type == GESTURE_SWIPE ? " " : "",
+                  ev.type == GESTURE_SWIPE ? DIR_NAMES[ev.dir] : "");
+    if (ev.type == GESTURE_DRAG && !events.empty() && events.back().type == GESTURE_DRAG) continue;
+    events.push_back(ev);
+  }
+  if (g.active()) ok = false;   // a trace must end with the finger gone
+
+  std::string got;
+  for (const GestureEvent &ev : events) got += std::string(got.empty() ? "" : " ") + TYPE_NAMES[ev.type];
+  ok = ok && events.size() == expect.size();
+  for (size_t i = 0; ok && i < expect.size(); ++i) ok = matches(expect[i], events[i]);
+  const char *name = std::strrchr(path, '/');
+  std::printf("  [%s] %-22s %4zu samples: %s\n", ok ? "ok" : "FAIL", name ? name + 1 : path, samples.size(), got.c_str());
+  if (!ok) {
+    std::string want;
+    for (const std::string &w : expect) want += " " + w;
+    std::printf("         expected:%s\n", want.c_str());
+  }
+  return ok;
+}
+
+// ---- Benchmark ----
+
+uint32_t s_rng = 1;
+int rnd(int lo, int hi)
+{
+  s_rng ^= s_rng << 13; s_rng ^= s_rng >> 17; s_rng ^= s_rng << 5;
+  return lo + (int)(s_rng % (uint32_t)(hi - lo + 1));
+}
+
+// A synthetic finger at 60 Hz: gaps, taps, holds, drags and flicks, with
+// jitter, dropouts and the odd misread sample
+std::vector<Sample> synth(size_t n)
+{
+  std::vector<Sample> out;
+  out.reserve(n);
+  uint32_t t = 0xFFFFFFFFu - 100000;   // crosses the wrap early on
+  while (out.size() < n) {
+    for (int i = rnd(2, 30); i > 0; --i, t += 16) out.push_back({ t, false, 0, 0 });
+    const int kind = rnd(0, 3), frames = kind == 0 ? rnd(2, 12) : kind == 1 ? rnd(30, 120) : rnd(6, 60);
+    int x = rnd(0, 319), y = rnd(0, 239);
+    const int vx = kind >= 2 ? rnd(-kind * 6, kind * 6) : 0, vy = kind >= 2 ? rnd(-kind * 6, kind * 6) : 0;
+    for (int i = 0; i < frames; ++i, t += 16) {
+      x = std::max(0, std::min(319, x + vx)); y = std::max(0, std::min(239, y + vy));
+      if (rnd(0, 99) < 2) { out.push_back({ t, false, 0, 0 }); continue; }
+      const int spike = rnd(0, 99) < 1 ? 100 : 0;
+      out.push_back({ t, true, (uint16_t)std::min(319, x + rnd(-2, 2) + spike), (uint16_t)std::max(0, y + rnd(-2, 2) - spike) });
+    }
+  }
+  out.resize(n);
+  return out;
+}
+
+inline uint64_t ticks()
+{
+#if HAVE_TSC
+  return __rdtsc();
+#else
+  return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+int bench(size_t n)
+{
+  const std::vector<Sample> s = synth(n);
+  GestureRecognizer g;
+  GestureEvent ev;
+  unsigned events = 0, downs = 0, ends = 0;
+  bool open = false, paired = true;
+
+  const auto t0 = std::chrono::steady_clock::now();
+  const uint64_t c0 = ticks();
+  for (const Sample &x : s) {
+    if (!g.feed(x.t, x.pressed, x.x, x.y, ev)) continue;
+    ++events;
+    // The games rely on each contact being one DOWN and one terminal event
+    if (ev.type == GESTURE_DOWN) { paired = paired && !open; open = true; ++downs; }
+    if (ev.type >= GESTURE_TAP)  { paired = paired && open; open = false; ++ends; }
+  }
+  const uint64_t c1 = ticks();
+  const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+
+  // Per-call timing includes the counter read, so it bounds rather than measures
+  std::vector<uint32_t> per(n);
+  GestureRecognizer g2;
+  for (size_t i = 0; i < n; ++i) {
+    const uint64_t a = ticks();
+    g2.feed(s[i].t, s[i].pressed, s[i].x, s[i].y, ev);
+    per[i] = (uint32_t)(ticks() - a);
+  }
+  std::sort(per.begin(), per.end());
+
+  const char *unit = HAVE_TSC ? "cycles" : "ns";
+  std::printf("%zu samples, %u events (%u contacts): %.1f ns/sample, %.1f %s/sample\n", n, events, downs, ns / n,
+              (double)(c1 - c0) / n, unit);
+  std::printf("per call incl. timer read: p50 %u  p99 %u  p99.99 %u  max %u %s (max includes preemption)\n", (unsigned)per[n / 2],
+              (unsigned)per[n * 99 / 100], (unsigned)per[n - 1 - n / 10000], (unsigned)per[n - 1], unit);
+  std::printf("  [%s] every DOWN closed by exactly one TAP/SWIPE/DRAG_END/UP\n", paired && downs - ends <= 1 ? "ok" : "FAIL");
+  std::printf("  [%s] sizeof(GestureRecognizer) = %zu bytes\n", sizeof(GestureRecognizer) <= 48 ? "ok" : "FAIL",
+              sizeof(GestureRecognizer));
+  return paired && downs - ends <= 1 && sizeof(GestureRecognizer) <= 48 ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  bool verbose = false, do_bench = false;
+  size_t samples = 2000000;
+  std::vector<const char *> traces;
+  for (int i = 1; i < argc; ++i) {
+    const char *eq = std::strchr(argv[i], '=');
+    if (!eq) { traces.push_back(argv[i]); continue; }
+    const std::string key(argv[i], eq - argv[i]);
+    const long v = std::atol(eq + 1);
+    if      (key == "verbose") verbose = v != 0;
+    else if (key == "bench")   do_bench = v != 0;
+    else if (key == "samples") samples = v > 0 ? (size_t)v : samples;
+    else if (key == "seed")    s_rng = v ? (uint32_t)v : 1;
+    else { std::fprintf(stderr, "unknown option %s\n", key.c_str()); return 2; }
+  }
+  if (traces.empty() && !do_bench) {
+    std::fprintf(stderr, "usage: %s TRACE... [verbose=1] | bench=1 [samples=N] [seed=N]\n", argv[0]);
+    return 2;
+  }
+
+  int fails = 0;
+  for (const char *t : traces) fails += !replay(t, verbose);
+  if (!traces.empty()) std::printf("%zu traces, %d failed\n", traces.size(), fails);
+  if (do_bench) fails += bench(samples);
+  return fails ? 1 : 0;
+}
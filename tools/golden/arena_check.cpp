@@ -0,0 +1,196 @@
+// Host check of the effect arena when it runs short: a bare Arena grants
+// partial arrays or nothing (never half an allocation) and counts every
+// refusal once; borrow_effects() on the shared arena degrades slot by slot
+// to smaller and then empty pools, and reset() brings the full pools back.
+// Then each game plays on full, partial and empty pools with the rest of
+// the arena fenced off, and must run without touching the fence:
+//   MAIN="game_common game_sched game_tap_ball game_whack game_memory_grid scene rect_merge blend565
+//         effect_arena quality gesture latency tap_stats snapshot score_log autoplay_bot"
+//   g++ -std=gnu++17 -O2 -DLGFX_HEADLESS=1 -DTOUCH_DMA_DRIVER=0 -DENABLE_GAME_SWITCH=1
+//       -I tools/golden/include -I tools/host_lgfx -I main -o arena_check
+//       tools/golden/arena_check.cpp tools/golden/host_idf.cpp $(for m in $MAIN; do echo main/$m.cpp; done)
+//   ./arena_check [frames=3000]
+// Exits non-zero when any case fails.
+#include "game_common.hpp"
+#include "games.hpp"
+#include "effect_arena.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace {
+
+constexpr int DISPLAY_ROTATION = 1;   // as main.cpp
+constexpr uint8_t FENCE = 0xA5;
+
+int g_failures = 0;
+
+void check(bool ok, const char *what)
+{
+  std::printf("  [%s] %s\n", ok ? "ok" : "FAIL", what);
+  if (!ok) ++g_failures;
+}
+
+struct Odd { uint8_t b[3]; };
+struct Wide { uint64_t v; };
+
+void bare_arena()
+{
+  alignas(8) static uint8_t buf[100];
+  Arena a(buf, sizeof(buf));
+  size_t got = 99;
+
+  Odd *o = a.alloc_array<Odd>(5, 1, got);
+  check(o && got == 5 && a.used() == 15, "alloc_array: a request that fits is granted whole");
+  Wide *w = a.alloc_array<Wide>(20, 1, got);
+  check(w && got == 10 && reinterpret_cast<uintptr_t>(w) % alignof(Wide) == 0 && a.used() == 96,
+        "alloc_array: a request that does not fit is cut to what fits, after alignment");
+  check(w[0].v == 0 && w[9].v == 0, "alloc_array: granted elements are value-initialised");
+
+  const size_t used = a.used();
+  check(!a.alloc_array<Wide>(4, 1, got) && got == 0 && a.failures() == 1 && a.used() == used,
+        "alloc_array: nothing left grants nothing, takes nothing, counts one failure");
+  check(!a.alloc(8, 8) && a.failures() == 2 && a.used() == used, "alloc: too big counts one failure, takes nothing");
+  check(a.alloc(4, 1) && a.used() == 100 && a.fit_count(1, 1) == 0, "alloc: the last bytes can still be taken");
+
+  a.reset();
+  check(a.used() == 0 && a.high_water() == 100 && a.failures() == 2, "reset: empty again, high water and failures kept");
+  check(!a.alloc_array<Wide>(20, 13, got) && got == 0 && a.failures() == 3 && a.used() == 0,
+        "alloc_array: fewer than min_count grants none");
+  check(a.alloc_array<Wide>(20, 12, got) && got == 12, "reset: the whole buffer is available again");
+}
+
+// Borrows until a slot gets nothing, as more screens than the arena was
+// sized for would
+void shared_arena()
+{
+  Arena &arena = effect_arena();
+  arena.reset();
+  const uint32_t f0 = arena.failures();
+  Effects fx[8];
+  int n = 0;
+  uint32_t failed_calls = 0;
+  bool shrinking = true, in_bounds = true;
+  do {
+    fx[n] = borrow_effects();
+    failed_calls += (fx[n].max_parts == 0) + (fx[n].max_ripples == 0);
+    if (n > 0) shrinking &= fx[n].max_parts + fx[n].max_ripples <= fx[n - 1].max_parts + fx[n - 1].max_ripples;
+    in_bounds &= arena.used() <= arena.capacity();
+    ++n;
+  } while (n < 8 && (fx[n - 1].max_parts || fx[n - 1].max_ripples));
+
+  std::printf("  %zu-byte arena: ", arena.capacity());
+  for (int i = 0; i < n; ++i) std::printf("%s%d+%d", i ? ", " : "", fx[i].max_parts, fx[i].max_ripples);
+  std::printf(" particles+ripples per borrow\n");
+
+  check(fx[0].max_parts == MAX_PARTICLES && fx[0].max_ripples == MAX_RIPPLES, "borrow: the first slot gets full pools");
+  check(n > 1 && (fx[1].max_parts < MAX_PARTICLES || fx[1].max_ripples < MAX_RIPPLES),
+        "borrow: a slot past the arena's sizing gets smaller pools");
+  const Effects &last = fx[n - 1];
+  check(!last.max_parts && !last.max_ripples && !last.parts && !last.ripples, "borrow: an exhausted arena gives empty pools");
+  check(shrinking && in_bounds, "borrow: pools only shrink and stay inside the arena");
+  check(arena.failures() - f0 == failed_calls, "failures: one per pool that got nothing");
+
+  arena.reset();
+  const Effects again = borrow_effects();
+  check(again.max_parts == MAX_PARTICLES && again.max_ripples == MAX_RIPPLES && again.parts == fx[0].parts,
+        "reset: the next borrow gets full pools from the start of the arena");
+}
+
+// ---- Games on short pools ----
+AutoplayBot *s_bot = nullptr;
+int s_calls = 0, s_frames = 0;
+
+bool bot_touch(uint16_t &x, uint16_t &y)
+{
+  if (s_calls++ >= s_frames) return false;
+  return s_bot->sample(game_millis(), current_aim(), x, y);
+}
+
+// Leaves `room` bytes for the pools and fills the rest of the arena, before
+// and after them, with a fence pattern
+struct Fenced {
+  uint8_t *head, *tail;
+  size_t   head_len, tail_len;
+};
+
+Effects borrow_fenced(size_t room, Fenced &f)
+{
+  Arena &arena = effect_arena();
+  arena.reset();
+  f.head_len = arena.capacity() - room;
+  f.head = static_cast<uint8_t *>(arena.alloc(f.head_len, 1));
+  Effects fx = borrow_effects();
+  f.tail_len = arena.capacity() - arena.used();
+  f.tail = f.tail_len ? static_cast<uint8_t *>(arena.alloc(f.tail_len, 1)) : nullptr;
+  if (f.head) std::memset(f.head, FENCE, f.head_len);
+  if (f.tail) std::memset(f.tail, FENCE, f.tail_len);
+  return fx;
+}
+
+bool fence_intact(const Fenced &f)
+{
+  for (size_t i = 0; i < f.head_len; ++i) if (f.head[i] != FENCE) return false;
+  for (size_t i = 0; i < f.tail_len; ++i) if (f.tail[i] != FENCE) return false;
+  return true;
+}
+
+void games_on(LGFX &gfx, Scene &scene, const char *name, size_t room, int frames)
+{
+  const char *const GAME_NAMES[GAME_COUNT] = { "tap_ball", "whack", "memory_grid" };
+  for (int g = 0; g < GAME_COUNT; ++g) {
+    Fenced fence;
+    Effects fx = borrow_fenced(room, fence);
+    rand_seed(1);
+    clock_use_virtual(0);
+    gesture_reset();
+    AutoplayBot bot(7 + g, gfx.width(), gfx.height(), HUD_H);
+    bot.set_profile({ 8.0f, 200, 40, 48, 10 });
+    s_bot = &bot;
+    s_calls = 0;
+    s_frames = frames;
+    GameScheduler sched(GAME_FACTORIES, GAME_COUNT, gesture_input, &gfx);
+    sched.start(0, g, game_view(&scene, &fx, 0, 0, 0, gfx.width(), gfx.height()));
+    while (s_calls <= frames) run_frame(sched, scene);
+    sched.stop(0);
+    s_bot = nullptr;
+
+    char what[128];
+    std::snprintf(what, sizeof(what), "%s on %s pools (%d+%d): %u taps, nothing written outside the pools",
+                  GAME_NAMES[g], name, fx.max_parts, fx.max_ripples, (unsigned)bot.stats().taps);
+    check(fence_intact(fence) && bot.stats().taps > 0, what);
+  }
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  int frames = 3000;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strncmp(argv[i], "frames=", 7) == 0 && std::atoi(argv[i] + 7) > 0) frames = std::atoi(argv[i] + 7);
+    else { std::fprintf(stderr, "usage: %s [frames=N]\n", argv[0]); return 2; }
+  }
+
+  std::printf("Effect arena under exhaustion\n");
+  bare_arena();
+  shared_arena();
+
+  static LGFX gfx;
+  if (!gfx.init()) { std::fprintf(stderr, "canvas allocation failed\n"); return 2; }
+  gfx.setRotation(DISPLAY_ROTATION);
+  static Scene scene(gfx);
+  set_touch_source(bot_touch);
+  quality_pin(QUALITY_DEFAULT_TIER);   // the governor reacts to host timing
+
+  const size_t full = MAX_PARTICLES * sizeof(Particle) + MAX_RIPPLES * sizeof(Ripple) + 16;
+  games_on(gfx, scene, "full", full, frames);
+  games_on(gfx, scene, "partial", 10 * sizeof(Particle) + 4, frames);
+  games_on(gfx, scene, "particles only", MAX_PARTICLES * sizeof(Particle) + 4, frames);
+  games_on(gfx, scene, "empty", 0, frames);
+  effect_arena().reset();
+
+  std::printf("%s: %d failures\n", g_failures ? "FAIL" : "ok", g_failures);
+  return g_failures ? 1 : 0;
+}
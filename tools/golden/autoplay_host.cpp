@@ -0,0 +1,120 @@
+// Host soak run: the AUTOPLAY_BOT driver (main/autoplay.cpp, same player
+// profiles, game switches and per-minute reports) plays the real games
+// headless on the virtual clock, as fast as the host can draw. Fails when
+// a report window's frame cost goes over the limits, or when the panel
+// traffic the frames flush goes over what the SPI bus moves in the
+// governor's budget. From the repo root:
+//   MAIN="game_common game_sched game_tap_ball game_whack game_memory_grid scene rect_merge blend565
+//         effect_arena quality gesture latency tap_stats snapshot score_log autoplay_bot autoplay"
+//   g++ -std=gnu++17 -O2 -DLGFX_HEADLESS=1 -DTOUCH_DMA_DRIVER=0 -DENABLE_GAME_SWITCH=1
+//       -I tools/golden/include -I tools/host_lgfx -I main -o autoplay_host
+//       tools/golden/autoplay_host.cpp tools/golden/host_idf.cpp $(for m in $MAIN; do echo main/$m.cpp; done)
+//   ./autoplay_host [frames=2000000] [seed=1] [avg=US] [max=US] [px=N]
+// avg/max default to AUTOPLAY_AVG_LIMIT_US/AUTOPLAY_MAX_LIMIT_US, the device
+// limits; host frames cost a small fraction of that, so pass tighter ones
+// to catch a slowdown here. px is the average flushed pixels per frame.
+#include "game_common.hpp"
+#include "games.hpp"
+#include "autoplay.hpp"
+#include "effect_arena.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace {
+
+constexpr int DISPLAY_ROTATION = 1;   // as main.cpp
+
+// 16-bit pixels at the panel clock, within the governor's frame budget
+constexpr uint32_t PX_LIMIT = (uint32_t)((uint64_t)TFT_FREQ / 16 * QUALITY_BUDGET_US / 1000000);
+
+struct Options {
+  uint64_t frames = 2000000;
+  uint32_t seed = 1;
+  uint32_t avg_us = AUTOPLAY_AVG_LIMIT_US;
+  uint32_t max_us = AUTOPLAY_MAX_LIMIT_US;
+  uint32_t px = PX_LIMIT;
+};
+
+bool parse(int argc, char **argv, Options &o)
+{
+  for (int i = 1; i < argc; ++i) {
+    const char *eq = std::strchr(argv[i], '=');
+    if (!eq) return false;
+    const std::string key(argv[i], eq - argv[i]);
+    const unsigned long long v = std::strtoull(eq + 1, nullptr, 0);
+    if      (key == "frames") o.frames = v;
+    else if (key == "seed")   o.seed = (uint32_t)v;
+    else if (key == "avg")    o.avg_us = (uint32_t)v;
+    else if (key == "max")    o.max_us = (uint32_t)v;
+    else if (key == "px")     o.px = (uint32_t)v;
+    else return false;
+  }
+  return o.frames > 0 && o.avg_us > 0 && o.max_us > 0 && o.px > 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  Options o;
+  if (!parse(argc, argv, o)) {
+    std::fprintf(stderr, "usage: %s [frames=N] [seed=N] [avg=US] [max=US] [px=N]\n", argv[0]);
+    return 2;
+  }
+
+  static LGFX gfx;
+  if (!gfx.init()) { std::fprintf(stderr, "canvas allocation failed\n"); return 2; }
+  gfx.setRotation(DISPLAY_ROTATION);
+  static Scene scene(gfx);
+  autoplay_start(o.seed, scene);
+  autoplay_set_limits(o.avg_us, o.max_us);
+
+  static Effects fx;
+  static GameScheduler sched(GAME_FACTORIES, GAME_COUNT, gesture_input, &gfx);
+  const int sw = gfx.width(), sh = gfx.height();
+  tap_stats_screen(sw, sh);
+  fx = borrow_effects();
+  sched.start(0, 0, game_view(&scene, &fx, 0, 0, 0, sw, sh));
+
+  // Flush counters are 32-bit; fold them in before they can wrap
+  uint64_t pixels = 0, windows = 0, rects = 0;
+  FlushStats last = scene.flush_stats();
+  auto fold = [&] {
+    const FlushStats &fs = scene.flush_stats();
+    pixels += fs.pixels - last.pixels;
+    windows += fs.windows - last.windows;
+    rects += fs.dirty_rects - last.dirty_rects;
+    last = fs;
+  };
+
+  const auto t0 = std::chrono::steady_clock::now();
+  for (uint64_t f = 0; f < o.frames; ++f) {
+    run_frame(sched, scene);
+    if (f % 4096 == 4095) fold();
+  }
+  fold();
+  autoplay_report();
+  const double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+  const BotStats &bs = autoplay_bot_stats();
+  const double virt_s = (double)o.frames * FRAME_MS / 1000;
+  const double px_avg = (double)pixels / o.frames;
+  std::printf("%llu frames (%.1f virtual hours) in %.1f s: %.0f frames/s, %.0fx real time\n",
+              (unsigned long long)o.frames, virt_s / 3600, s, o.frames / s, virt_s / s);
+  std::printf("bot: %llu frames, %u taps, %u stray, %u clock wraps\n", (unsigned long long)bs.frames,
+              (unsigned)bs.taps, (unsigned)bs.stray_taps, (unsigned)bs.clock_wraps);
+  std::printf("flush: %.2f dirty rects -> %.2f windows, %.0f px per frame (limit %u)\n", (double)rects / o.frames,
+              (double)windows / o.frames, px_avg, (unsigned)o.px);
+  const AutoplayCost &cost = autoplay_cost();
+  std::printf("frame cost: worst window avg=%uus max=%uus; %u windows over avg=%uus max=%uus\n",
+              (unsigned)cost.worst_avg_us, (unsigned)cost.worst_max_us, (unsigned)cost.regressions, (unsigned)o.avg_us,
+              (unsigned)o.max_us);
+
+  const bool ok = cost.regressions == 0 && px_avg <= o.px && bs.clock_wraps > 0;
+  if (!bs.clock_wraps) std::printf("the virtual clock never wrapped\n");
+  std::printf("%s\n", ok ? "ok" : "FAIL");
+  return ok ? 0 : 1;
+}
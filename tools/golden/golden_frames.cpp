@@ -0,0 +1,333 @@
+// Golden-frame regression harness: runs each game headless with a fixed
+// seed and a scripted player, hashes the whole framebuffer every N frames
+// and compares the hashes with golden_frames.txt, so a renderer change
+// that moves a single pixel fails here instead of on someone's desk.
+//
+// Builds against the software LovyanGFX stand-in in tools/host_lgfx (the
+// same canvas scene_check uses; no LovyanGFX checkout or SDL). From the
+// repo root:
+//   MAIN="game_common game_sched game_tap_ball game_whack game_memory_grid scene rect_merge blend565
+//         effect_arena quality gesture latency tap_stats snapshot score_log autoplay_bot"
+//   g++ -std=gnu++17 -O2 -DLGFX_HEADLESS=1 -DTOUCH_DMA_DRIVER=0 -DENABLE_GAME_SWITCH=1
+//       -I tools/golden/include -I tools/host_lgfx -I main -o golden_frames
+//       tools/golden/golden_frames.cpp tools/golden/host_idf.cpp $(for m in $MAIN; do echo main/$m.cpp; done)
+//
+//   ./golden_frames                  compare with tools/golden/golden_frames.txt
+//   ./golden_frames update=1         re-record it (review the diff before committing)
+//   ./golden_frames dump=DIR         also write every checkpoint frame as DIR/<game>_<frame>.ppm
+//   ./golden_frames ref=DIR          on mismatch, diff against DIR (a dump from a known-good build)
+// Other options: seed=N every=N frames=N golden=PATH out=DIR (mismatch images, default golden_out).
+// The first differing checkpoint of each game is written to out/ with a
+// diff image when a reference frame exists; every=1 pins the exact frame.
+#include "game_common.hpp"
+#include "games.hpp"
+#include "effect_arena.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+namespace {
+
+constexpr int DISPLAY_ROTATION = 1;   // as main.cpp
+
+const char *const GAME_NAMES[GAME_COUNT] = { "tap_ball", "whack", "memory_grid" };
+
+// Scripted player per game: sloppy enough to exercise hits, misses and
+// stray taps on the play field, never the title bar
+const BotProfile SCRIPT[GAME_COUNT] = {
+  /* GAME_TAP_BALL    */ { 10.0f, 250, 60, 48, 10 },
+  /* GAME_WHACK       */ {  8.0f, 220, 50, 48, 10 },
+  /* GAME_MEMORY_GRID */ { 16.0f, 300, 80, 64, 15 },
+};
+
+struct Options {
+  uint32_t    seed = 1;
+  int         every = 5;
+  int         frames = 900;
+  bool        update = false;
+  std::string golden = "tools/golden/golden_frames.txt";
+  std::string out = "golden_out";
+  std::string ref, dump;
+};
+
+// ---- Frame hash ----
+// Four independent multiply-rotate lanes over 64-bit words, folded with a
+// murmur finaliser: one pass over a 150 KB frame in tens of microseconds
+inline uint64_t rotl(uint64_t v, int s) { return v << s | v >> (64 - s); }
+inline uint64_t lane(uint64_t h, uint64_t w) { return rotl(h ^ (w * 0x9E3779B97F4A7C15ull), 31) * 0xC2B2AE3D27D4EB4Full; }
+
+uint64_t frame_hash(const uint16_t *px, size_t count)
+{
+  uint64_t h[4] = { 1, 2, 3, 4 };
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    uint64_t w[4];
+    std::memcpy(w, px + i, sizeof(w));
+    for (int l = 0; l < 4; ++l) h[l] = lane(h[l], w[l]);
+  }
+  uint64_t v = rotl(h[0], 1) + rotl(h[1], 7) + rotl(h[2], 12) + rotl(h[3], 18) + count;
+  for (; i < count; ++i) v = lane(v, px[i]);
+  v ^= v >> 33; v *= 0xFF51AFD7ED558CCDull;
+  v ^= v >> 33; v *= 0xC4CEB9FE1A85EC53ull;
+  return v ^ (v >> 33);
+}
+
+// ---- Images (binary PPM; pixels are byte-swapped RGB565 as read back) ----
+void rgb(uint16_t be, uint8_t *out)
+{
+  const uint16_t c = (uint16_t)(be << 8 | be >> 8);
+  out[0] = (uint8_t)((c >> 11) * 255 / 31);
+  out[1] = (uint8_t)(((c >> 5) & 63) * 255 / 63);
+  out[2] = (uint8_t)((c & 31) * 255 / 31);
+}
+
+bool write_ppm(const std::string &path, const std::vector<uint8_t> &rgb888, int w, int h)
+{
+  FILE *f = std::fopen(path.c_str(), "wb");
+  if (!f) { std::fprintf(stderr, "cannot write %s\n", path.c_str()); return false; }
+  std::fprintf(f, "P6\n%d %d\n255\n", w, h);
+  std::fwrite(rgb888.data(), 1, rgb888.size(), f);
+  std::fclose(f);
+  return true;
+}
+
+bool write_frame(const std::string &path, const std::vector<uint16_t> &px, int w, int h)
+{
+  std::vector<uint8_t> img(px.size() * 3);
+  for (size_t i = 0; i < px.size(); ++i) rgb(px[i], &img[i * 3]);
+  return write_ppm(path, img, w, h);
+}
+
+bool read_ppm(const std::string &path, std::vector<uint8_t> &rgb888, int w, int h)
+{
+  FILE *f = std::fopen(path.c_str(), "rb");
+  if (!f) return false;
+  int fw = 0, fh = 0, maxv = 0;
+  const bool ok = std::fscanf(f, "P6 %d %d %d", &fw, &fh, &maxv) == 3 && std::fgetc(f) != EOF && fw == w &&
+                  fh == h && maxv == 255;
+  rgb888.resize((size_t)w * h * 3);
+  const bool full = ok && std::fread(rgb888.data(), 1, rgb888.size(), f) == rgb888.size();
+  std::fclose(f);
+  return full;
+}
+
+// Differing pixels in red over a dimmed copy of the new frame
+void write_diff(const std::string &path, const std::vector<uint16_t> &px, const std::vector<uint8_t> &ref, int w, int h)
+{
+  std::vector<uint8_t> img(px.size() * 3);
+  int n = 0, x0 = w, y0 = h, x1 = -1, y1 = -1;
+  for (int y = 0; y < h; ++y) for (int x = 0; x < w; ++x) {
+    const size_t i = (size_t)y * w + x;
+    uint8_t *o = &img[i * 3];
+    rgb(px[i], o);
+    if (std::memcmp(o, &ref[i * 3], 3)) {
+      o[0] = 255; o[1] = o[2] = 0;
+      ++n;
+      x0 = std::min(x0, x); y0 = std::min(y0, y); x1 = std::max(x1, x); y1 = std::max(y1, y);
+    } else {
+      const uint8_t g = (uint8_t)((o[0] + o[1] + o[2]) / 9);
+      o[0] = o[1] = o[2] = g;
+    }
+  }
+  if (write_ppm(path, img, w, h))
+    std::printf("    %d pixels differ in (%d,%d)-(%d,%d); diff image %s\n", n, x0, y0, x1, y1, path.c_str());
+}
+
+// ---- Golden file: "<game> <frame> <hash>" lines, '#' comments ----
+std::string params_line(const Options &o)
+{
+  char line[96];
+  std::snprintf(line, sizeof(line), "# seed=%u every=%d frames=%d", (unsigned)o.seed, o.every, o.frames);
+  return line;
+}
+
+bool load_golden(const Options &o, std::map<std::string, uint64_t> &out)
+{
+  FILE *f = std::fopen(o.golden.c_str(), "r");
+  if (!f) { std::fprintf(stderr, "no golden file %s (record one with update=1)\n", o.golden.c_str()); return false; }
+  char line[128];
+  bool params_ok = false;
+  while (std::fgets(line, sizeof(line), f)) {
+    line[std::strcspn(line, "\r\n")] = 0;
+    if (line[0] == '#') { params_ok |= params_line(o) == line; continue; }
+    char game[32];
+    int frame;
+    unsigned long long hash;
+    if (std::sscanf(line, "%31s %d %llx", game, &frame, &hash) == 3) out[std::string(game) + " " + std::to_string(frame)] = hash;
+  }
+  std::fclose(f);
+  if (params_ok && out.empty())
+    std::fprintf(stderr, "%s has no hashes yet; record them with update=1\n", o.golden.c_str());
+  if (!params_ok) {
+    std::fprintf(stderr, "%s was recorded with different options; expected '%s'\n", o.golden.c_str(),
+                 params_line(o).c_str());
+    return false;
+  }
+  return true;
+}
+
+// ---- Run ----
+struct Checkpoint {
+  int      game, frame;
+  uint64_t hash;
+};
+
+struct Run {
+  Options        opt;
+  LGFX          *gfx = nullptr;
+  AutoplayBot   *bot = nullptr;
+  int            game = 0;
+  int            calls = 0;       // read_touch calls this game; frames flushed so far
+  std::vector<uint16_t> px;
+  std::vector<Checkpoint> checkpoints;
+  const std::map<std::string, uint64_t> *golden = nullptr;
+  bool           game_failed = false;
+  int            last_match = 0;
+  int            mismatches = 0, missing = 0;
+  double         hash_s = 0;
+};
+
+Run s_run;
+
+std::string frame_name(int game, int frame) { return std::string(GAME_NAMES[game]) + "_" + std::to_string(frame); }
+
+void checkpoint(int frame)
+{
+  Run &r = s_run;
+  const int w = r.gfx->width(), h = r.gfx->height();
+  r.gfx->readRect(0, 0, w, h, reinterpret_cast<lgfx::swap565_t *>(r.px.data()));
+  const auto t0 = std::chrono::steady_clock::now();
+  const uint64_t hash = frame_hash(r.px.data(), r.px.size());
+  r.hash_s += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  r.checkpoints.push_back({ r.game, frame, hash });
+  if (!r.opt.dump.empty()) write_frame(r.opt.dump + "/" + frame_name(r.game, frame) + ".ppm", r.px, w, h);
+  if (!r.golden) return;
+
+  const auto it = r.golden->find(std::string(GAME_NAMES[r.game]) + " " + std::to_string(frame));
+  if (it == r.golden->end()) { ++r.missing; return; }
+  if (it->second == hash) { if (!r.game_failed) r.last_match = frame; return; }
+  ++r.mismatches;
+  if (r.game_failed) return;
+  r.game_failed = true;
+
+  std::printf("  %s: first differing frame %d (frame %d matched), hash %016llx, golden %016llx\n",
+              GAME_NAMES[r.game], frame, r.last_match, (unsigned long long)hash, (unsigned long long)it->second);
+  const std::string base = r.opt.out + "/" + frame_name(r.game, frame);
+  if (write_frame(base + ".ppm", r.px, w, h)) std::printf("    frame written to %s.ppm\n", base.c_str());
+  std::vector<uint8_t> ref;
+  if (!r.opt.ref.empty() && read_ppm(r.opt.ref + "/" + frame_name(r.game, frame) + ".ppm", ref, w, h))
+    write_diff(base + "_diff.ppm", r.px, ref, w, h);
+  else
+    std::printf("    for a diff image, dump=DIR from a known-good build and pass ref=DIR\n");
+}
+
+// Installed as the touch source: games poll it exactly once per frame,
+// after the previous frame's flush, which makes it the frame hook too
+bool scripted_touch(uint16_t &x, uint16_t &y)
+{
+  Run &r = s_run;
+  const int frame = r.calls++;
+  if (frame > 0 && frame % r.opt.every == 0) checkpoint(frame);
+  if (frame >= r.opt.frames) return false;   // the last frame
+  return r.bot->sample(game_millis(), current_aim(), x, y);
+}
+
+void run_game(LGFX &gfx, Scene &scene, int g)
+{
+  Run &r = s_run;
+  r.game = g;
+  r.calls = 0;
+  r.game_failed = false;
+  r.last_match = 0;
+  // Every game starts from the same state, so one game's golden frames
+  // never depend on another's
+  rand_seed(r.opt.seed);
+  clock_use_virtual(0);
+  effect_arena().reset();
+  Effects fx = borrow_effects();
+  gesture_reset();
+  AutoplayBot bot(r.opt.seed * 2654435761u + g, gfx.width(), gfx.height(), HUD_H);
+  bot.set_profile(SCRIPT[g]);
+  r.bot = &bot;
+  GameScheduler sched(GAME_FACTORIES, GAME_COUNT, gesture_input, &gfx);
+  sched.start(0, g, game_view(&scene, &fx, 0, 0, 0, gfx.width(), gfx.height()));
+  while (r.calls <= r.opt.frames) run_frame(sched, scene);
+  sched.stop(0);
+  r.bot = nullptr;
+}
+
+bool parse(int argc, char **argv, Options &o)
+{
+  for (int i = 1; i < argc; ++i) {
+    const char *eq = std::strchr(argv[i], '=');
+    if (!eq) return false;
+    const std::string key(argv[i], eq - argv[i]), v(eq + 1);
+    if      (key == "seed")   o.seed = (uint32_t)std::strtoul(v.c_str(), nullptr, 0);
+    else if (key == "every")  o.every = std::atoi(v.c_str());
+    else if (key == "frames") o.frames = std::atoi(v.c_str());
+    else if (key == "update") o.update = v != "0";
+    else if (key == "golden") o.golden = v;
+    else if (key == "out")    o.out = v;
+    else if (key == "ref")    o.ref = v;
+    else if (key == "dump")   o.dump = v;
+    else return false;
+  }
+  return o.seed != 0 && o.every > 0 && o.frames > 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  Run &r = s_run;
+  if (!parse(argc, argv, r.opt)) {
+    std::fprintf(stderr, "usage: %s [seed=N (non-zero)] [every=N] [frames=N] [update=1] [golden=PATH] [out=DIR] "
+                         "[ref=DIR] [dump=DIR]\n", argv[0]);
+    return 2;
+  }
+  std::map<std::string, uint64_t> golden;
+  if (!r.opt.update) {
+    if (!load_golden(r.opt, golden) || golden.empty()) return 2;
+    r.golden = &golden;
+    mkdir(r.opt.out.c_str(), 0755);
+  }
+  if (!r.opt.dump.empty()) mkdir(r.opt.dump.c_str(), 0755);
+
+  static LGFX gfx;
+  if (!gfx.init()) { std::fprintf(stderr, "canvas allocation failed\n"); return 2; }
+  gfx.setRotation(DISPLAY_ROTATION);
+  static Scene scene(gfx);
+  r.gfx = &gfx;
+  r.px.resize((size_t)gfx.width() * gfx.height());
+  set_touch_source(scripted_touch);
+  quality_pin(QUALITY_DEFAULT_TIER);   // the governor reacts to host timing
+
+  const auto t0 = std::chrono::steady_clock::now();
+  for (int g = 0; g < GAME_COUNT; ++g) run_game(gfx, scene, g);
+  const double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  const int frames = GAME_COUNT * (r.opt.frames + 1);
+  std::printf("%d frames in %.2f s (%.0f frames/s), %zu checkpoints hashed at %.0f frames/s\n", frames, s, frames / s,
+              r.checkpoints.size(), r.checkpoints.size() / r.hash_s);
+
+  if (r.opt.update) {
+    FILE *f = std::fopen(r.opt.golden.c_str(), "w");
+    if (!f) { std::fprintf(stderr, "cannot write %s\n", r.opt.golden.c_str()); return 2; }
+    std::fprintf(f, "# Golden framebuffer hashes: tools/golden/golden_frames.cpp update=1\n%s\n",
+                 params_line(r.opt).c_str());
+    for (const Checkpoint &c : r.checkpoints)
+      std::fprintf(f, "%s %d %016llx\n", GAME_NAMES[c.game], c.frame, (unsigned long long)c.hash);
+    std::fclose(f);
+    std::printf("recorded %zu hashes in %s\n", r.checkpoints.size(), r.opt.golden.c_str());
+    return 0;
+  }
+  if (r.missing) std::printf("%d checkpoints have no golden hash\n", r.missing);
+  std::printf("%s: %d of %zu checkpoints differ\n", r.mismatches || r.missing ? "FAIL" : "ok", r.mismatches,
+              r.checkpoints.size());
+  return r.mismatches || r.missing ? 1 : 0;
+}
@@ -0,0 +1,56 @@
+// Host stand-ins for the ESP-side modules the games call into, so the real
+// game, scene and effect code runs headless (tools/golden). Nothing here
+// affects pixels: scores, logs, resume snapshots and live stats are dropped.
+extern "C" {
+#include "esp_timer.h"
+#include "esp_random.h"
+}
+
+#include "boot.hpp"
+#include "dlog.hpp"
+#include "score_store.hpp"
+#include "stats_console.hpp"
+#include "mem_report.hpp"
+#include <time.h>
+
+// Thread CPU time: frame costs measure the work, not the host's scheduler
+int64_t esp_timer_get_time(void)
+{
+  timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+uint32_t esp_random(void)
+{
+  static uint32_t s = 0x9E3779B9u;
+  s ^= s << 13; s ^= s >> 17; s ^= s << 5;
+  return s;
+}
+
+// ---- boot.hpp: no RTC memory, every run starts fresh ----
+void boot_mark(BootStage) {}
+int  resume_game() { return -1; }
+bool resume_claim(int, GameSnapshot &) { return false; }
+void resume_save(GameSnapshot &) {}
+
+// ---- score_store.hpp ----
+void score_store_begin_session(int, int, int) {}
+void score_store_update(int, int, int) {}
+void score_store_end_session(int) {}
+GameStats score_store_get(int) { return {}; }
+void score_store_log_best(int) {}
+
+// ---- dlog.hpp ----
+void dlog_write(DlogId, int, int32_t, int32_t, int32_t) {}
+
+// ---- stats_console.hpp ----
+void stats_frame(int64_t, uint32_t, int, int, int) {}
+void stats_touch_event() {}
+
+// ---- mem_report.hpp: no heap or task stacks to report ----
+RamAccount::RamAccount(const char *n, size_t b) : name(n), bytes(b), next(nullptr) {}
+void mem_report_track_task(void *, const char *) {}
+void mem_report(void (*)(const char *, void *), void *) {}
+void mem_report_log() {}
+void mem_report_stacks(void (*)(const char *, unsigned, void *), void *) {}
@@ -0,0 +1,7 @@
+// Host stand-in (tools/golden); the harness seeds urand, so this only backs
+// the unseeded path
+#pragma once
+
+#include <stdint.h>
+
+uint32_t esp_random(void);
@@ -0,0 +1,6 @@
+// Host stand-in (tools/golden): monotonic microseconds from host_idf.cpp
+#pragma once
+
+#include <stdint.h>
+
+int64_t esp_timer_get_time(void);
@@ -0,0 +1,7 @@
+// Host stand-in for the few FreeRTOS names the game path uses (tools/golden)
+#pragma once
+
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
@@ -0,0 +1,7 @@
+// Host stand-in (tools/golden): the harness runs on the virtual clock, so
+// a frame delay has nothing to wait for
+#pragma once
+
+#include "FreeRTOS.h"
+
+static inline void vTaskDelay(TickType_t ticks) { (void)ticks; }
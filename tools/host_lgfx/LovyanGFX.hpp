@@ -0,0 +1,309 @@
+// Host stand-in for the part of LovyanGFX the scene and games use, so host
+// tools that draw build with no LovyanGFX checkout and render the same
+// pixels on every machine. Sprites
+// hold byte-swapped RGB565 as LGFX 16-bit sprites do; circles and rounded
+// rects use the midpoint rasteriser, text the classic 5x7 glyphs in a 6x8
+// cell. Shapes are close to LovyanGFX but not bit-identical, so golden
+// hashes recorded against this canvas only hold for this canvas.
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+
+#define TFT_BLACK       0x0000
+#define TFT_NAVY        0x000F
+#define TFT_DARKGREEN   0x03E0
+#define TFT_DARKCYAN    0x03EF
+#define TFT_MAROON      0x7800
+#define TFT_PURPLE      0x780F
+#define TFT_OLIVE       0x7BE0
+#define TFT_LIGHTGREY   0xD69A
+#define TFT_DARKGREY    0x7BEF
+#define TFT_BLUE        0x001F
+#define TFT_GREEN       0x07E0
+#define TFT_CYAN        0x07FF
+#define TFT_RED         0xF800
+#define TFT_MAGENTA     0xF81F
+#define TFT_YELLOW      0xFFE0
+#define TFT_WHITE       0xFFFF
+#define TFT_ORANGE      0xFDA0
+#define TFT_GREENYELLOW 0xB7E0
+#define TFT_PINK        0xFE19
+#define TFT_BROWN       0x9A60
+#define TFT_GOLD        0xFEA0
+#define TFT_SILVER      0xC618
+#define TFT_SKYBLUE     0x867D
+#define TFT_VIOLET      0x915C
+
+namespace lgfx { inline namespace v1 {
+
+inline uint32_t millis()
+{
+  using namespace std::chrono;
+  static const auto t0 = steady_clock::now();
+  return (uint32_t)duration_cast<milliseconds>(steady_clock::now() - t0).count();
+}
+
+struct swap565_t { uint8_t raw0, raw1; };
+
+struct IFont {};
+namespace fonts { inline const IFont Font0{}; }
+
+// Columns of 5x7 glyphs for ' '..'~', bit 0 at the top; bit 7 is the
+// descender row of g, j, p, q, y
+inline const uint8_t GLYPHS[95][5] = {
+  {0x00,0x00,0x00,0x00,0x00}, {0x00,0x00,0x5F,0x00,0x00}, {0x00,0x07,0x00,0x07,0x00}, {0x14,0x7F,0x14,0x7F,0x14},
+  {0x24,0x2A,0x7F,0x2A,0x12}, {0x23,0x13,0x08,0x64,0x62}, {0x36,0x49,0x56,0x20,0x50}, {0x00,0x08,0x07,0x03,0x00},
+  {0x00,0x1C,0x22,0x41,0x00}, {0x00,0x41,0x22,0x1C,0x00}, {0x2A,0x1C,0x7F,0x1C,0x2A}, {0x08,0x08,0x3E,0x08,0x08},
+  {0x00,0x80,0x70,0x30,0x00}, {0x08,0x08,0x08,0x08,0x08}, {0x00,0x00,0x60,0x60,0x00}, {0x20,0x10,0x08,0x04,0x02},
+  {0x3E,0x51,0x49,0x45,0x3E}, {0x00,0x42,0x7F,0x40,0x00}, {0x72,0x49,0x49,0x49,0x46}, {0x21,0x41,0x49,0x4D,0x33},
+  {0x18,0x14,0x12,0x7F,0x10}, {0x27,0x45,0x45,0x45,0x39}, {0x3C,0x4A,0x49,0x49,0x31}, {0x41,0x21,0x11,0x09,0x07},
+  {0x36,0x49,0x49,0x49,0x36}, {0x46,0x49,0x49,0x29,0x1E}, {0x00,0x00,0x14,0x00,0x00}, {0x00,0x40,0x34,0x00,0x00},
+  {0x00,0x08,0x14,0x22,0x41}, {0x14,0x14,0x14,0x14,0x14}, {0x00,0x41,0x22,0x14,0x08}, {0x02,0x01,0x59,0x09,0x06},
+  {0x3E,0x41,0x5D,0x59,0x4E}, {0x7C,0x12,0x11,0x12,0x7C}, {0x7F,0x49,0x49,0x49,0x36}, {0x3E,0x41,0x41,0x41,0x22},
+  {0x7F,0x41,0x41,0x41,0x3E}, {0x7F,0x49,0x49,0x49,0x41}, {0x7F,0x09,0x09,0x09,0x01}, {0x3E,0x41,0x41,0x51,0x73},
+  {0x7F,0x08,0x08,0x08,0x7F}, {0x00,0x41,0x7F,0x41,0x00}, {0x20,0x40,0x41,0x3F,0x01}, {0x7F,0x08,0x14,0x22,0x41},
+  {0x7F,0x40,0x40,0x40,0x40}, {0x7F,0x02,0x1C,0x02,0x7F}, {0x7F,0x04,0x08,0x10,0x7F}, {0x3E,0x41,0x41,0x41,0x3E},
+  {0x7F,0x09,0x09,0x09,0x06}, {0x3E,0x41,0x51,0x21,0x5E}, {0x7F,0x09,0x19,0x29,0x46}, {0x26,0x49,0x49,0x49,0x32},
+  {0x03,0x01,0x7F,0x01,0x03}, {0x3F,0x40,0x40,0x40,0x3F}, {0x1F,0x20,0x40,0x20,0x1F}, {0x3F,0x40,0x38,0x40,0x3F},
+  {0x63,0x14,0x08,0x14,0x63}, {0x03,0x04,0x78,0x04,0x03}, {0x61,0x59,0x49,0x4D,0x43}, {0x00,0x7F,0x41,0x41,0x41},
+  {0x02,0x04,0x08,0x10,0x20}, {0x00,0x41,0x41,0x41,0x7F}, {0x04,0x02,0x01,0x02,0x04}, {0x40,0x40,0x40,0x40,0x40},
+  {0x00,0x03,0x07,0x08,0x00}, {0x20,0x54,0x54,0x78,0x40}, {0x7F,0x28,0x44,0x44,0x38}, {0x38,0x44,0x44,0x44,0x28},
+  {0x38,0x44,0x44,0x28,0x7F}, {0x38,0x54,0x54,0x54,0x18}, {0x00,0x08,0x7E,0x09,0x02}, {0x18,0xA4,0xA4,0x9C,0x78},
+  {0x7F,0x08,0x04,0x04,0x78}, {0x00,0x44,0x7D,0x40,0x00}, {0x20,0x40,0x40,0x3D,0x00}, {0x7F,0x10,0x28,0x44,0x00},
+  {0x00,0x41,0x7F,0x40,0x00}, {0x7C,0x04,0x78,0x04,0x78}, {0x7C,0x08,0x04,0x04,0x78}, {0x38,0x44,0x44,0x44,0x38},
+  {0xFC,0x18,0x24,0x24,0x18}, {0x18,0x24,0x24,0x18,0xFC}, {0x7C,0x08,0x04,0x04,0x08}, {0x48,0x54,0x54,0x54,0x24},
+  {0x04,0x04,0x3F,0x44,0x24}, {0x3C,0x40,0x40,0x20,0x7C}, {0x1C,0x20,0x40,0x20,0x1C}, {0x3C,0x40,0x30,0x40,0x3C},
+  {0x44,0x28,0x10,0x28,0x44}, {0x4C,0x90,0x90,0x90,0x7C}, {0x44,0x64,0x54,0x4C,0x44}, {0x00,0x08,0x36,0x41,0x00},
+  {0x00,0x00,0x77,0x00,0x00}, {0x00,0x41,0x36,0x08,0x00}, {0x02,0x01,0x02,0x04,0x02},
+};
+
+class LovyanGFX {
+public:
+  virtual ~LovyanGFX() = default;
+
+  int32_t width() const { return w_; }
+  int32_t height() const { return h_; }
+
+  static constexpr uint16_t color565(uint8_t r, uint8_t g, uint8_t b)
+  {
+    return (uint16_t)((r >> 3) << 11 | (g >> 2) << 5 | b >> 3);
+  }
+  static constexpr uint32_t color888(uint8_t r, uint8_t g, uint8_t b) { return (uint32_t)r << 16 | g << 8 | b; }
+
+  void setColorDepth(int) {}
+  // Odd rotations turn the memory into landscape; pixels stay row-major
+  void setRotation(int r)
+  {
+    if ((r & 1) != (rotation_ & 1)) std::swap(w_, h_);
+    rotation_ = r & 3;
+    clearClipRect();
+  }
+
+  void setClipRect(int32_t x, int32_t y, int32_t w, int32_t h)
+  {
+    clip_x0_ = std::max<int32_t>(x, 0); clip_y0_ = std::max<int32_t>(y, 0);
+    clip_x1_ = std::min<int32_t>(x + w, w_); clip_y1_ = std::min<int32_t>(y + h, h_);
+  }
+  void clearClipRect() { clip_x0_ = clip_y0_ = 0; clip_x1_ = w_; clip_y1_ = h_; }
+
+  void startWrite() {}
+  void endWrite() {}
+  void waitDMA() {}
+
+  void fillScreen(uint32_t c) { fillRect(0, 0, w_, h_, c); }
+
+  void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t c)
+  {
+    const int32_t x0 = std::max(x, clip_x0_), x1 = std::min(x + w, clip_x1_);
+    const int32_t y0 = std::max(y, clip_y0_), y1 = std::min(y + h, clip_y1_);
+    const uint16_t v = store(c);
+    for (int32_t j = y0; j < y1; ++j) std::fill(buf_ + j * w_ + x0, buf_ + j * w_ + std::max(x0, x1), v);
+  }
+  void drawPixel(int32_t x, int32_t y, uint32_t c) { fillRect(x, y, 1, 1, c); }
+  void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t c) { fillRect(x, y, w, 1, c); }
+  void drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t c) { fillRect(x, y, 1, h, c); }
+
+  void drawCircle(int32_t x0, int32_t y0, int32_t r, uint32_t c)
+  {
+    if (r <= 0) { drawPixel(x0, y0, c); return; }
+    drawPixel(x0, y0 + r, c); drawPixel(x0, y0 - r, c);
+    drawPixel(x0 + r, y0, c); drawPixel(x0 - r, y0, c);
+    circle_corners(x0, y0, r, 15, c);
+  }
+
+  void fillCircle(int32_t x0, int32_t y0, int32_t r, uint32_t c)
+  {
+    drawFastVLine(x0, y0 - r, 2 * r + 1, c);
+    fill_halves(x0, y0, r, 3, 0, c);
+  }
+
+  void drawRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint32_t c)
+  {
+    r = std::max<int32_t>(0, std::min(r, std::min(w, h) / 2));
+    drawFastHLine(x + r, y, w - 2 * r, c);
+    drawFastHLine(x + r, y + h - 1, w - 2 * r, c);
+    drawFastVLine(x, y + r, h - 2 * r, c);
+    drawFastVLine(x + w - 1, y + r, h - 2 * r, c);
+    circle_corners(x + r, y + r, r, 1, c);
+    circle_corners(x + w - r - 1, y + r, r, 2, c);
+    circle_corners(x + w - r - 1, y + h - r - 1, r, 4, c);
+    circle_corners(x + r, y + h - r - 1, r, 8, c);
+  }
+
+  void fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint32_t c)
+  {
+    r = std::max<int32_t>(0, std::min(r, std::min(w, h) / 2));
+    fillRect(x + r, y, w - 2 * r, h, c);
+    fill_halves(x + w - r - 1, y + r, r, 1, h - 2 * r - 1, c);
+    fill_halves(x + r, y + r, r, 2, h - 2 * r - 1, c);
+  }
+
+  // Text: transparent background, '\n' returns to x = 0
+  void setFont(const IFont *) {}
+  void setTextSize(float s) { text_size_ = std::max(1, (int)s); }
+  void setTextColor(uint32_t c) { text_color_ = c; }
+  void setTextColor(uint32_t c, uint32_t) { text_color_ = c; }
+  void setCursor(int32_t x, int32_t y) { cursor_x_ = x; cursor_y_ = y; }
+  size_t print(const char *s)
+  {
+    size_t n = 0;
+    for (; *s; ++s, ++n) {
+      if (*s == '\n') { cursor_x_ = 0; cursor_y_ += 8 * text_size_; continue; }
+      if (*s >= ' ' && *s <= '~') {
+        const uint8_t *g = GLYPHS[*s - ' '];
+        for (int col = 0; col < 5; ++col)
+          for (int row = 0; row < 8; ++row)
+            if (g[col] >> row & 1)
+              fillRect(cursor_x_ + col * text_size_, cursor_y_ + row * text_size_, text_size_, text_size_, text_color_);
+      }
+      cursor_x_ += 6 * text_size_;
+    }
+    return n;
+  }
+
+  // Raw pixels, already byte-swapped; the canvas has no DMA to wait for
+  void pushImageDMA(int32_t x, int32_t y, int32_t w, int32_t h, const swap565_t *data)
+  {
+    ++transfers_;
+    const uint16_t *src = reinterpret_cast<const uint16_t *>(data);
+    for (int32_t j = std::max(y, clip_y0_); j < std::min(y + h, clip_y1_); ++j)
+      for (int32_t i = std::max(x, clip_x0_); i < std::min(x + w, clip_x1_); ++i)
+        buf_[j * w_ + i] = src[(j - y) * w + (i - x)];
+  }
+  void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const swap565_t *data) { pushImageDMA(x, y, w, h, data); }
+
+  // Images pushed so far: on a panel each one is a CASET/RASET/RAMWR window
+  uint32_t transfers() const { return transfers_; }
+
+  // Outside the canvas reads as 0
+  void readRect(int32_t x, int32_t y, int32_t w, int32_t h, swap565_t *data) const
+  {
+    uint16_t *out = reinterpret_cast<uint16_t *>(data);
+    for (int32_t j = 0; j < h; ++j)
+      for (int32_t i = 0; i < w; ++i) {
+        const int32_t sx = x + i, sy = y + j;
+        out[j * w + i] = (sx >= 0 && sy >= 0 && sx < w_ && sy < h_) ? buf_[sy * w_ + sx] : 0;
+      }
+  }
+
+protected:
+  static uint16_t store(uint32_t c) { return (uint16_t)((c & 0xFF) << 8 | (c >> 8 & 0xFF)); }
+
+  void attach(uint16_t *buf, int32_t w, int32_t h)
+  {
+    buf_ = buf; w_ = w; h_ = h; rotation_ = 0;
+    clearClipRect();
+  }
+
+  uint16_t *buf_ = nullptr;
+  int32_t   w_ = 0, h_ = 0;
+  uint32_t  transfers_ = 0;
+
+private:
+  // Midpoint arcs: corner bits 1 top-left, 2 top-right, 4 bottom-right, 8 bottom-left
+  void circle_corners(int32_t x0, int32_t y0, int32_t r, int corners, uint32_t c)
+  {
+    int32_t f = 1 - r, ddx = 1, ddy = -2 * r, x = 0, y = r;
+    while (x < y) {
+      if (f >= 0) { --y; ddy += 2; f += ddy; }
+      ++x; ddx += 2; f += ddx;
+      if (corners & 4) { drawPixel(x0 + x, y0 + y, c); drawPixel(x0 + y, y0 + x, c); }
+      if (corners & 2) { drawPixel(x0 + x, y0 - y, c); drawPixel(x0 + y, y0 - x, c); }
+      if (corners & 8) { drawPixel(x0 - y, y0 + x, c); drawPixel(x0 - x, y0 + y, c); }
+      if (corners & 1) { drawPixel(x0 - y, y0 - x, c); drawPixel(x0 - x, y0 - y, c); }
+    }
+  }
+
+  // Vertical spans of the right (1) and left (2) halves, stretched by `delta` rows
+  void fill_halves(int32_t x0, int32_t y0, int32_t r, int sides, int32_t delta, uint32_t c)
+  {
+    int32_t f = 1 - r, ddx = 1, ddy = -2 * r, x = 0, y = r;
+    while (x < y) {
+      if (f >= 0) { --y; ddy += 2; f += ddy; }
+      ++x; ddx += 2; f += ddx;
+      if (sides & 1) {
+        drawFastVLine(x0 + x, y0 - y, 2 * y + 1 + delta, c);
+        drawFastVLine(x0 + y, y0 - x, 2 * x + 1 + delta, c);
+      }
+      if (sides & 2) {
+        drawFastVLine(x0 - x, y0 - y, 2 * y + 1 + delta, c);
+        drawFastVLine(x0 - y, y0 - x, 2 * x + 1 + delta, c);
+      }
+    }
+  }
+
+  int       rotation_ = 0;
+  int32_t   clip_x0_ = 0, clip_y0_ = 0, clip_x1_ = 0, clip_y1_ = 0;
+  int32_t   cursor_x_ = 0, cursor_y_ = 0;
+  int       text_size_ = 1;
+  uint32_t  text_color_ = TFT_WHITE;
+};
+
+class LGFX_Sprite : public LovyanGFX {
+public:
+  LGFX_Sprite() = default;
+  explicit LGFX_Sprite(LovyanGFX *) {}
+  LGFX_Sprite(LGFX_Sprite &&o) noexcept { *this = std::move(o); }
+  LGFX_Sprite &operator=(LGFX_Sprite &&o) noexcept
+  {
+    std::swap(buf_, o.buf_); std::swap(w_, o.w_); std::swap(h_, o.h_); std::swap(owned_, o.owned_);
+    clearClipRect();
+    return *this;
+  }
+  ~LGFX_Sprite() override { deleteSprite(); }
+
+  void *createSprite(int32_t w, int32_t h)
+  {
+    deleteSprite();
+    uint16_t *p = static_cast<uint16_t *>(std::calloc((size_t)w * h, sizeof(uint16_t)));
+    if (!p) return nullptr;
+    owned_ = true;
+    attach(p, w, h);
+    return p;
+  }
+  void deleteSprite()
+  {
+    if (owned_) std::free(buf_);
+    owned_ = false;
+    attach(nullptr, 0, 0);
+  }
+  // Draws into caller memory (16-bit only)
+  void setBuffer(void *buf, int32_t w, int32_t h, uint8_t = 16)
+  {
+    deleteSprite();
+    attach(static_cast<uint16_t *>(buf), w, h);
+  }
+  void *getBuffer() const { return buf_; }
+
+private:
+  bool owned_ = false;
+};
+
+}} // namespace lgfx::v1
+
+using namespace lgfx::v1;
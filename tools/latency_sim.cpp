@@ -0,0 +1,204 @@
+// Host model of the touch-to-photon path, reporting through the same
+// LatencyTracker the firmware uses, so a timing regression shows up in the
+// breakdown before flashing:
+//   g++ -std=c++17 -O2 -I main tools/latency_sim.cpp main/latency.cpp main/rect_merge.cpp -o latency_sim
+//   ./latency_sim [taps=500] [seed=1] [tick_hz=100] [spi_mhz=40] [touch_mhz=1] [wake_us=400]
+// Besides the firmware's segments it prints finger-landing to photon, which
+// the device cannot see. The tracker's buckets are a quarter octave wide
+// (2.5 ms around a 10 ms tick), so each game also gets a line of exact
+// percentiles from the simulated stamps.
+#include "latency.hpp"
+#include "rect_merge.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int SW = 320, SH = 240;        // rotation 1
+constexpr int BAND_PIXELS = 320 * 16;    // matches Scene::BAND_PIXELS
+constexpr int XPT_SAMPLES = 4, XPT_FRAME_BYTES = 12;
+
+struct Model {
+  int    tick_hz = 100;        // CONFIG_FREERTOS_HZ: pdMS_TO_TICKS(16) is one tick at 100 Hz
+  double spi_mhz = 40;         // TFT_FREQ
+  double touch_mhz = 1;        // TOUCH_FREQ
+  int    trans_us = 15;        // queued transaction setup
+  double compose_ns_px = 25;   // band sprite fill + primitives
+  int    logic_us = 250;       // per-frame physics and effects before the touch read (+-30%)
+  int    hit_us = 10;
+  int    react_us = 120;       // score, HUD text, spawning effects
+  int    hold_ms = 80;         // finger down time per tap
+  int    wake_us = 400;        // tick ISR, then higher-priority tasks (dlog, console) before the game task runs
+};
+
+uint32_t s_rng = 1;
+int rnd(int lo, int hi)
+{
+  s_rng ^= s_rng << 13; s_rng ^= s_rng >> 17; s_rng ^= s_rng << 5;
+  return lo + (int)(s_rng % (uint32_t)(hi - lo + 1));
+}
+
+// Exact samples of one segment, for the percentiles the buckets blur
+struct Samples {
+  std::vector<uint32_t> v;
+
+  uint32_t percentile(int pct)
+  {
+    if (v.empty()) return 0;
+    std::sort(v.begin(), v.end());
+    const size_t rank = (v.size() * (size_t)pct + 99) / 100;   // nearest rank, as LatHistogram
+    return v[rank ? rank - 1 : 0];
+  }
+};
+
+Rect box(int cx, int cy, int r) { return { (int16_t)(cx - r - 1), (int16_t)(cy - r - 1), (int16_t)(2 * r + 3), (int16_t)(2 * r + 3) }; }
+
+// Dirty areas a reaction frame produces in each game
+void reaction_rects(int game, int x, int y, std::vector<Rect> &out)
+{
+  out.push_back({ 10, 2, 200, 16 });   // HUD score text
+  if (game == 2) {                     // grid: one cell recolours
+    out.push_back({ (int16_t)(x - 50), (int16_t)(y - 35), 100, 70 });
+    return;
+  }
+  const int r = game == 0 ? 22 : 16;
+  out.push_back(box(x, y, r));                          // target leaves
+  out.push_back(box(rnd(r, SW - r), rnd(r + 18, SH - r), r));   // and respawns
+  for (int i = 0; i < 24; ++i) out.push_back(box(x + rnd(-3, 3), y + rnd(-3, 3), rnd(2, 4)));
+  out.push_back(box(x, y, 3));                          // ripple seed
+}
+
+void idle_rects(int game, std::vector<Rect> &out)
+{
+  if (game == 0) { int x = rnd(30, SW - 30), y = rnd(40, SH - 30); out.push_back(box(x, y, 22)); out.push_back(box(x + 3, y + 3, 22)); }
+}
+
+// Scene::flush: clip, coalesce, compose each band while the previous one is on the bus
+int64_t flush(const Model &m, int64_t t, std::vector<Rect> &rects)
+{
+  int n = 0;
+  for (Rect &r : rects) if (rect_clip(r, SW, SH)) rects[n++] = r;
+  n = rect_merge(rects.data(), n, WINDOW_COST_PX, BAND_PIXELS);
+  int64_t bus_free = t;
+  for (int i = 0; i < n; ++i) {
+    const Rect &r = rects[i];
+    const int rows = rect_band_rows(r, BAND_PIXELS);
+    for (int y0 = 0; y0 < r.h; y0 += rows) {
+      const int px = r.w * std::min(rows, r.h - y0);
+      t += (int64_t)(px * m.compose_ns_px / 1000);
+      t = std::max(t, bus_free);   // waitDMA before reusing the other buffer
+      bus_free = t + m.trans_us + (int64_t)((WINDOW_CMD_BYTES * 8 + px * 16) / m.spi_mhz);
+    }
+  }
+  return bus_free;   // flush ends with waitDMA
+}
+
+void run_game(const Model &m, int game, int taps, LatencyTracker &tracker, LatHistogram &land, Samples *exact)
+{
+  const int64_t tick_us = 1000000 / m.tick_hz;
+  const int delay_ticks = 16 * m.tick_hz / 1000;   // pdMS_TO_TICKS truncates
+  const int64_t batch_us = XPT_SAMPLES * (m.trans_us + (int64_t)(XPT_FRAME_BYTES * 8 / m.touch_mhz));
+
+  int64_t t = 0, kick = 0, sample_us = 0;
+  int64_t land_us = rnd(20000, 60000), up_us = land_us + m.hold_ms * 1000;
+  bool pressed = false, was_pressed = false, seen = false;
+  std::vector<Rect> rects;
+
+  for (int done = 0; done < taps;) {
+    t += m.logic_us * rnd(70, 130) / 100;
+
+    // touch_dma_read: harvest the batch if it finished, queue the next
+    if (t >= kick + batch_us) {
+      pressed = kick >= land_us && kick < up_us;   // a batch samples at its start
+      sample_us = kick;
+      kick = t;
+    }
+    tracker.sample(pressed, sample_us, t);
+    const bool edge = pressed && !was_pressed;
+    was_pressed = pressed;
+    const int64_t read_us = t;
+
+    rects.clear();
+    if (pressed) { t += m.hit_us; tracker.mark(LAT_HIT, t, game); }
+    const int64_t hit_us = t;
+    if (edge) {
+      t += m.react_us * rnd(70, 130) / 100;
+      tracker.mark(LAT_STATE, t);
+      reaction_rects(game, rnd(40, SW - 40), rnd(50, SH - 40), rects);
+    } else {
+      idle_rects(game, rects);
+    }
+    const int64_t state_us = t;
+    t = flush(m, t, rects);
+    tracker.flushed(t);
+    if (edge) {
+      const int64_t stamps[] = { sample_us, read_us, hit_us, state_us, t };
+      for (int s = 0; s < LAT_PHOTON; ++s) exact[s].v.push_back((uint32_t)(stamps[s + 1] - stamps[s]));
+      exact[LAT_SEGMENTS - 1].v.push_back((uint32_t)(t - sample_us));
+      land.add((uint32_t)(t - land_us));
+      seen = true;
+      ++done;
+    }
+
+    if (seen && t >= up_us) {
+      land_us = up_us + rnd(100000, 400000);
+      up_us = land_us + m.hold_ms * 1000;
+      seen = false;
+    }
+
+    // frame_delay: vTaskDelay wakes on a tick boundary, and the task runs
+    // once the ISR and anything of higher priority ready then are done
+    if (delay_ticks > 0) t = (t / tick_us + delay_ticks) * tick_us + rnd(0, m.wake_us);
+  }
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  Model m;
+  int taps = 500;
+  for (int i = 1; i < argc; ++i) {
+    const char *eq = std::strchr(argv[i], '=');
+    if (!eq) {
+      std::fprintf(stderr, "usage: %s [taps=N] [seed=N] [tick_hz=N] [spi_mhz=F] [touch_mhz=F] [wake_us=N]\n", argv[0]);
+      return 1;
+    }
+    const std::string key(argv[i], eq - argv[i]);
+    const double v = std::atof(eq + 1);
+    if      (key == "taps")      taps = (int)v;
+    else if (key == "seed")      s_rng = v ? (uint32_t)v : 1;
+    else if (key == "tick_hz")   m.tick_hz = (int)v;
+    else if (key == "spi_mhz")   m.spi_mhz = v;
+    else if (key == "touch_mhz") m.touch_mhz = v;
+    else if (key == "wake_us")   m.wake_us = (int)v;
+    else { std::fprintf(stderr, "unknown option %s\n", key.c_str()); return 1; }
+  }
+
+  std::printf("model: tick %d Hz, display SPI %.0f MHz, touch SPI %.1f MHz, wake jitter %d us, %d taps per game\n",
+              m.tick_hz, m.spi_mhz, m.touch_mhz, m.wake_us, taps);
+  std::printf("segments p50/p90/p99 us: poll = acquire->read, hit, state, flush = state->photon\n");
+  std::printf("(\"game\" lines are the device's bucket bounds, \"exact\" lines the simulated values)\n");
+  LatencyTracker tracker;
+  char line[160];
+  for (int g = 0; g < 3; ++g) {
+    LatHistogram land = {};
+    Samples exact[LAT_SEGMENTS];
+    run_game(m, g, taps, tracker, land, exact);
+    tracker.format(g, line, sizeof(line));
+    std::printf("%s\n", line);
+    static const char *const NAMES[LAT_SEGMENTS] = { "poll", "hit", "state", "flush", "total" };
+    std::printf("exact  ");
+    for (int s = 0; s < LAT_SEGMENTS; ++s)
+      std::printf(" %s %u/%u/%u", NAMES[s], (unsigned)exact[s].percentile(50), (unsigned)exact[s].percentile(90),
+                  (unsigned)exact[s].percentile(99));
+    std::printf("\n");
+    std::printf("game %d finger->photon %u/%u/%u (not visible on device)\n", g,
+                (unsigned)land.percentile(50), (unsigned)land.percentile(90), (unsigned)land.percentile(99));
+  }
+  return 0;
+}
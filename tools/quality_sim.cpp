@@ -0,0 +1,177 @@
+// Host check of the effect-quality governor against a synthetic frame-cost
+// model: effects spawn per tap with the current tier's settings, each live
+// particle and ripple ring costs time, and the scenario moves through quiet
+// play, a tap storm, a storm under extra load, and quiet again:
+//   g++ -std=c++17 -O2 -I main tools/quality_sim.cpp main/quality.cpp -o quality_sim
+//   ./quality_sim [seed=1] [budget_us=8000] [trace=0]
+// Prints each phase for the governor and for the old fixed settings (tier
+// 2 pinned), then checks the control behaviour and exits non-zero on failure.
+#include "quality.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int FPS = 60;
+constexpr int MAX_PARTICLES = 48, MAX_RIPPLES = 6;   // game_common.hpp pools
+
+struct CostModel {
+  int    base_us = 2200;        // logic, HUD, background windows
+  int    particle_us = 95;      // move + blended circle + its dirty windows
+  double ring_ns_px = 180;      // blended ring pixels
+  int    tap_us = 600;          // hit test, respawn, spawning
+  int    jitter_pct = 15;
+};
+
+struct Phase {
+  const char *name;
+  int    seconds;
+  int    tap_every;   // frames between taps
+  double load;        // multiplier on base cost (bus contention, other tasks)
+};
+
+const Phase PHASES[] = {
+  { "quiet",       10, 120, 1.0 },
+  { "storm",       10,   6, 1.0 },
+  { "storm+load",  10,   6, 1.8 },
+  { "quiet again", 20, 120, 1.0 },
+};
+constexpr int PHASE_COUNT = sizeof(PHASES) / sizeof(PHASES[0]);
+
+uint32_t s_rng = 1;
+int rnd(int lo, int hi)
+{
+  s_rng ^= s_rng << 13; s_rng ^= s_rng >> 17; s_rng ^= s_rng << 5;
+  return lo + (int)(s_rng % (uint32_t)(hi - lo + 1));
+}
+
+struct PhaseStats {
+  int frames = 0, over = 0, changes = 0;
+  int settled_over = 0;   // after the first second of the phase
+  int tier_frames[QUALITY_TIER_COUNT] = {};
+  int last_half_min_tier = QUALITY_TIER_COUNT;
+  std::vector<uint32_t> work;
+  uint32_t p90() { std::sort(work.begin(), work.end()); return work.empty() ? 0 : work[work.size() * 9 / 10]; }
+};
+
+// Runs every phase; `pinned` >= 0 holds that tier instead of governing
+void run(const CostModel &m, uint32_t budget_us, int pinned, bool trace, PhaseStats (&out)[PHASE_COUNT])
+{
+  QualityGovernor gov(budget_us);
+  if (pinned >= 0) gov.pin(pinned);
+  int parts[MAX_PARTICLES] = {};    // frames left, 0 = free
+  int ripples[MAX_RIPPLES] = {};    // radius, 0 = free
+  int frame = 0;
+
+  for (int p = 0; p < PHASE_COUNT; ++p) {
+    const Phase &ph = PHASES[p];
+    PhaseStats &st = out[p];
+    const int frames = ph.seconds * FPS;
+    for (int f = 0; f < frames; ++f, ++frame) {
+      const QualityTier &q = gov.params();
+      int64_t work = (int64_t)(m.base_us * ph.load);
+
+      if (f % ph.tap_every == ph.tap_every / 2) {
+        work += m.tap_us;
+        for (int i = 0, n = 0; i < MAX_PARTICLES && n < q.burst; ++i)
+          if (!parts[i]) { parts[i] = rnd(q.life_min, q.life_max); ++n; }
+        for (int i = 0; i < MAX_RIPPLES; ++i) if (!ripples[i]) { ripples[i] = 2; break; }
+      }
+      for (int &life : parts) if (life) { work += m.particle_us; --life; }
+      for (int &r : ripples) if (r) {
+        work += (int64_t)(2 * 3.14159 * r * q.ring_thickness * m.ring_ns_px / 1000);
+        r = r + 2 >= 40 ? 0 : r + 2;
+      }
+      work = work * rnd(100 - m.jitter_pct, 100 + m.jitter_pct) / 100;
+
+      const int before = gov.tier();
+      gov.frame((uint32_t)work);
+      ++st.frames;
+      st.work.push_back((uint32_t)work);
+      if (work > budget_us) { ++st.over; if (f >= FPS) ++st.settled_over; }
+      ++st.tier_frames[before];
+      if (gov.tier() != before) {
+        ++st.changes;
+        if (trace) std::printf("  %6.2f s  %-11s tier %d -> %d at %u us\n", frame / (double)FPS, ph.name, before,
+                               gov.tier(), (unsigned)work);
+      }
+      if (f >= frames / 2) st.last_half_min_tier = std::min(st.last_half_min_tier, gov.tier());
+    }
+  }
+}
+
+void print(const char *label, PhaseStats (&st)[PHASE_COUNT])
+{
+  std::printf("%s\n  %-12s %6s %8s %8s %8s  time per tier 0..%d\n", label, "phase", "frames", "over %", "p90 us",
+              "changes", QUALITY_TIER_COUNT - 1);
+  for (int p = 0; p < PHASE_COUNT; ++p) {
+    std::printf("  %-12s %6d %8.1f %8u %8d  ", PHASES[p].name, st[p].frames, 100.0 * st[p].over / st[p].frames,
+                (unsigned)st[p].p90(), st[p].changes);
+    for (int t = 0; t < QUALITY_TIER_COUNT; ++t) std::printf(" %3d%%", st[p].tier_frames[t] * 100 / st[p].frames);
+    std::printf("\n");
+  }
+}
+
+int fails = 0;
+void expect(bool ok, const char *what)
+{
+  std::printf("  [%s] %s\n", ok ? "ok" : "FAIL", what);
+  if (!ok) ++fails;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  CostModel m;
+  uint32_t budget_us = 8000;   // QUALITY_BUDGET_US
+  bool trace = false;
+  for (int i = 1; i < argc; ++i) {
+    const char *eq = std::strchr(argv[i], '=');
+    if (!eq) { std::fprintf(stderr, "usage: %s [seed=N] [budget_us=N] [trace=0|1]\n", argv[0]); return 1; }
+    const std::string key(argv[i], eq - argv[i]);
+    const long v = std::atol(eq + 1);
+    if      (key == "seed")      s_rng = v ? (uint32_t)v : 1;
+    else if (key == "budget_us") budget_us = (uint32_t)v;
+    else if (key == "trace")     trace = v != 0;
+    else { std::fprintf(stderr, "unknown option %s\n", key.c_str()); return 1; }
+  }
+
+  const uint32_t seed = s_rng;
+  PhaseStats gov[PHASE_COUNT], fixed[PHASE_COUNT];
+  if (trace) std::printf("governor tier changes:\n");
+  run(m, budget_us, -1, trace, gov);
+  s_rng = seed;
+  run(m, budget_us, QUALITY_DEFAULT_TIER, false, fixed);
+
+  std::printf("budget %u us per frame, %d fps model\n", (unsigned)budget_us, FPS);
+  print("governor:", gov);
+  print("fixed tier 2:", fixed);
+
+  std::printf("checks:\n");
+  const int top = QUALITY_TIER_COUNT - 1;
+  expect(gov[0].last_half_min_tier == top, "quiet play climbs to the top tier");
+  expect(gov[3].last_half_min_tier == top, "and climbs back after the storm");
+  for (int p = 0; p < PHASE_COUNT; ++p) {
+    char what[96];
+    std::snprintf(what, sizeof(what), "%s: p90 frame work within budget (fixed: %u us)", PHASES[p].name,
+                  (unsigned)fixed[p].p90());
+    expect(gov[p].p90() <= budget_us, what);
+  }
+  for (int p = 1; p <= 2; ++p) {
+    char what[96];
+    std::snprintf(what, sizeof(what), "%s: once settled, at most 5%% of frames over budget", PHASES[p].name);
+    expect(gov[p].settled_over * 20 <= gov[p].frames - FPS, what);
+  }
+  expect(gov[2].over < fixed[2].over, "storm+load: fewer frames over budget than the fixed settings");
+  for (int p = 0; p < PHASE_COUNT; ++p) {
+    char what[96];
+    std::snprintf(what, sizeof(what), "%s: no more than %d tier changes", PHASES[p].name, PHASES[p].seconds);
+    expect(gov[p].changes <= PHASES[p].seconds, what);
+  }
+  return fails ? 1 : 0;
+}
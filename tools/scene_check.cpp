@@ -0,0 +1,502 @@
+// Host check of the layered scene against direct drawing: random scenes are
+// built and then mutated frame after frame (moves, removes, recolours,
+// radius, visibility, alpha and text changes, view resets), and after every
+// flush the panel must match, pixel for pixel, the same nodes drawn
+// straight onto a blank canvas from the background up, layer by layer.
+// A stale pixel left by a dirty area that was too small, or an object
+// damaged by repainting its neighbour, shows up as a mismatch. Every flush
+// must also send exactly the windows its stats count, and fixed cases pin
+// how rect_merge and the band strips decide the window count.
+//   g++ -std=c++17 -O2 -DLGFX_HEADLESS=1 -I tools/host_lgfx -I main tools/scene_check.cpp
+//       main/scene.cpp main/rect_merge.cpp main/blend565.cpp -o scene_check       (as one command)
+//   ./scene_check [seeds=8] [frames=400] [ops=12] [dump=DIR]
+// Odd seeds split the panel into two views like SPLIT_SCREEN; every third
+// seed paints a background pattern. dump=DIR writes the panel and the
+// reference of the first mismatch as PPM.
+#include "scene.hpp"
+#include "blend565.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int DISPLAY_ROTATION = 1;   // as main.cpp
+
+struct Options {
+  int         seeds = 8;
+  int         frames = 400;
+  int         ops = 12;          // mutations per frame, at most
+  std::string dump;
+};
+
+struct XorShift {
+  uint32_t s;
+  int operator()(int lo, int hi)
+  {
+    s ^= s << 13; s ^= s >> 17; s ^= s << 5;
+    return lo + (int)(s % (uint32_t)(hi - lo + 1));
+  }
+};
+
+enum Kind { RECT, CIRCLE, RING, PANEL, TEXT, KINDS };
+
+// What the check believes handle h is, in screen coordinates
+struct Model {
+  bool     live = false;
+  int      kind, layer, view;
+  int      x, y, w, h;            // as Scene::Node: circle/ring center, radius, thickness
+  int      aux;                   // panel radius or text size
+  uint16_t color, color2;
+  uint8_t  alpha = 255;
+  bool     visible = true;
+  char     text[Scene::TEXT_LEN];
+};
+
+struct ViewModel {
+  Rect         area;
+  uint16_t     bg;
+  BackgroundFn pattern;
+  bool         live;
+};
+
+void checker(lgfx::LovyanGFX &dst, int ox, int oy, int x, int y, int w, int h)
+{
+  for (int cy = y & ~7; cy < y + h; cy += 8)
+    for (int cx = x & ~7; cx < x + w; cx += 8)
+      dst.fillRect(cx - ox, cy - oy, 8, 8, ((cx ^ cy) & 8) ? 0x18C3 : 0x0841);
+}
+
+// ---- Reference: every node drawn directly, back to front ----
+
+bool inside(const Model &m, int px, int py)
+{
+  const int dx = px - m.x, dy = py - m.y, d2 = dx * dx + dy * dy;
+  switch (m.kind) {
+    case RECT:   return px >= m.x && px < m.x + m.w && py >= m.y && py < m.y + m.h;
+    case CIRCLE: return d2 <= m.w * m.w;
+    default: {
+      const int ri = m.w - m.h;
+      return d2 <= m.w * m.w && (ri < 0 || d2 > ri * ri);
+    }
+  }
+}
+
+void draw_reference(lgfx::LGFX_Sprite &ref, const std::vector<Model> &nodes, const ViewModel *views, uint16_t bg,
+                    BackgroundFn pattern)
+{
+  const int W = ref.width(), H = ref.height();
+  ref.clearClipRect();
+  if (pattern) pattern(ref, 0, 0, 0, 0, W, H);
+  else ref.fillRect(0, 0, W, H, bg);
+  for (int v = 1; v < Scene::MAX_VIEWS; ++v) {
+    const ViewModel &vm = views[v];
+    if (!vm.live) continue;
+    ref.setClipRect(vm.area.x, vm.area.y, vm.area.w, vm.area.h);
+    if (vm.pattern) vm.pattern(ref, 0, 0, vm.area.x, vm.area.y, vm.area.w, vm.area.h);
+    else ref.fillRect(vm.area.x, vm.area.y, vm.area.w, vm.area.h, vm.bg);
+  }
+  uint16_t *px = static_cast<uint16_t *>(ref.getBuffer());
+  for (int l = 0; l < LAYER_COUNT; ++l)
+    for (const Model &m : nodes) {
+      if (!m.live || m.layer != l || !m.visible || !m.alpha) continue;
+      Rect clip = { 0, 0, (int16_t)W, (int16_t)H };
+      if (m.view) clip = views[m.view].area;
+      ref.setClipRect(clip.x, clip.y, clip.w, clip.h);
+      if (m.alpha < 255 && (m.kind == RECT || m.kind == CIRCLE || m.kind == RING)) {
+        for (int y = clip.y; y < clip.y + clip.h; ++y)
+          for (int x = clip.x; x < clip.x + clip.w; ++x)
+            if (inside(m, x, y)) {
+              uint16_t &p = px[y * W + x];
+              p = __builtin_bswap16(blend565(__builtin_bswap16(p), m.color, m.alpha));
+            }
+        continue;
+      }
+      switch (m.kind) {
+        case RECT:   ref.fillRect(m.x, m.y, m.w, m.h, m.color); break;
+        case CIRCLE: ref.fillCircle(m.x, m.y, m.w, m.color); break;
+        case RING:   for (int k = 0; k < m.h && m.w - k > 0; ++k) ref.drawCircle(m.x, m.y, m.w - k, m.color); break;
+        case PANEL:
+          ref.fillRoundRect(m.x, m.y, m.w, m.h, m.aux, m.color);
+          ref.drawRoundRect(m.x, m.y, m.w, m.h, m.aux, m.color2);
+          break;
+        case TEXT:
+          ref.setFont(&fonts::Font0);
+          ref.setTextSize(m.aux);
+          ref.setTextColor(m.color);
+          ref.setCursor(m.x, m.y);
+          ref.print(m.text);
+          break;
+      }
+    }
+  ref.clearClipRect();
+}
+
+// ---- One randomised run ----
+
+struct RunStats {
+  long frames = 0, ops = 0;
+  FlushStats flush = {};
+  bool ok = true;
+};
+
+void write_ppm(const std::string &path, const uint16_t *be, int w, int h)
+{
+  FILE *f = std::fopen(path.c_str(), "wb");
+  if (!f) return;
+  std::fprintf(f, "P6\n%d %d\n255\n", w, h);
+  for (int i = 0; i < w * h; ++i) {
+    const uint16_t c = __builtin_bswap16(be[i]);
+    const uint8_t rgb[3] = { (uint8_t)((c >> 11) * 255 / 31), (uint8_t)(((c >> 5) & 63) * 255 / 63),
+                             (uint8_t)((c & 31) * 255 / 31) };
+    std::fwrite(rgb, 1, 3, f);
+  }
+  std::fclose(f);
+}
+
+class Run {
+public:
+  Run(LGFX &panel, Scene &scene, uint32_t seed, const Options &o)
+    : panel_(panel), scene_(scene), rng_{ seed * 2654435761u | 1 }, opt_(o), seed_(seed), nodes_(Scene::MAX_NODES)
+  {
+    W_ = panel.width(); H_ = panel.height();
+    ref_.createSprite(W_, H_);
+    got_.resize((size_t)W_ * H_);
+    split_ = seed & 1;
+    pattern_ = seed % 3 == 0 ? checker : nullptr;
+  }
+
+  RunStats go()
+  {
+    RunStats st;
+    const FlushStats f0 = scene_.flush_stats();
+    scene_.select_view(0);
+    bg_ = (uint16_t)rng_(0, 0xFFFF) & 0x39E7;   // dark
+    scene_.reset(bg_, pattern_);
+    for (auto &m : nodes_) m.live = false;
+    for (auto &v : views_) v.live = false;
+    if (split_) {
+      const int half = H_ / 2;
+      views_[1].area = { 0, 0, (int16_t)W_, (int16_t)half };
+      views_[2].area = { 0, (int16_t)half, (int16_t)W_, (int16_t)(H_ - half) };
+      for (int v = 1; v <= 2; ++v) {
+        scene_.set_view(v, views_[v].area.x, views_[v].area.y, views_[v].area.w, views_[v].area.h);
+        reset_view(v);
+      }
+    }
+    for (int i = 0; i < 40; ++i) add();
+
+    for (int f = 0; f < opt_.frames && st.ok; ++f) {
+      const int n = rng_(0, opt_.ops);
+      for (int i = 0; i < n; ++i) mutate();
+      st.ops += n;
+      const uint32_t counted = scene_.flush_stats().windows, sent = panel_.transfers();
+      scene_.flush();
+      ++st.frames;
+      st.ok = compare(f);
+      if (scene_.flush_stats().windows - counted != panel_.transfers() - sent) {
+        std::printf("  seed %u frame %d: flush counted %u windows but sent %u\n", (unsigned)seed_, f,
+                    (unsigned)(scene_.flush_stats().windows - counted), (unsigned)(panel_.transfers() - sent));
+        st.ok = false;
+      }
+    }
+    const FlushStats &f1 = scene_.flush_stats();
+    st.flush = { f1.dirty_rects - f0.dirty_rects, f1.windows - f0.windows, f1.pixels - f0.pixels };
+    return st;
+  }
+
+private:
+  int pick_view() { return split_ ? rng_(1, 2) : 0; }
+
+  void reset_view(int v)
+  {
+    views_[v].bg = (uint16_t)rng_(0, 0xFFFF) & 0x39E7;
+    views_[v].pattern = rng_(0, 1) ? checker : nullptr;
+    views_[v].live = true;
+    scene_.select_view(v);
+    scene_.reset(views_[v].bg, views_[v].pattern);
+    scene_.select_view(0);
+    for (auto &m : nodes_) if (m.view == v) m.live = false;
+  }
+
+  void add()
+  {
+    Model m;
+    m.view = pick_view();
+    const Rect area = m.view ? views_[m.view].area : Rect{ 0, 0, (int16_t)W_, (int16_t)H_ };
+    m.kind = rng_(0, KINDS - 1);
+    m.layer = rng_(0, LAYER_COUNT - 1);
+    m.color = (uint16_t)rng_(0, 0xFFFF);
+    m.color2 = (uint16_t)rng_(0, 0xFFFF);
+    // Local coordinates, partly off the view's edges now and then
+    const int lx = rng_(-20, area.w + 10), ly = rng_(-20, area.h + 10);
+    int h = -1;
+    SceneView view(scene_, m.view);
+    switch (m.kind) {
+      case RECT:
+        m.w = rng_(1, 90); m.h = rng_(1, 60);
+        h = view.add_rect((Layer)m.layer, lx, ly, m.w, m.h, m.color);
+        break;
+      case CIRCLE:
+        m.w = rng_(1, 40);
+        h = view.add_circle((Layer)m.layer, lx, ly, m.w, m.color);
+        break;
+      case RING:
+        m.w = rng_(2, 60); m.h = rng_(1, 6);
+        h = view.add_ring((Layer)m.layer, lx, ly, m.w, m.h, m.color);
+        break;
+      case PANEL:
+        m.w = rng_(8, 120); m.h = rng_(8, 70); m.aux = rng_(0, 10);
+        h = view.add_panel((Layer)m.layer, lx, ly, m.w, m.h, m.aux, m.color, m.color2);
+        break;
+      case TEXT:
+        m.aux = rng_(1, 3);
+        random_text(m.text);
+        h = view.add_text((Layer)m.layer, lx, ly, m.aux, m.color, m.text);
+        break;
+    }
+    if (h < 0) return;   // pool full
+    m.x = lx + area.x; m.y = ly + area.y;
+    m.live = true;
+    nodes_[h] = m;
+  }
+
+  void random_text(char *out)
+  {
+    static const char CHARS[] = "0123456789 ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz:+-!?";
+    const int n = rng_(0, 14);
+    for (int i = 0; i < n; ++i) out[i] = CHARS[rng_(0, (int)sizeof(CHARS) - 2)];
+    out[n] = 0;
+  }
+
+  int pick_live()
+  {
+    for (int tries = 0; tries < 8; ++tries) {
+      const int h = rng_(0, Scene::MAX_NODES - 1);
+      if (nodes_[h].live) return h;
+    }
+    return -1;
+  }
+
+  void mutate()
+  {
+    const int what = rng_(0, 99);
+    if (what < 12) { add(); return; }
+    if (what == 99 && split_) { reset_view(rng_(1, 2)); return; }
+    const int h = pick_live();
+    if (h < 0) { add(); return; }
+    Model &m = nodes_[h];
+    const Rect area = m.view ? views_[m.view].area : Rect{ 0, 0, (int16_t)W_, (int16_t)H_ };
+    if (what < 20) {
+      scene_.remove(h);
+      m.live = false;
+    } else if (what < 55) {
+      // Mostly small steps, as balls and particles move
+      const int nx = m.x - area.x + rng_(-12, 12), ny = m.y - area.y + rng_(-12, 12);
+      scene_.move(h, nx, ny);
+      m.x = nx + area.x; m.y = ny + area.y;
+    } else if (what < 65) {
+      m.color = (uint16_t)rng_(0, 0xFFFF);
+      if (rng_(0, 1)) m.color2 = (uint16_t)rng_(0, 0xFFFF);
+      scene_.set_colors(h, m.color, m.color2);
+    } else if (what < 75) {
+      if (m.kind != CIRCLE && m.kind != RING) return;
+      m.w = std::max(1, m.w + rng_(-6, 8));
+      scene_.set_radius(h, m.w);
+    } else if (what < 82) {
+      m.visible = !m.visible;
+      scene_.set_visible(h, m.visible);
+    } else if (what < 92) {
+      m.alpha = (uint8_t)(rng_(0, 3) ? rng_(0, 255) : 255);
+      scene_.set_alpha(h, m.alpha);
+    } else {
+      if (m.kind != TEXT) return;
+      random_text(m.text);
+      scene_.set_text(h, "%s", m.text);
+    }
+  }
+
+  bool compare(int frame)
+  {
+    draw_reference(ref_, nodes_, views_, bg_, pattern_);
+    panel_.readRect(0, 0, W_, H_, reinterpret_cast<lgfx::swap565_t *>(got_.data()));
+    const uint16_t *want = static_cast<const uint16_t *>(ref_.getBuffer());
+    int bad = 0, fx = -1, fy = -1;
+    for (int i = 0; i < W_ * H_; ++i)
+      if (got_[i] != want[i] && bad++ == 0) { fx = i % W_; fy = i / W_; }
+    if (!bad) return true;
+    std::printf("  seed %u frame %d: %d pixels differ from direct drawing, first at (%d,%d)\n", (unsigned)seed_,
+                frame, bad, fx, fy);
+    if (!opt_.dump.empty()) {
+      const std::string base = opt_.dump + "/seed" + std::to_string(seed_) + "_" + std::to_string(frame);
+      write_ppm(base + "_panel.ppm", got_.data(), W_, H_);
+      write_ppm(base + "_reference.ppm", want, W_, H_);
+      std::printf("    written %s_panel.ppm and _reference.ppm\n", base.c_str());
+    }
+    return false;
+  }
+
+  LGFX              &panel_;
+  Scene             &scene_;
+  XorShift           rng_;
+  const Options     &opt_;
+  uint32_t           seed_;
+  int                W_, H_;
+  bool               split_;
+  uint16_t           bg_ = 0;
+  BackgroundFn       pattern_;
+  lgfx::LGFX_Sprite  ref_;
+  std::vector<uint16_t> got_;
+  std::vector<Model> nodes_;
+  ViewModel          views_[Scene::MAX_VIEWS] = {};
+};
+
+// ---- Window counts ----
+
+int g_window_failures = 0;
+
+void check(bool ok, const char *what)
+{
+  std::printf("  [%s] %s\n", ok ? "ok" : "FAIL", what);
+  if (!ok) ++g_window_failures;
+}
+
+int32_t send_cost(const Rect *r, int n, int band_px)
+{
+  int32_t c = 0;
+  for (int i = 0; i < n; ++i) c += (int32_t)r[i].w * r[i].h + rect_windows(r[i], band_px) * WINDOW_COST_PX;
+  return c;
+}
+
+bool contains(const Rect &outer, const Rect &in)
+{
+  return in.x >= outer.x && in.y >= outer.y && in.x + in.w <= outer.x + outer.w && in.y + in.h <= outer.y + outer.h;
+}
+
+void merge_cases()
+{
+  constexpr int BAND = Scene::BAND_PIXELS;
+  Rect corner[2] = { { 0, 0, 100, 1 }, { 0, 0, 1, 100 } };
+  check(rect_merge(corner, 2, WINDOW_COST_PX, BAND) == 2, "merge: 100x1 and 1x100 sharing a corner stay apart");
+
+  Rect near[2] = { { 10, 10, 40, 40 }, { 15, 14, 40, 40 } };
+  check(rect_merge(near, 2, WINDOW_COST_PX, BAND) == 1, "merge: two mostly overlapping boxes become one window");
+
+  // Stacked 64x80 with a one-row gap: 64 px of gap would pay for one window,
+  // but 64x161 is sent as three 80-row bands against two
+  Rect stack[2] = { { 0, 0, 64, 80 }, { 0, 81, 64, 80 } };
+  Rect stack_flat[2] = { stack[0], stack[1] };
+  check(rect_merge(stack_flat, 2) == 1 && rect_merge(stack, 2, WINDOW_COST_PX, BAND) == 2,
+        "merge: counting bands keeps apart a pair whose union needs more windows");
+
+  // Random sets: every input still covered, never dearer than sending them as is
+  XorShift rng{ 77 };
+  bool covered = true, cheaper = true;
+  for (int t = 0; t < 2000; ++t) {
+    Rect in[24], out[24];
+    const int n = rng(1, 24);
+    for (int i = 0; i < n; ++i)
+      in[i] = { (int16_t)rng(0, 300), (int16_t)rng(0, 220), (int16_t)rng(1, rng(0, 3) ? 30 : 320),
+                (int16_t)rng(1, rng(0, 3) ? 30 : 240) };
+    std::memcpy(out, in, sizeof(in));
+    const int m = rect_merge(out, n, WINDOW_COST_PX, BAND);
+    for (int i = 0; i < n; ++i) {
+      bool in_one = false;
+      for (int k = 0; k < m; ++k) in_one |= contains(out[k], in[i]);
+      covered &= in_one;
+    }
+    cheaper &= send_cost(out, m, BAND) <= send_cost(in, n, BAND);
+  }
+  check(covered && cheaper, "merge: 2000 random sets stay covered and never cost more than unmerged");
+}
+
+void flush_cases(LGFX &panel, Scene &scene)
+{
+  constexpr int BAND = Scene::BAND_PIXELS;
+  const int W = panel.width(), H = panel.height();
+  char what[128];
+  auto windows_of = [&](const char *name, int expect) {
+    const uint32_t counted = scene.flush_stats().windows, sent = panel.transfers();
+    scene.flush();
+    const uint32_t c = scene.flush_stats().windows - counted, s = panel.transfers() - sent;
+    std::snprintf(what, sizeof(what), "flush: %s sends %d windows (counted %u, sent %u)", name, expect, (unsigned)c,
+                  (unsigned)s);
+    check(c == (uint32_t)expect && s == (uint32_t)expect, what);
+  };
+
+  scene.select_view(0);
+  scene.reset(0x0000);
+  const Rect full = { 0, 0, (int16_t)W, (int16_t)H };
+  char name[48];
+  std::snprintf(name, sizeof(name), "the full %dx%d redraw", W, H);
+  windows_of(name, rect_windows(full, BAND));
+
+  // A tall, narrow node moved across: two 30x200 areas, two bands each
+  SceneView view(scene, 0);
+  const int tall = view.add_rect(LAYER_PLAY, 10, 20, 30, 200, 0xFFFF);
+  scene.flush();
+  scene.move(tall, 200, 20);
+  Rect moved[2] = { { 10, 20, 30, 200 }, { 200, 20, 30, 200 } };
+  const int nm = rect_merge(moved, 2, WINDOW_COST_PX, BAND);
+  windows_of("a 30x200 node moved across", rect_windows(moved[0], BAND) + (nm > 1 ? rect_windows(moved[1], BAND) : 0));
+  scene.remove(tall);
+  scene.flush();
+
+  // The stacked pair from merge_cases, repainted together
+  const int a = view.add_rect(LAYER_PLAY, 0, 0, 64, 80, 0xF800);
+  const int b = view.add_rect(LAYER_PLAY, 0, 81, 64, 80, 0x001F);
+  scene.flush();
+  scene.set_colors(a, 0x07E0, 0);
+  scene.set_colors(b, 0x07E0, 0);
+  windows_of("two stacked 64x80 nodes", 2);
+  scene.remove(a);
+  scene.remove(b);
+  scene.flush();
+}
+
+bool parse(int argc, char **argv, Options &o)
+{
+  for (int i = 1; i < argc; ++i) {
+    const char *eq = std::strchr(argv[i], '=');
+    if (!eq) return false;
+    const std::string key(argv[i], eq - argv[i]), v(eq + 1);
+    if      (key == "seeds")  o.seeds = std::atoi(v.c_str());
+    else if (key == "frames") o.frames = std::atoi(v.c_str());
+    else if (key == "ops")    o.ops = std::atoi(v.c_str());
+    else if (key == "dump")   o.dump = v;
+    else return false;
+  }
+  return o.seeds > 0 && o.frames > 0 && o.ops >= 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  Options o;
+  if (!parse(argc, argv, o)) {
+    std::fprintf(stderr, "usage: %s [seeds=N] [frames=N] [ops=N] [dump=DIR]\n", argv[0]);
+    return 2;
+  }
+  static LGFX panel;
+  if (!panel.init()) { std::fprintf(stderr, "canvas allocation failed\n"); return 2; }
+  panel.setRotation(DISPLAY_ROTATION);
+  static Scene scene(panel);
+
+  merge_cases();
+  flush_cases(panel, scene);
+
+  int failed = 0;
+  for (int s = 1; s <= o.seeds; ++s) {
+    const RunStats st = Run(panel, scene, (uint32_t)s, o).go();
+    std::printf("  [%s] seed %d%s%s: %ld frames, %ld mutations, %u dirty rects -> %u windows, %.1f kpx/frame\n",
+                st.ok ? "ok" : "FAIL", s, (s & 1) ? " split" : "", s % 3 == 0 ? " pattern" : "", st.frames, st.ops,
+                (unsigned)st.flush.dirty_rects, (unsigned)st.flush.windows, st.flush.pixels / 1000.0 / st.frames);
+    failed += !st.ok;
+  }
+  std::printf("%s: %d of %d runs differ from direct drawing, %d window checks failed\n",
+              failed || g_window_failures ? "FAIL" : "ok", failed, o.seeds, g_window_failures);
+  return failed || g_window_failures ? 1 : 0;
+}
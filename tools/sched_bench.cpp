@@ -0,0 +1,143 @@
+// Host benchmark of the game scheduler's per-frame overhead: the same
+// trivial game stepped by a direct call, through GameScheduler with one
+// and two slots (touch routed by area), and handed between two threads
+// the way a task per game would hand over the frame:
+//   g++ -std=c++17 -O2 -pthread -I main tools/sched_bench.cpp main/game_sched.cpp main/gesture.cpp -o sched_bench
+//   ./sched_bench [frames=2000000] [threads=1]
+// Only differences between the rows mean anything; the games do almost
+// no work on purpose.
+#include "game_sched.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+
+namespace {
+
+// A touch every few frames, alternating between the two halves of a
+// 320x240 panel, so routing and ownership both get exercised
+struct FakeTouch {
+  GestureRecognizer g;
+  uint32_t t = 0, n = 0;
+};
+
+bool fake_input(void *ctx, GestureEvent &ev)
+{
+  FakeTouch &f = *static_cast<FakeTouch *>(ctx);
+  f.t += 16;
+  const uint32_t k = f.n++ % 24;
+  const bool pressed = k < 6;
+  const uint16_t y = (f.n / 24) & 1 ? 180 : 60;
+  return f.g.feed(f.t, pressed, (uint16_t)(100 + k), y, ev);
+}
+
+volatile uint32_t s_sink;
+
+struct Counter final : GameTask {
+  uint32_t frames = 0, hits = 0;
+  void begin(GameView &) override {}
+  GameStep step(GameView &v) override
+  {
+    ++frames;
+    if (const GestureEvent *ev = v.input()) hits += ev->type == GESTURE_DOWN;
+    return GAME_CONTINUE;
+  }
+  void end(GameView &) override { s_sink = frames + hits; }
+};
+
+GameTask *make_counter(void *mem) { return new (mem) Counter(); }
+const GameFactory GAMES[] = { make_counter, make_counter };
+
+double ns_per_frame(std::chrono::steady_clock::time_point t0, uint32_t frames)
+{
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / frames;
+}
+
+double bench_direct(uint32_t frames)
+{
+  FakeTouch touch;
+  uint32_t count = 0, hits = 0;
+  const auto t0 = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < frames; ++i) {
+    GestureEvent ev;
+    ++count;
+    if (fake_input(&touch, ev)) hits += ev.type == GESTURE_DOWN;
+  }
+  const double ns = ns_per_frame(t0, frames);
+  s_sink = count + hits;
+  return ns;
+}
+
+double bench_sched(uint32_t frames, int slots)
+{
+  FakeTouch touch;
+  GameScheduler sched(GAMES, 2, fake_input, &touch);
+  if (slots == 1) {
+    sched.start(0, 0, game_view(nullptr, nullptr, 0, 0, 0, 320, 240));
+  } else {
+    sched.start(0, 0, game_view(nullptr, nullptr, 1, 0, 0, 320, 120));
+    sched.start(1, 1, game_view(nullptr, nullptr, 2, 0, 120, 320, 120));
+  }
+  const auto t0 = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < frames; ++i) sched.frame();
+  const double ns = ns_per_frame(t0, frames);
+  for (int s = 0; s < slots; ++s) sched.stop(s);
+  return ns;
+}
+
+// Two threads taking turns, one frame each: the cost a task per game pays
+// to hand the frame over, with none of the scheduling work above
+double bench_threads(uint32_t frames)
+{
+  std::mutex m;
+  std::condition_variable cv;
+  int turn = 0;
+  auto worker = [&](int me) {
+    for (uint32_t i = me; i < frames; i += 2) {
+      std::unique_lock<std::mutex> lock(m);
+      cv.wait(lock, [&] { return turn == me; });
+      turn = 1 - me;
+      cv.notify_one();
+    }
+  };
+  const auto t0 = std::chrono::steady_clock::now();
+  std::thread a(worker, 0), b(worker, 1);
+  a.join();
+  b.join();
+  return ns_per_frame(t0, frames);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  uint32_t frames = 2000000;
+  bool threads = true;
+  for (int i = 1; i < argc; ++i) {
+    const char *eq = std::strchr(argv[i], '=');
+    const std::string key = eq ? std::string(argv[i], eq - argv[i]) : argv[i];
+    const long v = eq ? std::atol(eq + 1) : 0;
+    if      (key == "frames")  frames = v > 0 ? (uint32_t)v : frames;
+    else if (key == "threads") threads = v != 0;
+    else { std::fprintf(stderr, "usage: %s [frames=N] [threads=0|1]\n", argv[0]); return 2; }
+  }
+
+  const double direct = bench_direct(frames);
+  const double one = bench_sched(frames, 1), two = bench_sched(frames, 2);
+  std::printf("%u frames, touch read every frame\n", (unsigned)frames);
+  std::printf("  direct call          %7.1f ns/frame\n", direct);
+  std::printf("  scheduler, 1 slot    %7.1f ns/frame  (+%.1f)\n", one, one - direct);
+  std::printf("  scheduler, 2 slots   %7.1f ns/frame  (+%.1f)\n", two, two - direct);
+  if (threads) {
+    const uint32_t n = frames / 20 ? frames / 20 : 1;   // far slower; fewer rounds
+    std::printf("  thread handoff       %7.1f ns/frame  (%u frames)\n", bench_threads(n), (unsigned)n);
+  }
+  std::printf("sizeof(GameScheduler) = %zu bytes for %d slots of %zu-byte game state\n", sizeof(GameScheduler),
+              SCHED_SLOTS, GAME_STATE_BYTES);
+  return 0;
+}
@@ -0,0 +1,253 @@
+// Host power-loss check of the score log on a file-backed flash: one
+// scripted session of appends (enough to compact several times) is replayed
+// with power cut at every byte the log programs or erases, then the log is
+// reopened from the file as after a reboot. The stats it loads must be the
+// last committed ones, with only the slots of the interrupted append allowed
+// to hold the new value, and the log must keep working: the rest of the
+// session is appended, compacting past the torn record, and must read back
+// exactly.
+//   g++ -std=c++17 -O2 -I main tools/score_log_check.cpp main/score_log.cpp -o score_log_check
+//   ./score_log_check [sector=512] [ops=120] [seed=1] [file=score_log_check.bin]
+// Like NOR flash, writes only clear bits; the byte at the cut is left half
+// programmed and a cut erase leaves the tail of the sector as it was.
+#include "score_log.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Options {
+  size_t      sector = 512;
+  int         ops = 120;
+  uint32_t    seed = 1;
+  std::string file = "score_log_check.bin";
+};
+
+// Two sectors back to back in one file; `cut` counts down the bytes that may
+// still be programmed or erased before the power goes
+class FileFlash : public FlashBackend {
+public:
+  FileFlash(const std::string &path, size_t sector) : sector_(sector)
+  {
+    f_ = std::fopen(path.c_str(), "w+b");
+    if (!f_) return;
+    const std::vector<uint8_t> blank(2 * sector, 0xFF);
+    std::fwrite(blank.data(), 1, blank.size(), f_);
+    std::fflush(f_);
+  }
+  ~FileFlash() override { if (f_) std::fclose(f_); }
+
+  bool   ok() const { return f_ != nullptr; }
+  size_t sector_size() const override { return sector_; }
+  void   set_cut(long bytes) { cut_ = bytes; }
+  bool   powered() const { return cut_ != 0; }
+  long   programmed() const { return programmed_; }
+
+  bool read(int sector, size_t off, void *dst, size_t len) override
+  {
+    if (!in_range(sector, off, len)) return false;
+    std::fseek(f_, (long)(sector * sector_ + off), SEEK_SET);
+    return std::fread(dst, 1, len, f_) == len;
+  }
+
+  bool write(int sector, size_t off, const void *src, size_t len) override
+  {
+    if (!in_range(sector, off, len) || !powered()) return false;
+    std::vector<uint8_t> cur(len);
+    if (!read(sector, off, cur.data(), len)) return false;
+    const uint8_t *b = static_cast<const uint8_t *>(src);
+    size_t n = 0;
+    for (; n < len && cut_ != 0; ++n, ++programmed_) {
+      if (cut_ > 0) --cut_;
+      cur[n] &= b[n];
+    }
+    if (n < len) cur[n] &= (uint8_t)(b[n] | 0xA5);   // half programmed
+    store(sector, off, cur.data(), len);
+    return n == len;
+  }
+
+  bool erase(int sector) override
+  {
+    if (sector < 0 || sector > 1 || !powered()) return false;
+    std::vector<uint8_t> cur(sector_);
+    if (!read(sector, 0, cur.data(), sector_)) return false;
+    size_t n = 0;
+    for (; n < sector_ && cut_ != 0; ++n, ++programmed_) {
+      if (cut_ > 0) --cut_;
+      cur[n] = 0xFF;
+    }
+    store(sector, 0, cur.data(), sector_);
+    return n == sector_;
+  }
+
+private:
+  bool in_range(int sector, size_t off, size_t len) const
+  {
+    return f_ && (sector == 0 || sector == 1) && off + len <= sector_;
+  }
+  void store(int sector, size_t off, const uint8_t *p, size_t len)
+  {
+    std::fseek(f_, (long)(sector * sector_ + off), SEEK_SET);
+    std::fwrite(p, 1, len, f_);
+    std::fflush(f_);
+  }
+
+  FILE  *f_ = nullptr;
+  size_t sector_;
+  long   cut_ = -1;         // < 0: never
+  long   programmed_ = 0;
+};
+
+// One append of the session: the slots in `mask` take new values
+struct Op {
+  uint32_t  mask;
+  GameStats after[SCORE_SLOTS];
+};
+
+std::vector<Op> make_session(const Options &o)
+{
+  std::vector<Op> ops;
+  GameStats st[SCORE_SLOTS] = {};
+  uint32_t s = o.seed;
+  auto next = [&s] { s ^= s << 13; s ^= s >> 17; s ^= s << 5; return s; };
+  for (int i = 0; i < o.ops; ++i) {
+    // Mostly one game, sometimes a session end touching two
+    uint32_t mask = 1u << (next() % SCORE_SLOTS);
+    if (next() % 4 == 0) mask |= 1u << (next() % SCORE_SLOTS);
+    for (int k = 0; k < SCORE_SLOTS; ++k) if (mask & (1u << k)) {
+      GameStats &g = st[k];
+      const uint32_t score = next() % 500;
+      g.sessions++;
+      g.total_score += score;
+      g.total_miss += next() % 7;
+      if (score > g.best_score) g.best_score = score;
+    }
+    Op op;
+    op.mask = mask;
+    std::memcpy(op.after, st, sizeof(st));
+    ops.push_back(op);
+  }
+  return ops;
+}
+
+bool same(const GameStats &a, const GameStats &b) { return std::memcmp(&a, &b, sizeof(a)) == 0; }
+
+struct Result {
+  int  torn_op = -1;          // op the power went during; -1: none
+  bool torn_in_compaction = false;
+};
+
+// Runs ops[from..] on a fresh ScoreLog until the power goes
+Result run_ops(FileFlash &flash, const std::vector<Op> &ops, size_t from)
+{
+  Result r;
+  ScoreLog log(flash);
+  GameStats loaded[SCORE_SLOTS];
+  if (!log.load(loaded)) return r;
+  for (size_t i = from; i < ops.size(); ++i) {
+    const bool compacting = log.free_slots() < (size_t)__builtin_popcount(ops[i].mask);
+    if (!log.append(ops[i].after, ops[i].mask) || !flash.powered()) {
+      r.torn_op = (int)i;
+      r.torn_in_compaction = compacting;
+      return r;
+    }
+  }
+  return r;
+}
+
+bool expect(const char *what, long cut, const GameStats *got, const GameStats *want)
+{
+  for (int k = 0; k < SCORE_SLOTS; ++k)
+    if (!same(got[k], want[k])) {
+      std::printf("FAIL cut at byte %ld: %s, slot %d best=%u sessions=%u, expected best=%u sessions=%u\n", cut, what,
+                  k, (unsigned)got[k].best_score, (unsigned)got[k].sessions, (unsigned)want[k].best_score,
+                  (unsigned)want[k].sessions);
+      return false;
+    }
+  return true;
+}
+
+bool parse(int argc, char **argv, Options &o)
+{
+  for (int i = 1; i < argc; ++i) {
+    const char *eq = std::strchr(argv[i], '=');
+    if (!eq) return false;
+    const std::string key(argv[i], eq - argv[i]), v(eq + 1);
+    if      (key == "sector") o.sector = (size_t)std::atoi(v.c_str());
+    else if (key == "ops")    o.ops = std::atoi(v.c_str());
+    else if (key == "seed")   o.seed = (uint32_t)std::strtoul(v.c_str(), nullptr, 0);
+    else if (key == "file")   o.file = v;
+    else return false;
+  }
+  return o.sector >= 8 * ScoreLog::RECORD_SIZE && o.sector % ScoreLog::RECORD_SIZE == 0 && o.ops > 0 && o.seed;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  Options o;
+  if (!parse(argc, argv, o)) {
+    std::fprintf(stderr, "usage: %s [sector=N (multiple of %zu, >= %zu)] [ops=N] [seed=N (non-zero)] [file=PATH]\n",
+                 argv[0], ScoreLog::RECORD_SIZE, 8 * ScoreLog::RECORD_SIZE);
+    return 2;
+  }
+  const std::vector<Op> ops = make_session(o);
+
+  // Uncut run: how many bytes the session programs, and the final state
+  long total;
+  uint32_t generations;
+  {
+    FileFlash flash(o.file, o.sector);
+    if (!flash.ok()) { std::fprintf(stderr, "cannot open %s\n", o.file.c_str()); return 2; }
+    if (run_ops(flash, ops, 0).torn_op >= 0) { std::printf("FAIL: uncut session failed\n"); return 1; }
+    total = flash.programmed();
+    ScoreLog log(flash);
+    GameStats got[SCORE_SLOTS];
+    if (!log.load(got) || !expect("uncut session", -1, got, ops.back().after)) return 1;
+    generations = log.generation();
+  }
+  std::printf("%d appends program %ld bytes over %u compactions (%zu-byte sectors); cutting power at each\n", o.ops,
+              total, (unsigned)generations, o.sector);
+
+  int failures = 0, in_compaction = 0, in_append = 0;
+  for (long cut = 0; cut < total && failures < 10; ++cut) {
+    FileFlash flash(o.file, o.sector);
+    flash.set_cut(cut);
+    const Result r = run_ops(flash, ops, 0);
+    if (r.torn_op < 0) { std::printf("FAIL cut at byte %ld: the session finished anyway\n", cut); ++failures; continue; }
+    (r.torn_in_compaction ? in_compaction : in_append)++;
+
+    // Reboot: committed stats, the torn append's slots either way
+    flash.set_cut(-1);
+    ScoreLog log(flash);
+    GameStats got[SCORE_SLOTS];
+    if (!log.load(got)) { std::printf("FAIL cut at byte %ld: load failed\n", cut); ++failures; continue; }
+    const Op &torn = ops[r.torn_op];
+    GameStats want[SCORE_SLOTS] = {};
+    if (r.torn_op > 0) std::memcpy(want, ops[r.torn_op - 1].after, sizeof(want));
+    for (int k = 0; k < SCORE_SLOTS; ++k)
+      if ((torn.mask & (1u << k)) && same(got[k], torn.after[k])) want[k] = torn.after[k];
+    if (!expect(r.torn_in_compaction ? "after torn compaction" : "after torn record", cut, got, want)) {
+      ++failures;
+      continue;
+    }
+
+    // The rest of the session, from the torn append on, on the recovered log
+    if (run_ops(flash, ops, r.torn_op).torn_op >= 0) {
+      std::printf("FAIL cut at byte %ld: appends after recovery failed\n", cut);
+      ++failures;
+      continue;
+    }
+    ScoreLog again(flash);
+    if (!again.load(got) || !expect("session finished after recovery", cut, got, ops.back().after)) ++failures;
+  }
+  std::remove(o.file.c_str());
+
+  std::printf("%ld cuts: %d in record appends, %d in compactions\n", total, in_append, in_compaction);
+  std::printf("%s: %d failures\n", failures ? "FAIL" : "ok", failures);
+  return failures ? 1 : 0;
+}
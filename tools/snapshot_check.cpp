@@ -0,0 +1,178 @@
+// Host check of the resume snapshot: encoding round trips for every game,
+// rejection of every single-bit flip, torn writes, foreign layouts and
+// garbage, and SnapshotStore's boot/claim/save rules including how the
+// sequence number carries across resets:
+//   g++ -std=c++17 -O2 -I main tools/snapshot_check.cpp main/snapshot.cpp main/score_log.cpp -o snapshot_check
+//   ./snapshot_check
+// Exits non-zero when any case fails.
+#include "snapshot.hpp"
+#include "score_log.hpp"   // crc32_le
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+constexpr int GAMES = 3;   // as games.hpp
+
+int g_failures = 0;
+
+void check(bool ok, const char *what)
+{
+  std::printf("  [%s] %s\n", ok ? "ok" : "FAIL", what);
+  if (!ok) ++g_failures;
+}
+
+bool same(const GameSnapshot &a, const GameSnapshot &b) { return std::memcmp(&a, &b, sizeof(a)) == 0; }
+
+GameSnapshot sample(int game)
+{
+  GameSnapshot s = snapshot_make(game);
+  switch (game) {
+    case 0: s.tap = { 12, 18, 160, 120, -3, 2, 0xF81F }; break;
+    case 1: s.whack = { 7, 2, 40, 200, 850 }; break;
+    default: s.grid = { 30, 4, 1200 }; break;
+  }
+  return s;
+}
+
+void encoding()
+{
+  const GameSnapshot blank = snapshot_make(1);
+  bool zero = true;
+  const uint8_t *b = reinterpret_cast<const uint8_t *>(&blank);
+  for (size_t i = 0; i < sizeof(blank); ++i) zero &= i == offsetof(GameSnapshot, game) ? b[i] == 1 : b[i] == 0;
+  check(zero, "make: every byte zero (padding included) but the game id");
+
+  bool round_trip = true;
+  for (int g = 0; g < GAMES; ++g) {
+    GameSnapshot s = sample(g);
+    snapshot_seal(s);
+    GameSnapshot copy;
+    std::memcpy(&copy, &s, sizeof(s));
+    round_trip &= snapshot_valid(copy, GAMES) && same(copy, s) && copy.game == g;
+  }
+  check(round_trip, "seal: a sealed snapshot of each game is valid and copies byte for byte");
+
+  GameSnapshot a = sample(0), b2 = sample(0);
+  snapshot_seal(a);
+  snapshot_seal(b2);
+  check(same(a, b2), "seal: the same state always seals to the same bytes");
+}
+
+void rejection()
+{
+  GameSnapshot s = sample(1);
+  s.seq = 41;
+  snapshot_seal(s);
+  int missed = 0;
+  for (size_t bit = 0; bit < sizeof(s) * 8; ++bit) {
+    GameSnapshot f = s;
+    reinterpret_cast<uint8_t *>(&f)[bit / 8] ^= (uint8_t)(1u << (bit % 8));
+    missed += snapshot_valid(f, GAMES);
+  }
+  char what[96];
+  std::snprintf(what, sizeof(what), "crc: all %zu single-bit flips rejected", sizeof(s) * 8);
+  check(missed == 0, what);
+
+  // A save cut off part way: the head of the new one over the old one
+  GameSnapshot old = sample(2), next = sample(2);
+  old.seq = 5; old.grid.score = 10;
+  next.seq = 6; next.grid.score = 11;
+  snapshot_seal(old);
+  snapshot_seal(next);
+  int torn_ok = 0;
+  for (size_t cut = 1; cut < sizeof(old); ++cut) {
+    GameSnapshot t = old;
+    std::memcpy(&t, &next, cut);
+    if (snapshot_valid(t, GAMES) && !same(t, old) && !same(t, next)) ++torn_ok;
+  }
+  check(torn_ok == 0, "torn write: no mix of two saves is accepted");
+
+  GameSnapshot g = sample(0);
+  g.game = GAMES;
+  snapshot_seal(g);
+  check(!snapshot_valid(g, GAMES), "game: an id past the game count is rejected even with a good CRC");
+
+  GameSnapshot v = sample(0);
+  snapshot_seal(v);
+  v.version++;
+  v.crc = crc32_le(0, &v, offsetof(GameSnapshot, crc));
+  GameSnapshot m = sample(0);
+  snapshot_seal(m);
+  m.magic ^= 1;
+  m.crc = crc32_le(0, &m, offsetof(GameSnapshot, crc));
+  check(!snapshot_valid(v, GAMES) && !snapshot_valid(m, GAMES), "layout: another version or magic is rejected");
+
+  GameSnapshot zeros, ones;
+  std::memset(&zeros, 0, sizeof(zeros));
+  std::memset(&ones, 0xFF, sizeof(ones));
+  check(!snapshot_valid(zeros, GAMES) && !snapshot_valid(ones, GAMES), "garbage: all-zero and all-one memory rejected");
+}
+
+void store()
+{
+  GameSnapshot rtc;
+  std::memset(&rtc, 0xA5, sizeof(rtc));   // power-on noise
+
+  {
+    SnapshotStore st(rtc);
+    check(!st.boot(true, GAMES) && st.game() == -1 && st.seq() == 0, "boot: noise is a cold start at seq 0");
+    GameSnapshot s = sample(1);
+    st.save(s);
+    check(s.seq == 1 && snapshot_valid(rtc, GAMES) && same(rtc, s), "save: numbered from 1, sealed into the retained copy");
+    GameSnapshot s2 = sample(1);
+    st.save(s2);
+    check(s2.seq == 2 && rtc.seq == 2, "save: each save takes the next number");
+  }
+  {
+    // Soft reset: resume game 1, carry on numbering
+    SnapshotStore st(rtc);
+    check(st.boot(true, GAMES) && st.game() == 1 && st.seq() == 2, "boot: a trusted reset resumes the saved game and seq");
+    GameSnapshot out;
+    check(!st.claim(0, out) && st.game() == 1, "claim: another game gets nothing and leaves it");
+    check(st.claim(1, out) && out.whack.score == 7 && out.seq == 2, "claim: the saved game gets its state");
+    check(!st.claim(1, out) && st.game() == -1, "claim: one-shot");
+    GameSnapshot s = sample(1);
+    st.save(s);
+    check(s.seq == 3, "save: numbering continues from the resumed seq");
+  }
+  {
+    // Panic or watchdog: same memory, not trusted
+    SnapshotStore st(rtc);
+    GameSnapshot out;
+    check(!st.boot(false, GAMES) && st.game() == -1 && !st.claim(1, out), "boot: an untrusted reset ignores a valid snapshot");
+    GameSnapshot s = sample(2);
+    st.save(s);
+    check(s.seq == 1 && rtc.game == 2, "save: after a crash numbering starts over");
+  }
+  {
+    // A reset in the middle of a save
+    GameSnapshot torn = rtc;
+    reinterpret_cast<uint8_t *>(&torn)[offsetof(GameSnapshot, seq)] ^= 0xFF;
+    rtc = torn;
+    SnapshotStore st(rtc);
+    check(!st.boot(true, GAMES) && st.seq() == 0, "boot: a torn retained copy is a cold start");
+  }
+  {
+    // Fewer games than when it was saved
+    GameSnapshot s = sample(2);
+    SnapshotStore st(rtc);
+    st.boot(true, GAMES);
+    st.save(s);
+    SnapshotStore st2(rtc);
+    check(!st2.boot(true, 2), "boot: a snapshot of a game this build does not have is ignored");
+  }
+}
+
+} // namespace
+
+int main()
+{
+  std::printf("Resume snapshot (%zu bytes)\n", sizeof(GameSnapshot));
+  encoding();
+  rejection();
+  store();
+  std::printf("%s: %d failures\n", g_failures ? "FAIL" : "ok", g_failures);
+  return g_failures ? 1 : 0;
+}
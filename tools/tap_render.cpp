@@ -0,0 +1,315 @@
+// Renders the tap analytics the console "taps" command prints: the tap
+// heatmap, per game hit rate, aim bias and offset histogram, and the miss
+// rate of each screen region, as text and optionally as PPM images:
+//   g++ -std=c++17 -O2 -I main tools/tap_render.cpp main/tap_stats.cpp -o tap_render
+//   ./tap_render capture.log [out=DIR]
+//   ./tap_render sim=1 [taps=N] [bias=DX,DY] [seed=N] [out=DIR]
+// The capture is a UART log (idf.py monitor | tee capture.log); anything
+// but "taps ..." lines is skipped and the last complete dump wins. sim=1
+// feeds synthetic taps around random targets through TapStats instead,
+// with a constant aim bias standing in for calibration drift.
+#include "tap_stats.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+namespace {
+
+const char *const GAME_NAMES[TAP_GAMES] = { "Tap Ball", "Whack-a-Mole", "Memory Grid" };
+
+// Aim bias worth a look: far above what finger jitter averages out to
+constexpr double BIAS_WARN_PX = 3.0;
+constexpr uint32_t BIAS_MIN_TAPS = 30;
+
+struct GameDump {
+  bool     present = false;
+  uint32_t taps = 0, hits = 0, misses = 0, near = 0;
+  int32_t  sum_dx = 0, sum_dy = 0;
+  uint32_t off[TAP_OFF_BINS][TAP_OFF_BINS] = {};
+  int      region_w = 0, region_h = 0;
+  uint32_t region_hits[TAP_REGION_ROWS][TAP_REGION_COLS] = {};
+  uint32_t region_taps[TAP_REGION_ROWS][TAP_REGION_COLS] = {};
+};
+
+struct Dump {
+  int      cell_w = 0, cell_h = 0;
+  uint32_t total = 0;
+  uint32_t heat[TAP_HEAT_ROWS][TAP_HEAT_COLS] = {};
+  GameDump games[TAP_GAMES];
+};
+
+// Reads up to `n` unsigned numbers following `s`
+int numbers(const char *s, uint32_t *out, int n)
+{
+  int got = 0;
+  char *end;
+  while (got < n) {
+    const unsigned long v = std::strtoul(s, &end, 10);
+    if (end == s) break;
+    out[got++] = (uint32_t)v;
+    s = end;
+  }
+  return got;
+}
+
+// One "taps ..." line into `d`; true on "taps end"
+bool parse_line(const char *p, Dump &d, bool &bad)
+{
+  int a, b, c, e, f, n = 0;
+  unsigned total;
+  if (std::sscanf(p, "taps heat %d %d %d %d %u", &a, &b, &c, &e, &total) == 5) {
+    if (a != TAP_HEAT_COLS || b != TAP_HEAT_ROWS) bad = true;
+    d = Dump();
+    d.cell_w = c; d.cell_h = e; d.total = total;
+  } else if (std::sscanf(p, "taps h %d%n", &a, &n) == 1 && a >= 0 && a < TAP_HEAT_ROWS) {
+    bad |= numbers(p + n, d.heat[a], TAP_HEAT_COLS) != TAP_HEAT_COLS;
+  } else if (std::sscanf(p, "taps game %d%n", &a, &n) == 1 && a >= 0 && a < TAP_GAMES) {
+    GameDump &g = d.games[a];
+    unsigned t, h, m, nr;
+    int sx, sy;
+    bad |= std::sscanf(p + n, "%u %u %u %u %d %d", &t, &h, &m, &nr, &sx, &sy) != 6;
+    g.present = true;
+    g.taps = t; g.hits = h; g.misses = m; g.near = nr; g.sum_dx = sx; g.sum_dy = sy;
+  } else if (std::sscanf(p, "taps off %d %d%n", &a, &b, &n) == 2 && a >= 0 && a < TAP_GAMES && b >= 0 &&
+             b < TAP_OFF_BINS) {
+    bad |= numbers(p + n, d.games[a].off[b], TAP_OFF_BINS) != TAP_OFF_BINS;
+  } else if (std::sscanf(p, "taps region %d %d %d %d %d%n", &a, &b, &c, &e, &f, &n) == 5 && a >= 0 &&
+             a < TAP_GAMES) {
+    GameDump &g = d.games[a];
+    if (b != TAP_REGION_COLS || c != TAP_REGION_ROWS) bad = true;
+    g.region_w = e; g.region_h = f;
+    const char *s = p + n;
+    for (int i = 0; i < TAP_REGION_ROWS * TAP_REGION_COLS; ++i) {
+      unsigned hh, tt;
+      int used = 0;
+      if (std::sscanf(s, " %u/%u%n", &hh, &tt, &used) != 2) { bad = true; break; }
+      g.region_hits[i / TAP_REGION_COLS][i % TAP_REGION_COLS] = hh;
+      g.region_taps[i / TAP_REGION_COLS][i % TAP_REGION_COLS] = tt;
+      s += used;
+    }
+  } else if (!std::strncmp(p, "taps end", 8)) {
+    return true;
+  }
+  return false;
+}
+
+bool load(FILE *f, Dump &out)
+{
+  Dump d;
+  bool found = false, bad = false, open = false;
+  char line[512];
+  while (std::fgets(line, sizeof(line), f)) {
+    const char *p = std::strstr(line, "taps ");
+    if (!p) continue;
+    if (!std::strncmp(p, "taps heat", 9)) { open = true; bad = false; }
+    if (!open) continue;
+    if (parse_line(p, d, bad)) {
+      open = false;
+      if (bad) { std::fprintf(stderr, "skipping a malformed dump\n"); continue; }
+      out = d;
+      found = true;
+    }
+  }
+  return found;
+}
+
+// ---- Synthetic taps ----
+
+Dump simulate(uint32_t taps, int bias_x, int bias_y, uint32_t seed)
+{
+  TapStats stats;
+  stats.set_screen(320, 240);
+  std::mt19937 rng(seed);
+  std::normal_distribution<double> jitter(0.0, 6.0);
+  // Target radius per game; one tap in 50 is stray
+  const int radius[TAP_GAMES] = { 14, 18, 30 };
+  for (uint32_t i = 0; i < taps; ++i) {
+    const int g = (int)(rng() % TAP_GAMES), r = radius[g];
+    const int tx = r + (int)(rng() % (320 - 2 * r)), ty = 18 + r + (int)(rng() % (240 - 18 - 2 * r));
+    if (rng() % 50 == 0) {
+      stats.record(g, (int)(rng() % 320), (int)(rng() % 240), TAP_STRAY, false, 0, 0);
+      continue;
+    }
+    // Players miss more near the edges, where the panel reads worst
+    const double edge = 1.0 + 1.5 * std::max(std::fabs(tx - 160.0) / 160.0, std::fabs(ty - 129.0) / 111.0);
+    const int x = tx + bias_x + (int)std::lround(jitter(rng) * edge);
+    const int y = ty + bias_y + (int)std::lround(jitter(rng) * edge);
+    const bool hit = (x - tx) * (x - tx) + (y - ty) * (y - ty) <= r * r;
+    stats.record(g, std::clamp(x, 0, 319), std::clamp(y, 0, 239), hit ? TAP_HIT : TAP_MISS, true, tx, ty);
+  }
+
+  // Through the text format, so sim checks the parser as well
+  std::string text;
+  stats.format([](const char *line, void *ctx) { *static_cast<std::string *>(ctx) += std::string(line) + "\n"; },
+               &text);
+  Dump d;
+  bool bad = false;
+  const char *p = text.c_str();
+  while (*p) {
+    const char *nl = std::strchr(p, '\n');
+    parse_line(std::string(p, nl - p).c_str(), d, bad);
+    p = nl + 1;
+  }
+  if (bad) std::fprintf(stderr, "sim: format and parser disagree\n");
+  return d;
+}
+
+// ---- Rendering ----
+
+const char RAMP[] = " .:-=+*#%@";
+
+char shade(uint32_t v, uint32_t max)
+{
+  if (!v || !max) return ' ';
+  return RAMP[1 + (int)((uint64_t)(v - 1) * (sizeof(RAMP) - 3) / std::max<uint32_t>(1, max - 1))];
+}
+
+// Black to red to yellow to white
+void heat_rgb(uint32_t v, uint32_t max, uint8_t *rgb)
+{
+  const double t = max ? std::sqrt((double)v / max) : 0.0;   // sqrt: sparse cells still show
+  rgb[0] = (uint8_t)std::lround(255 * std::min(1.0, t * 3));
+  rgb[1] = (uint8_t)std::lround(255 * std::clamp(t * 3 - 1, 0.0, 1.0));
+  rgb[2] = (uint8_t)std::lround(255 * std::clamp(t * 3 - 2, 0.0, 1.0));
+}
+
+bool write_ppm(const std::string &path, const std::vector<uint8_t> &rgb, int w, int h)
+{
+  FILE *f = std::fopen(path.c_str(), "wb");
+  if (!f) { std::fprintf(stderr, "cannot write %s\n", path.c_str()); return false; }
+  std::fprintf(f, "P6\n%d %d\n255\n", w, h);
+  std::fwrite(rgb.data(), 1, rgb.size(), f);
+  std::fclose(f);
+  return true;
+}
+
+void print_heat(const Dump &d)
+{
+  uint32_t max = 0;
+  for (const auto &row : d.heat) for (uint32_t v : row) max = std::max(max, v);
+  std::printf("Tap heatmap: %u taps, %dx%d px cells, busiest cell %u\n", (unsigned)d.total, d.cell_w, d.cell_h,
+              (unsigned)max);
+  std::printf("  +%s+\n", std::string(TAP_HEAT_COLS * 2, '-').c_str());
+  for (const auto &row : d.heat) {
+    std::printf("  |");
+    for (uint32_t v : row) std::printf("%c%c", shade(v, max), shade(v, max));
+    std::printf("|\n");
+  }
+  std::printf("  +%s+\n", std::string(TAP_HEAT_COLS * 2, '-').c_str());
+}
+
+void print_game(int gi, const GameDump &g)
+{
+  const uint32_t judged = g.hits + g.misses;
+  std::printf("\n%s: %u taps, %u hits, %u misses (%.1f%% miss), %u stray\n", GAME_NAMES[gi], (unsigned)g.taps,
+              (unsigned)g.hits, (unsigned)g.misses, judged ? 100.0 * g.misses / judged : 0.0,
+              (unsigned)(g.taps - judged));
+  if (g.near) {
+    const double mx = (double)g.sum_dx / g.near, my = (double)g.sum_dy / g.near;
+    const bool drift = g.near >= BIAS_MIN_TAPS && std::hypot(mx, my) > BIAS_WARN_PX;
+    std::printf("  aim bias %+.1f, %+.1f px over %u taps within %d px%s\n", mx, my, (unsigned)g.near,
+                TAP_OFF_BINS * TAP_OFF_BIN_PX / 2, drift ? "  <- check touch calibration" : "");
+  }
+
+  uint32_t max = 0;
+  for (const auto &row : g.off) for (uint32_t v : row) max = std::max(max, v);
+  std::printf("  offset from target center (%d px bins, + marks 0,0; edges hold everything farther)\n",
+              TAP_OFF_BIN_PX);
+  for (int r = 0; r < TAP_OFF_BINS; ++r) {
+    std::printf("    ");
+    for (int c = 0; c < TAP_OFF_BINS; ++c) {
+      const char ch = shade(g.off[r][c], max);
+      std::printf(" %c", ch == ' ' && r == TAP_OFF_BINS / 2 && c == TAP_OFF_BINS / 2 ? '+' : ch);
+    }
+    std::printf("\n");
+  }
+
+  std::printf("  miss rate by target region (%dx%d px):\n", g.region_w, g.region_h);
+  for (int r = 0; r < TAP_REGION_ROWS; ++r) {
+    std::printf("   ");
+    for (int c = 0; c < TAP_REGION_COLS; ++c) {
+      const uint32_t t = g.region_taps[r][c], h = g.region_hits[r][c];
+      if (t) std::printf(" %5.1f%% of %-5u", 100.0 * (t - h) / t, (unsigned)t);
+      else   std::printf("      -         ");
+    }
+    std::printf("\n");
+  }
+}
+
+void write_images(const Dump &d, const std::string &dir)
+{
+  mkdir(dir.c_str(), 0755);
+  uint32_t max = 0;
+  for (const auto &row : d.heat) for (uint32_t v : row) max = std::max(max, v);
+  const int w = TAP_HEAT_COLS * d.cell_w, h = TAP_HEAT_ROWS * d.cell_h;
+  std::vector<uint8_t> rgb((size_t)w * h * 3);
+  for (int y = 0; y < h; ++y)
+    for (int x = 0; x < w; ++x) heat_rgb(d.heat[y / d.cell_h][x / d.cell_w], max, &rgb[((size_t)y * w + x) * 3]);
+  if (write_ppm(dir + "/heat.ppm", rgb, w, h)) std::printf("wrote %s/heat.ppm\n", dir.c_str());
+
+  constexpr int SCALE = 16, SIDE = TAP_OFF_BINS * SCALE;
+  for (int gi = 0; gi < TAP_GAMES; ++gi) {
+    const GameDump &g = d.games[gi];
+    if (!g.present) continue;
+    uint32_t m = 0;
+    for (const auto &row : g.off) for (uint32_t v : row) m = std::max(m, v);
+    std::vector<uint8_t> img((size_t)SIDE * SIDE * 3);
+    for (int y = 0; y < SIDE; ++y)
+      for (int x = 0; x < SIDE; ++x) {
+        uint8_t *p = &img[((size_t)y * SIDE + x) * 3];
+        heat_rgb(g.off[y / SCALE][x / SCALE], m, p);
+        if (x == SIDE / 2 || y == SIDE / 2) p[0] = p[1] = p[2] = 96;   // target center
+      }
+    const std::string path = dir + "/offsets_" + std::to_string(gi + 1) + ".ppm";
+    if (write_ppm(path, img, SIDE, SIDE)) std::printf("wrote %s\n", path.c_str());
+  }
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  const char *path = nullptr;
+  std::string out;
+  bool sim = false;
+  uint32_t taps = 20000, seed = 1;
+  int bias_x = 0, bias_y = 0;
+  for (int i = 1; i < argc; ++i) {
+    const char *eq = std::strchr(argv[i], '=');
+    if (!eq) { path = argv[i]; continue; }
+    const std::string key(argv[i], eq - argv[i]);
+    if      (key == "out")  out = eq + 1;
+    else if (key == "sim")  sim = std::atoi(eq + 1) != 0;
+    else if (key == "taps") taps = (uint32_t)std::strtoul(eq + 1, nullptr, 0);
+    else if (key == "seed") seed = (uint32_t)std::strtoul(eq + 1, nullptr, 0);
+    else if (key == "bias" && std::sscanf(eq + 1, "%d,%d", &bias_x, &bias_y) == 2) {}
+    else { std::fprintf(stderr, "unknown option %s\n", argv[i]); return 2; }
+  }
+  if (!path && !sim) {
+    std::fprintf(stderr, "usage: %s CAPTURE [out=DIR] | sim=1 [taps=N] [bias=DX,DY] [seed=N] [out=DIR]\n", argv[0]);
+    return 2;
+  }
+
+  Dump d;
+  if (sim) {
+    d = simulate(taps, bias_x, bias_y, seed);
+  } else {
+    FILE *f = std::strcmp(path, "-") ? std::fopen(path, "r") : stdin;
+    if (!f) { std::fprintf(stderr, "cannot open %s\n", path); return 2; }
+    const bool ok = load(f, d);
+    if (f != stdin) std::fclose(f);
+    if (!ok) { std::fprintf(stderr, "no complete \"taps\" dump in %s\n", path); return 1; }
+  }
+
+  print_heat(d);
+  for (int gi = 0; gi < TAP_GAMES; ++gi)
+    if (d.games[gi].present) print_game(gi, d.games[gi]);
+  if (!out.empty()) write_images(d, out);
+  return 0;
+}
@@ -0,0 +1,205 @@
+// Host check of the XPT2046 reader through a mocked TouchSpiPort: the mock
+// answers each queued transaction the way the chip does, from the command
+// bytes it actually receives, and finishes transfers a set number of polls
+// later. Covers decoding, pressure gating, the median filter, the majority
+// rule, completion handling, queue failures and the rotation mapping:
+//   g++ -std=c++17 -O2 -I main tools/xpt2046_check.cpp main/xpt2046.cpp -o xpt2046_check
+//   ./xpt2046_check
+// Exits non-zero when any case fails.
+#include "xpt2046.hpp"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// What the panel reports for each conversion of one transaction
+struct Contact {
+  uint16_t x, y, z1, z2;
+};
+constexpr Contact RELEASED = { 0, 0, 0, 4095 };
+
+class MockPort : public TouchSpiPort {
+public:
+  std::vector<Contact> script;   // per transaction, in queue order, repeating
+  int    latency = 1;            // collect() calls before a transfer finishes
+  int    accept = 1 << 30;       // queue() calls left that succeed
+  int    bad_len = 0, bad_cmd = 0;
+  size_t bytes = 0;
+
+  bool queue(const uint8_t *tx, uint8_t *rx, size_t len) override
+  {
+    if (accept <= 0) return false;
+    --accept;
+    if (len != XPT_FRAME_BYTES) ++bad_len;
+    bytes += len;
+    const Contact c = script.empty() ? RELEASED : script[next_ % script.size()];
+    ++next_;
+    std::memset(rx, 0, len);
+    // A command byte at i starts a conversion; its 12 bits follow one busy
+    // clock, so they land in bytes i+1 and i+2, shifted left by 3
+    for (size_t i = 0; i < len; ++i) {
+      if (!(tx[i] & 0x80)) continue;
+      uint16_t v;
+      switch ((tx[i] >> 4) & 7) {
+        case 1: v = c.y; break;
+        case 3: v = c.z1; break;
+        case 4: v = c.z2; break;
+        case 5: v = c.x; break;
+        default: ++bad_cmd; v = 0; break;
+      }
+      const uint16_t bits = (uint16_t)((v & 0x0FFF) << 3);
+      if (i + 1 < len) rx[i + 1] |= (uint8_t)(bits >> 8);
+      if (i + 2 < len) rx[i + 2] |= (uint8_t)bits;
+    }
+    pending_.push_back(latency);
+    return true;
+  }
+
+  int collect() override
+  {
+    int done = 0;
+    while (!pending_.empty() && pending_.front() <= 0) { pending_.erase(pending_.begin()); ++done; }
+    for (int &p : pending_) --p;
+    return done;
+  }
+
+  void reset_script(std::vector<Contact> s) { script = std::move(s); next_ = 0; }
+
+private:
+  size_t next_ = 0;
+  std::vector<int> pending_;
+};
+
+const XptCalib CAL = { 300, 3900, 300, 3900, 400 };
+
+int g_failures = 0;
+
+void check(bool ok, const char *what)
+{
+  std::printf("  [%s] %s\n", ok ? "ok" : "FAIL", what);
+  if (!ok) ++g_failures;
+}
+
+// Polls until a batch has been decoded (or gives up)
+bool run_batch(Xpt2046Reader &r, int max_polls = 20)
+{
+  const uint32_t b = r.batches();
+  for (int i = 0; i < max_polls; ++i) {
+    r.poll();
+    if (r.batches() != b) return true;
+  }
+  return false;
+}
+
+// New panel state: the batch already in flight still carries the old one
+bool feed(MockPort &port, Xpt2046Reader &r, std::vector<Contact> script)
+{
+  port.reset_script(std::move(script));
+  return run_batch(r) && run_batch(r);
+}
+
+Contact press(uint16_t x, uint16_t y) { return { x, y, 600, 2800 }; }   // z = 600 + 4095 - 2800
+
+void frame_layout()
+{
+  uint8_t tx[XPT_FRAME_BYTES];
+  xpt_build_frame(tx);
+  const bool cmds = tx[0] == XPT_CMD_Z1 && tx[2] == XPT_CMD_Z2 && tx[4] == XPT_CMD_X && tx[6] == XPT_CMD_Y;
+  bool rest_zero = true;
+  for (size_t i = 7; i < XPT_FRAME_BYTES; ++i) rest_zero &= tx[i] == 0;
+  check(cmds && rest_zero && tx[1] == 0 && tx[3] == 0 && tx[5] == 0, "frame: Z1 Z2 X Y at bytes 0/2/4/6, zeros between");
+  check((XPT_CMD_Y & 3) == 0 && (XPT_CMD_Z1 & 3) == 1, "frame: last conversion powers down to re-arm PENIRQ");
+}
+
+void decode_press_and_release()
+{
+  MockPort port;
+  Xpt2046Reader r(port, CAL);
+  port.reset_script({ press(2000, 1200) });
+  r.poll();   // first kick
+  check(!r.pressed() && r.batches() == 0, "poll: nothing decoded before the batch finishes");
+  check(run_batch(r) && r.pressed(), "decode: steady contact reads pressed");
+  check(r.last().x == 2000 && r.last().y == 1200 && r.last().used == XPT_SAMPLES, "decode: raw x/y from the X and Y conversions");
+  check(r.last().z == 600 + 4095 - 2800, "decode: pressure z1 + 4095 - z2");
+  check(port.bad_len == 0 && port.bad_cmd == 0, "queue: every transaction is one XPT_FRAME_BYTES frame of known commands");
+  check(port.bytes == (size_t)XPT_SAMPLES * XPT_FRAME_BYTES * 2, "queue: 4 transactions of 12 bytes per batch");
+
+  check(feed(port, r, { RELEASED }) && !r.pressed(), "decode: release reads released");
+}
+
+void filters()
+{
+  MockPort port;
+  Xpt2046Reader r(port, CAL);
+  // One wild sample in four: the median ignores it
+  port.reset_script({ press(1500, 1500), press(3900, 200), press(1510, 1490), press(1490, 1510) });
+  r.poll();
+  run_batch(r);
+  check(r.pressed() && r.last().x == 1510 && r.last().y == 1500, "median: one outlier in four is rejected");
+
+  // Two of four above the pressure gate is not a majority
+  check(feed(port, r, { press(1500, 1500), { 1500, 1500, 100, 4095 }, press(1500, 1500), RELEASED }) &&
+        !r.pressed() && r.last().x == 1510, "majority: 2 of 4 pressed reads released, last contact kept");
+
+  // z1 == 0 is no contact even when z2 reads low
+  check(feed(port, r, { { 1500, 1500, 0, 0 } }) && !r.pressed(), "gate: z1 = 0 is released whatever z2 reads");
+}
+
+void queue_failures()
+{
+  MockPort port;
+  Xpt2046Reader r(port, CAL);
+  port.reset_script({ press(1000, 3000) });
+  r.poll();
+  run_batch(r);
+  check(r.pressed(), "queue: pressed before the failure");
+
+  // The finished batch is decoded, then nothing can be queued
+  port.accept = 4;
+  run_batch(r);
+  r.poll();
+  r.poll();
+  check(!r.pressed(), "queue: a kick that queues nothing reads released, not a held finger");
+
+  port.accept = 1 << 30;
+  r.poll();
+  check(run_batch(r) && r.pressed(), "queue: contact returns once transactions queue again");
+
+  // Only two of four queue: the batch decodes from those two
+  port.accept = 2;
+  run_batch(r);
+  port.accept = 1 << 30;
+  check(run_batch(r) && r.pressed() && r.last().used == 2, "queue: a short batch decodes the samples it has");
+}
+
+void mapping()
+{
+  const int W = 240, H = 320;
+  const XptRaw lo = { (uint16_t)CAL.x_min, (uint16_t)CAL.y_min, 1000, 4 };
+  const XptRaw hi = { (uint16_t)CAL.x_max, (uint16_t)CAL.y_max, 1000, 4 };
+  uint16_t x0, y0, x1, y1;
+  xpt_map(lo, CAL, 0, W, H, x0, y0);
+  xpt_map(hi, CAL, 0, W, H, x1, y1);
+  check(x0 == 0 && y0 == 0 && x1 == W - 1 && y1 == H - 1, "map: rotation 0 spans the portrait panel");
+  xpt_map(lo, CAL, 1, W, H, x0, y0);
+  xpt_map(hi, CAL, 1, W, H, x1, y1);
+  check(x0 == 0 && y0 == W - 1 && x1 == H - 1 && y1 == 0, "map: rotation 1 is landscape, x from panel y");
+  const XptRaw below = { 0, 5000, 1000, 4 };
+  xpt_map(below, CAL, 0, W, H, x0, y0);
+  check(x0 == 0 && y0 == H - 1, "map: readings outside the calibration clamp to the edge");
+}
+
+} // namespace
+
+int main()
+{
+  std::printf("XPT2046 reader through a mocked TouchSpiPort\n");
+  frame_layout();
+  decode_press_and_release();
+  filters();
+  queue_failures();
+  mapping();
+  std::printf("%s: %d failures\n", g_failures ? "FAIL" : "ok", g_failures);
+  return g_failures ? 1 : 0;
+}